@@ -253,6 +253,39 @@ FILE68_API
 const char * rsc68_get_music_params(rsc68_info_t *info,
                                     const char * str);
 
+FILE68_API
+/**
+ * Get a built-in replay.
+ *
+ *   The replay68_get() function returns the inflated image of a
+ *   built-in replay. The image is inflated the first time and then
+ *   kept in a process-wide cache shared by all threads. Each
+ *   successful call must be balanced by a replay68_put() call.
+ *
+ * @param  name  Replay name.
+ * @param  size  Get inflated size (can be 0).
+ *
+ * @return  read-only replay image
+ * @retval  0 not a built-in replay or error
+ */
+const void * replay68_get(const char * name, int * size);
+
+FILE68_API
+/**
+ * Release a built-in replay.
+ *
+ * @param  data  Replay image returned by replay68_get().
+ */
+void replay68_put(const void * data);
+
+FILE68_API
+/**
+ * Free the built-in replay cache.
+ *
+ *   Replays still in use are kept.
+ */
+void replay68_shutdown(void);
+
 /**
  * @}
  */
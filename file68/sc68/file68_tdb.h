@@ -24,6 +24,13 @@
  *   the use of this database should help exposing a proper song
  *   length in most cases.
  *
+ *   Beside the built-in database, entries added at runtime are kept
+ *   in the user resource path. The image file (timedb.bin) is a
+ *   sorted binary dump that is memory mapped as is. New entries are
+ *   appended to a journal file (timedb.jnl) which is merged into a
+ *   new image by timedb68_save(). Lookups check the journal, then the
+ *   image and finally the built-in database.
+ *
  *  @{
  */
 
@@ -42,19 +49,52 @@ enum {
 
 FILE68_API
 /**
- * Load the database,
+ * Load the database.
+ *
+ *   The timedb68_load() function maps the image file and replays the
+ *   journal file found in the user resource path. Previously loaded
+ *   entries are discarded.
+ *
+ * @return error-code
+ * @retval  0  on success (even if there is no file to load)
+ * @retval -1  on error
  */
 int timedb68_load(void);
 
 FILE68_API
 /**
  * Save the database (only if it has been modified).
+ *
+ *   The timedb68_save() function merges the journal into a new image
+ *   file and resets the journal.
+ *
+ * @return error-code
+ * @retval  0  on success
+ * @retval -1  on error
  */
 int timedb68_save(void);
 
 FILE68_API
 /**
- * Add an entry to the database (in memory only).
+ * Discard all runtime entries and unmap the image.
+ *
+ *   Unsaved entries are not lost as long as they have been written
+ *   to the journal.
+ */
+void timedb68_unload(void);
+
+FILE68_API
+/**
+ * Add an entry to the database.
+ *
+ *   The entry is immediately appended to the journal file (if the
+ *   user resource path is writable) so that it survives the process.
+ *   An entry that could not be written is still saved by
+ *   timedb68_save().
+ *
+ * @return entry index, as timedb68_get() returns it until the next
+ *         change of the database
+ * @retval -1  on error
  */
 int timedb68_add(int hash, int track, unsigned int frames, int flags);
 
@@ -820,8 +820,10 @@ static vfs68_t * uri_or_file_create(const char * uri, int mode,
   TRACE68(file68_cat,"file68: create -- %s -- mode:%d -- with%s info\n",
           strnull(uri),mode,info?"":"out");
 
-  if (info && !strncmp68(uri,"sc68://music/", 13)) {
+  if (info)
     info->type = rsc68_last;
+
+  if (info && !strncmp68(uri,"sc68://music/", 13)) {
     vfs = uri68_vfs(uri, mode, 1, &info);
   } else {
     vfs = uri68_vfs(uri, mode, 0);
@@ -41,6 +41,7 @@
 #include "file68_vfs_z.h"
 #include "file68_rsc.h"
 #include "file68_str.h"
+#include "file68_tdb.h"
 
 #include <assert.h>
 #include <stdlib.h>
@@ -284,6 +285,9 @@ int file68_init(int argc, char **argv)
     }
   }
 
+  /* Time database (needs the user path) */
+  timedb68_load();
+
   init = 1;
   return argc;
 }
@@ -293,6 +297,10 @@ void file68_shutdown(void)
   if (init == 1) {
     init = 2;
 
+    /* Time database */
+    timedb68_save();
+    timedb68_unload();
+
     /* Options */
     option68_shutdown();
 
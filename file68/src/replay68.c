@@ -1,6 +1,6 @@
 /*
  * @file    replay68.c
- * @brief   built-in external replay rom
+ * @brief   built-in external replay rom and cache
  * @author  http://sourceforge.net/users/benjihan
  *
  * Copyright (c) 1998-2016 Benjamin Gerard
@@ -27,18 +27,56 @@
 #endif
 #include "file68_private.h"
 #include "file68_api.h"
+#include "file68_rsc.h"
 #include "file68_str.h"
 #include "file68_msg.h"
-FILE68_API
-int replay68_get(const char * name, const void ** data,
-                 int * csize, int * dsize);
+#include "file68_zip.h"
 
-#include "replay.inc.h"
+#ifdef USE_REPLAY68
+# include "replay.inc.h"
+#else
+/* No built-in replay */
+static const struct replay {
+  const char    * name;
+  const unsigned char * data;
+  int   csize;
+  int   dsize;
+} replays[1];
+#endif
 
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h>
+#endif
+
+/* in rsc68.c */
+extern int rsc68_cat;
+
+enum {
+  max = sizeof(replays)/sizeof(*replays)
+};
+
+/* Inflated replays. Once inflated a replay stays in the cache until
+ * replay68_shutdown() so that the next track using it only has to
+ * copy it.
+ */
+static struct {
+  void * data;                          /* inflated data (0:not yet) */
+  int    ref;                           /* replay68_get() references */
+} cache[max];
+
+#ifdef HAVE_PTHREAD_H
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+# define cache_lock()   pthread_mutex_lock(&cache_mutex)
+# define cache_unlock() pthread_mutex_unlock(&cache_mutex)
+#else
+# define cache_lock()   (void)0
+# define cache_unlock() (void)0
+#endif
+
 static int cmp(const void * pa, const void * pb)
 {
   const char
@@ -47,14 +85,15 @@ static int cmp(const void * pa, const void * pb)
   return strcmp68(a, b);
 }
 
-int replay68_get(const char * name, const void ** data,
-                 int * csize, int * dsize)
+static const struct replay * find(const char * name)
 {
-  const int max = sizeof(replays)/sizeof(*replays);
   struct replay s;
   const struct replay *r;
   s.name = name;
 
+  if (!name || !replays[0].name)
+    return 0;
+
   r = bsearch(&s, replays, max, sizeof(*replays), cmp);
   if (!r) {
     int i;
@@ -74,16 +113,67 @@ int replay68_get(const char * name, const void ** data,
         break;
       }
   }
+  return r;
+}
+
+const void * replay68_get(const char * name, int * size)
+{
+  const struct replay * r = find(name);
+  void * data = 0;
+
+  if (!r) {
+    TRACE68(rsc68_cat,"rsc68: no built-in replay -- *%s*\n", name);
+    return 0;
+  }
+
+  cache_lock();
+  data = cache[r-replays].data;
+  if (!data && (data = malloc(r->dsize)) != 0) {
+    const int inflate = gzip68_buffer(data, r->dsize, r->data, r->csize);
+    if (inflate != r->dsize) {
+      msg68_error("rsc68: inflated size of built-in replay differs"
+                  " -- %s %d %d\n", name, inflate, r->dsize);
+      free(data);
+      data = 0;
+    }
+    cache[r-replays].data = data;
+  }
+  if (data)
+    ++cache[r-replays].ref;
+  cache_unlock();
+
+  if (data && size)
+    *size = r->dsize;
+  return data;
+}
+
+void replay68_put(const void * data)
+{
+  int i;
+
+  if (!data)
+    return;
+  cache_lock();
+  for (i=0; i<max && cache[i].data != data; ++i)
+    ;
+  assert(i < max);
+  assert(cache[i].ref > 0);
+  if (i < max && cache[i].ref > 0)
+    --cache[i].ref;
+  cache_unlock();
+}
+
+void replay68_shutdown(void)
+{
+  int i;
 
-  if (r) {
-    if (data)
-      *data = r->data;
-    if (csize)
-      *csize = r->csize;
-    if (dsize)
-      *dsize = r->dsize;
-  } else
-    msg68_warning("rsc68: can't find built-in replay -- *%s*\n",
-                  name);
-  return -!r;
+  cache_lock();
+  for (i=0; i<max && replays[i].name; ++i)
+    if (!cache[i].ref) {
+      free(cache[i].data);
+      cache[i].data = 0;
+    } else
+      msg68_warning("rsc68: built-in replay still in use -- *%s*\n",
+                    replays[i].name);
+  cache_unlock();
 }
@@ -54,9 +54,6 @@ int rsc68_cat = msg68_DEFAULT;
 
 static volatile int init = 0;
 
-/* in replay68.c */
-int replay68_get(const char * name, const void ** data, int * csize, int * dsize);
-
 /* The resource pathes are context independant consequently
  * each context use the same pathes.
  */
@@ -476,79 +473,29 @@ static vfs68_t * default_open(rsc68_t type, const char *name,
   switch (type) {
   case rsc68_replay:
 
-#if defined (USE_REPLAY68) && 0
-
-    /* Method using vfs to inflate data. Notice that unfortunatly
-     * we can't use a proper Z stream because the replay loader needs
-     * to know the length and vfs68_z::length() method does not
-     * have this information before it has inflated the all data. This
-     * is a limitation that could probably be dealt with, at least
-     * with gziped stream as the information is available at the end
-     * of the stream. Also in this particular case the inflate size is
-     * available via the replay68_get() function.
-     */
-    if (mode == 1) {
-      const void * cdata;
-      int csize, dsize;
-      vfs68_t * is_in;
-
-      TRACE68(rsc68_cat,"rsc68: trying built-in replay -- %s\n", name);
-      if (!replay68_get(name, &cdata, &csize, &dsize)) {
-        TRACE68(rsc68_cat,"rsc68: found built-in replay -- %s %d %d\n",
-                name, csize, dsize);
-        is_in =
-          vfs68_z_create(
-            vfs68_mem_create(cdata, csize, mode),
-            mode|VFS68_SLAVE,
-            vfs68_z_default_option);
-        if (is_in) {
-          is = vfs68_mem_create(0, dsize, 3);
-          if (!vfs68_open(is_in) && !vfs68_open(is)) {
-            int n;
-            while (n = vfs68_read(is_in, tmpname, sizeof(tmpname)), n > 0)
-              if (vfs68_write(is, tmpname, n) != n) {
-                n = -1;
-                break;
-              }
-            err = -!!n;
-          }
-          vfs68_destroy(is_in);
-          vfs68_seek_to(is,0);
-        }
-      }
-    }
-
-#elif defined (USE_REPLAY68)
+#ifdef USE_REPLAY68
 
-    /* Method using gzip68_buffer() is probably faster (less memory
-     * copy) than the previous Z stream one. It still need to allocate
-     * a temporary buffer to store deflated data whereas a proper
-     * vfs could have deflated on the fly into the 68k memory
-     * buffer. See previous method comment on that matter.
+    /* Built-in replays are inflated once in the replay cache (see
+     * replay68_get()). The stream gets its own copy.
      */
     if (mode == 1) {
-      const void * cdata;
+      const void * rdata;
       void * ddata;
-      int csize, dsize;
+      int dsize;
 
       TRACE68(rsc68_cat,"rsc68: trying built-in replay -- %s\n", name);
-      if (!replay68_get(name, &cdata, &csize, &dsize)) {
-        TRACE68(rsc68_cat,"rsc68: found built-in replay -- %s %d %d\n",
-                name, csize, dsize);
+      if (rdata = replay68_get(name, &dsize), rdata) {
+        TRACE68(rsc68_cat,"rsc68: found built-in replay -- %s %d\n",
+                name, dsize);
         ddata = malloc(dsize);
         if (ddata) {
-          int inflate = gzip68_buffer(ddata, dsize, cdata, csize);
-          if (inflate != dsize) {
-            msg68_error("rsc68: inflated size of built-in replay differs"
-                        " -- %s %d %d\n",name, inflate, dsize);
-            err = -1;
-          } else {
-            is = vfs68_mem_create(ddata, dsize, mode|VFS68_SLAVE);
-            if ( (err = -!is) != 0) {
-              free(ddata);
-            }
+          memcpy(ddata, rdata, dsize);
+          is = vfs68_mem_create(ddata, dsize, mode|VFS68_SLAVE);
+          if ( (err = -!is) != 0) {
+            free(ddata);
           }
         }
+        replay68_put(rdata);
       }
     }
 
@@ -788,6 +735,7 @@ void rsc68_shutdown(void)
     rsc68_set_user(0);
     rsc68_set_music(0);
     rsc68_set_remote_music(0);
+    replay68_shutdown();
     rsc68 = default_open;
     init  = 0;
   }
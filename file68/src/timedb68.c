@@ -27,8 +27,44 @@
 #endif
 #include "file68_private.h"
 #include "file68_tdb.h"
+#include "file68_rsc.h"
+#include "file68_str.h"
+#include "file68_msg.h"
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+# define USE_MMAP 1
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#ifdef HAVE_FCNTL_H
+# include <fcntl.h>
+#endif
+#ifdef HAVE_ERRNO_H
+# include <errno.h>
+#endif
+#if defined(HAVE_FTRUNCATE) && defined(HAVE_UNISTD_H)
+# define USE_FTRUNCATE 1
+#endif
+#if defined(F_SETLKW) && defined(EINTR)
+# define USE_FLOCK 1
+#endif
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h>
+#endif
+
+#ifndef DEBUG_TIMEDB68_O
+# define DEBUG_TIMEDB68_O 0
+#endif
+static int tdb_cat = msg68_DEFAULT;
 
 #define HBIT 32                         /* # of bit for hash     */
 #define TBIT 6                          /* # of bit for track    */
@@ -38,8 +74,6 @@
 
 #define TIMEDB_ENTRY(HASH,TRACK,FRAMES,FLAGS) \
   { 0x##HASH>>HFIX, TRACK-1, FLAGS, FRAMES }
-#define E_EMPTY { 0,0,0,0 }
-
 
 typedef struct {
   unsigned int hash   : HBIT;           /* hash code              */
@@ -64,43 +98,124 @@ typedef struct {
 
 static dbentry_t db[] = {
 # include "timedb.inc.h"
-  /* Add a bit of Supplemental empty space */
-  E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,
-  E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,
-  E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,
-  E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,
-  E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,
-  E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,
-  E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,
-  E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,E_EMPTY,
 };
-# define DB_MAX   (sizeof(db)/sizeof(*db))
-# define DB_COUNT DB_MAX-64
-# define DB_SORT  1
+# define DB_COUNT (sizeof(db)/sizeof(*db))
 #else
-# define DB_MAX   10000
+static dbentry_t db[1];
 # define DB_COUNT 0
-# define DB_SORT  1
-static dbentry_t db[DB_MAX];
 #endif
 
-static int dbcount  = DB_COUNT;      /* entry count                 */
-static int dbmax    = DB_MAX;        /* max entry                   */
-static int dbsort   = DB_SORT;       /* set if db is sorted         */
+static int dbcount  = DB_COUNT;      /* built-in entry count        */
+static int dbsort   = 0;             /* set if db is sorted         */
 static int dbchange = 0;             /* set if db has been modified */
 
-/* static const char * db_uri="sc68://timedb"; */
+/* The built-in entries, the image and the journal are shared by all
+ * the threads of the process. */
+#ifdef HAVE_PTHREAD_H
+static pthread_mutex_t tdb_mutex = PTHREAD_MUTEX_INITIALIZER;
+# define tdb_lock()   pthread_mutex_lock(&tdb_mutex)
+# define tdb_unlock() pthread_mutex_unlock(&tdb_mutex)
+#else
+# define tdb_lock()   (void)0
+# define tdb_unlock() (void)0
+#endif
+
+/* ,-----------------------------------------------------------------.
+ * |                        File format                              |
+ * `-----------------------------------------------------------------'
+ *
+ * The time database is made of two files in the user resource path:
+ *
+ * - The image file (timedb.bin) is a tdbhead_t header followed by
+ *   tdbhead_t::count tdbrec_t records sorted by hash and track. It is
+ *   stored in native byte order so that it can be mapped and used as
+ *   is.
+ *
+ * - The journal file (timedb.jnl) is a tdbhead_t header (count is
+ *   unused) followed by the tdbrec_t records added since the image
+ *   has been written. A truncated record (from a crash) is ignored
+ *   and cut before the next record is appended.
+ *
+ * timedb68_save() reloads the image and the journal, merges them into
+ * a new image and empties the journal. Several processes may share
+ * the files: where fcntl() locks are available the journal is locked
+ * while it is appended or merged.
+ */
+
+#define TDB_IMAGE   "/timedb.bin"
+#define TDB_JOURNAL "/timedb.jnl"
+#define TDB_VERSION 1
+#define TDB_BOM     0x01020304
+
+static const char img_magic[8] = { 's','c','6','8','t','d','b','\0' };
+static const char jnl_magic[8] = { 's','c','6','8','t','j','n','\0' };
+
+typedef struct {
+  char     magic[8];                    /* img_magic or jnl_magic */
+  uint32_t version;                     /* TDB_VERSION            */
+  uint32_t bom;                         /* TDB_BOM (byte order)   */
+  uint32_t count;                       /* number of records      */
+  uint32_t recsize;                     /* sizeof(tdbrec_t)       */
+} tdbhead_t;
+
+typedef struct {
+  uint32_t hash;                        /* hash code              */
+  uint32_t data;                        /* track|flags|frames     */
+} tdbrec_t;
+
+#define REC_TRACK(R)  ( (R)->data & ((1u<<TBIT)-1) )
+#define REC_FLAGS(R)  ( ((R)->data >> TBIT) & ((1u<<WBIT)-1) )
+#define REC_FRAMES(R) ( (R)->data >> (TBIT+WBIT) )
+#define REC_DATA(T,F,N) ( (T) | ((F) << TBIT) | ((N) << (TBIT+WBIT)) )
+
+/* Mapped image */
+typedef struct {
+  void           * base;                /* mapped file            */
+  size_t           size;                /* mapped size            */
+  int              mapped;              /* 1:mmap() 0:malloc()    */
+  const tdbrec_t * rec;                 /* sorted records         */
+  unsigned int     count;               /* number of records      */
+} tdbimg_t;
+static tdbimg_t img;
+
+/* Records added since the image was written. The first sorted
+ * records are sorted, the others are not (at most JNL_TAIL). */
+enum { JNL_TAIL = 256 };
+typedef struct {
+  tdbrec_t * rec;                       /* records                */
+  unsigned int count;                   /* number of records      */
+  unsigned int max;                     /* allocated records      */
+  unsigned int sorted;                  /* sorted records         */
+  FILE * f;                             /* journal file (append)  */
+  char * fname;                         /* journal path           */
+} tdbjnl_t;
+static tdbjnl_t jnl;
+
+/* ,-----------------------------------------------------------------.
+ * |                         Searching                               |
+ * `-----------------------------------------------------------------'
+ */
+
+static int cmp_key(unsigned int ha, unsigned int ta,
+                   unsigned int hb, unsigned int tb)
+{
+  if (ha != hb)
+    return ha < hb ? -1 : 1;
+  return (int)ta - (int)tb;
+}
 
 static int cmp(const void * ea, const void *eb)
 {
   const dbentry_t * a = (const dbentry_t *) ea;
   const dbentry_t * b = (const dbentry_t *) eb;
-  int v;
+  return cmp_key(a->hash, a->track, b->hash, b->track);
+}
 
-  v = a->hash - b->hash;
-  if (!v)
-    v = a->track - b->track;
-  return v;
+static int cmp_rec(const void * ea, const void *eb)
+{
+  const tdbrec_t * a = (const tdbrec_t *) ea;
+  const tdbrec_t * b = (const tdbrec_t *) eb;
+  return cmp_key(a->hash, REC_TRACK(a), b->hash, REC_TRACK(b));
 }
 
 static dbentry_t * search_for(const dbentry_t * key)
@@ -112,35 +227,332 @@ static dbentry_t * search_for(const dbentry_t * key)
   return (dbentry_t *) bsearch(key, db, dbcount, sizeof(dbentry_t), cmp);
 }
 
+static tdbrec_t * search_jnl(const tdbrec_t * key)
+{
+  tdbrec_t * s;
+  unsigned int i;
 
-int timedb68_add(int hash, int track, unsigned int frames, int flags)
+  s = bsearch(key, jnl.rec, jnl.sorted, sizeof(tdbrec_t), cmp_rec);
+  for (i = jnl.sorted; !s && i < jnl.count; ++i)
+    if (!cmp_rec(key, jnl.rec+i))
+      s = jnl.rec+i;
+  return s;
+}
+
+/* Sort the unsorted tail and merge it with the sorted records. */
+static void merge_jnl(void)
 {
-  dbentry_t e, *s;
+  const unsigned int n = jnl.sorted, t = jnl.count - n;
+  tdbrec_t tmp[JNL_TAIL];
+  int i, j, k;
 
-  if ((unsigned)track >= (1u << TBIT) || frames >= (1u << FBIT) )
+  if (!t)
+    return;
+  qsort(jnl.rec+n, t, sizeof(tdbrec_t), cmp_rec);
+  memcpy(tmp, jnl.rec+n, t * sizeof(tdbrec_t));
+  for (i = n-1, j = t-1, k = n+t-1; j >= 0; --k)
+    jnl.rec[k] = (i >= 0 && cmp_rec(jnl.rec+i, tmp+j) > 0)
+      ? jnl.rec[i--]
+      : tmp[j--]
+      ;
+  jnl.sorted = jnl.count;
+}
+
+/* Add or replace a record in memory. */
+static int add_jnl(const tdbrec_t * e)
+{
+  tdbrec_t * s = search_jnl(e);
+
+  if (!s) {
+    if (jnl.count - jnl.sorted >= JNL_TAIL)
+      merge_jnl();
+    if (jnl.count == jnl.max) {
+      const unsigned int max = jnl.max ? jnl.max * 2 : 1024;
+      tdbrec_t * rec = realloc(jnl.rec, max * sizeof(*rec));
+      if (!rec)
+        return -1;
+      jnl.rec = rec;
+      jnl.max = max;
+    }
+    s = jnl.rec + jnl.count++;
+  }
+  *s = *e;
+  return 0;
+}
+
+/* ,-----------------------------------------------------------------.
+ * |                           Files                                 |
+ * `-----------------------------------------------------------------'
+ */
+
+/* Get a file path in the user resource directory. */
+static char * tdb_path(const char * name)
+{
+  const char * user = 0;
+  rsc68_get_path(0, &user, 0, 0);
+  return user ? strcatdup68(user, name) : 0;
+}
+
+static int check_head(const tdbhead_t * h, const char * magic)
+{
+  return memcmp(h->magic, magic, sizeof(h->magic))
+    || h->version != TDB_VERSION
+    || h->bom     != TDB_BOM
+    || h->recsize != sizeof(tdbrec_t)
+    ;
+}
+
+static void set_head(tdbhead_t * h, const char * magic, unsigned int count)
+{
+  memcpy(h->magic, magic, sizeof(h->magic));
+  h->version = TDB_VERSION;
+  h->bom     = TDB_BOM;
+  h->count   = count;
+  h->recsize = sizeof(tdbrec_t);
+}
+
+static void unmap_image(void)
+{
+  if (img.base) {
+#ifdef USE_MMAP
+    if (img.mapped)
+      munmap(img.base, img.size);
+    else
+#endif
+      free(img.base);
+  }
+  memset(&img, 0, sizeof(img));
+}
+
+/* Map (or load) the image file. */
+static int map_image(const char * fname)
+{
+  const tdbhead_t * h;
+  void * base = 0;
+  long size = -1;
+  int mapped = 0;
+
+#ifdef USE_MMAP
+  int fd = open(fname, O_RDONLY);
+  if (fd != -1) {
+    struct stat st;
+    if (!fstat(fd, &st) && st.st_size >= (off_t)sizeof(tdbhead_t)) {
+      size = st.st_size;
+      base = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+      if (base == MAP_FAILED)
+        base = 0;
+      mapped = !!base;
+    }
+    close(fd);
+  }
+#endif
+
+  if (!base) {
+    FILE * f = fopen(fname, "rb");
+    if (!f)
+      return -1;
+    if (!fseek(f, 0, SEEK_END) && (size = ftell(f)) >= 0 &&
+        !fseek(f, 0, SEEK_SET) && (base = malloc(size ? size : 1)) &&
+        fread(base, 1, size, f) != (size_t) size) {
+      free(base);
+      base = 0;
+    }
+    fclose(f);
+    if (!base)
+      return -1;
+  }
+
+  img.base   = base;
+  img.size   = size;
+  img.mapped = mapped;
+
+  h = (const tdbhead_t *) base;
+  if (size < (long) sizeof(*h) || check_head(h, img_magic) ||
+      (size - sizeof(*h)) / sizeof(tdbrec_t) < h->count) {
+    msg68_warning("timedb68: invalid image -- *%s*\n", fname);
+    unmap_image();
     return -1;
+  }
+  img.rec   = (const tdbrec_t *) (h+1);
+  img.count = h->count;
+  TRACE68(tdb_cat, "timedb68: %s image -- %u entries\n",
+          mapped ? "mapped" : "loaded", img.count);
+  return 0;
+}
 
-  e.hash   = hash >> HFIX;
-  e.track  = track;
-  e.frames = frames;
-  e.flags  = flags;
+/* Replay the journal file. */
+static int replay_journal(FILE * f)
+{
+  tdbhead_t h;
+  tdbrec_t e;
+  int n = 0;
 
-  s = search_for(&e);
-  if (!s && dbcount < dbmax) {
-    s = db + dbcount++;
-    dbsort = 0;
+  if (fseek(f, 0, SEEK_SET) || fread(&h, sizeof(h), 1, f) != 1 ||
+      check_head(&h, jnl_magic)) {
+    msg68_warning("timedb68: %s\n", "invalid journal");
+    return -1;
   }
-  if (s)
-    *s = e;
-  return s - db;
+  while (n >= 0 && fread(&e, sizeof(e), 1, f) == 1)
+    n = add_jnl(&e) ? -1 : n+1;
+  TRACE68(tdb_cat, "timedb68: replayed journal -- %d entries\n", n);
+  return n;
 }
 
-int timedb68_get(int hash, int track, unsigned int * frames, int * flags)
+/* Lock (or unlock) the journal against the other processes. */
+static void lock_journal(int lock)
 {
-  dbentry_t e, *s;
-  e.hash   = hash >> HFIX;
-  e.track  = track;
-  s = search_for(&e);
+#ifdef USE_FLOCK
+  struct flock fl;
+
+  memset(&fl, 0, sizeof(fl));
+  fl.l_type   = lock ? F_WRLCK : F_UNLCK;
+  fl.l_whence = SEEK_SET;
+  while (fcntl(fileno(jnl.f), F_SETLKW, &fl) == -1 && errno == EINTR)
+    ;
+#endif
+}
+
+/* Cut the journal after n records, write a new header if n is 0. */
+static int cut_journal(unsigned int n)
+{
+  const long len = n ? sizeof(tdbhead_t) + n * sizeof(tdbrec_t) : 0;
+  tdbhead_t h;
+
+#ifdef USE_FTRUNCATE
+  if (fflush(jnl.f) || ftruncate(fileno(jnl.f), len))
+    return -1;
+#else
+  /* No ftruncate(): rewrite the file. */
+  char * buf = malloc(len + 1);
+  int err = !buf || fseek(jnl.f, 0, SEEK_SET)
+    || fread(buf, 1, len, jnl.f) != (size_t) len;
+
+  if (!err) {
+    fclose(jnl.f);
+    jnl.f = fopen(jnl.fname, "w+b");
+    err = !jnl.f || fwrite(buf, 1, len, jnl.f) != (size_t) len;
+  }
+  free(buf);
+  if (err)
+    return -1;
+#endif
+  if (!n) {
+    set_head(&h, jnl_magic, 0);
+    if (fwrite(&h, sizeof(h), 1, jnl.f) != 1)
+      return -1;
+  }
+  return fflush(jnl.f);
+}
+
+/* Check the journal header and cut a truncated record. The journal
+ * must be locked. Leaves the file position at the end. */
+static int check_journal(void)
+{
+  tdbhead_t h;
+  long size;
+
+  if (fseek(jnl.f, 0, SEEK_SET))
+    return -1;
+  if (fread(&h, sizeof(h), 1, jnl.f) != 1 || check_head(&h, jnl_magic))
+    return cut_journal(0);
+  if (fseek(jnl.f, 0, SEEK_END) || (size = ftell(jnl.f)) < 0)
+    return -1;
+  size -= sizeof(h);
+  if (size % sizeof(tdbrec_t)) {
+    TRACE68(tdb_cat, "timedb68: cut truncated journal record -- %ld\n",
+            size / (long) sizeof(tdbrec_t));
+    return cut_journal(size / sizeof(tdbrec_t));
+  }
+  return 0;
+}
+
+/* Open the journal for appending, create it if needed. */
+static int open_journal(void)
+{
+  if (jnl.f)
+    return 0;
+  if (jnl.fname = tdb_path(TDB_JOURNAL), !jnl.fname)
+    return -1;
+  jnl.f = fopen(jnl.fname, "a+b");
+  if (!jnl.f) {
+    TRACE68(tdb_cat, "timedb68: can't open journal -- *%s*\n", jnl.fname);
+    free(jnl.fname);
+    jnl.fname = 0;
+    return -1;
+  }
+  return 0;
+}
+
+static void close_journal(void)
+{
+  if (jnl.f) {
+    fclose(jnl.f);
+    jnl.f = 0;
+  }
+  free(jnl.fname);
+  jnl.fname = 0;
+}
+
+/* Write records to a new image file. */
+static int write_image(const char * fname, const tdbrec_t * rec,
+                       unsigned int count)
+{
+  char * tmp = strcatdup68(fname, ".tmp");
+  tdbhead_t h;
+  FILE * f;
+  int err = -1;
+
+  if (!tmp)
+    return -1;
+  set_head(&h, img_magic, count);
+  f = fopen(tmp, "wb");
+  if (f) {
+    err = fwrite(&h, sizeof(h), 1, f) != 1
+      || fwrite(rec, sizeof(*rec), count, f) != count;
+    err |= fclose(f);
+    if (!err) {
+#ifdef FILE68_WIN32
+      remove(fname);                    /* rename() does not replace */
+#endif
+      err = rename(tmp, fname);
+    }
+    if (err)
+      remove(tmp);
+  }
+  free(tmp);
+  return -!!err;
+}
+
+/* ,-----------------------------------------------------------------.
+ * |                    Database (tdb_mutex held)                    |
+ * `-----------------------------------------------------------------'
+ */
+
+static int get_rec(int hash, int track, unsigned int * frames, int * flags)
+{
+  dbentry_t k, *s;
+  const tdbrec_t * r;
+  tdbrec_t e;
+
+  /* Journal first, then image, then built-in. */
+  e.hash = (unsigned int) hash >> HFIX;
+  e.data = REC_DATA((unsigned) track & ((1u<<TBIT)-1), 0, 0);
+  if ((unsigned)track < (1u << TBIT)) {
+    int idx = 0;
+    if ( (r = search_jnl(&e)) )
+      idx = dbcount + img.count + (r - jnl.rec);
+    else if ( (r = bsearch(&e, img.rec, img.count, sizeof(tdbrec_t), cmp_rec)) )
+      idx = dbcount + (r - img.rec);
+    if (r) {
+      if (frames) *frames = REC_FRAMES(r);
+      if (flags)  *flags  = REC_FLAGS(r);
+      return idx;
+    }
+  }
+
+  k.hash   = e.hash;
+  k.track  = track;
+  s = search_for(&k);
   if (s) {
     if (frames) *frames = s->frames;
     if (flags)  *flags  = s->flags;
@@ -149,13 +561,228 @@ int timedb68_get(int hash, int track, unsigned int * frames, int * flags)
   return -1;
 }
 
-int timedb68_load(void) {
-  return -1;
+static int add_rec(int hash, int track, unsigned int frames, int flags)
+{
+  unsigned int oframes;
+  int oflags, idx;
+  tdbrec_t e;
+
+  if ((unsigned)track >= (1u << TBIT) || frames >= (1u << FBIT) )
+    return -1;
+
+  e.hash = (unsigned int) hash >> HFIX;
+  e.data = REC_DATA((unsigned) track, (unsigned) flags & ((1u<<WBIT)-1),
+                    frames);
+
+  /* Nothing to do if the database already knows. */
+  idx = get_rec(hash, track, &oframes, &oflags);
+  if (idx >= 0 && oframes == frames && oflags == REC_FLAGS(&e))
+    return idx;
+
+  if (add_jnl(&e))
+    return -1;
+  dbchange = 1;
+
+  if (!open_journal()) {
+    int err;
+    lock_journal(1);
+    err = check_journal()
+      || fwrite(&e, sizeof(e), 1, jnl.f) != 1 || fflush(jnl.f);
+    if (jnl.f)
+      lock_journal(0);
+    if (err) {
+      msg68_warning("timedb68: %s\n", "failed to write the journal");
+      close_journal();
+    }
+  }
+  return get_rec(hash, track, 0, 0);
 }
 
-int timedb68_save(void) {
-  if (dbchange) {
-    dbchange = 0;
+static void unload(void)
+{
+  close_journal();
+  unmap_image();
+  free(jnl.rec);
+  memset(&jnl, 0, sizeof(jnl));
+  dbchange = 0;
+  msg68_cat_free(tdb_cat);
+  tdb_cat = msg68_DEFAULT;
+}
+
+static int load(void)
+{
+  char * fname;
+  FILE * f;
+  int n = 0;
+
+  unload();
+  if (tdb_cat == msg68_DEFAULT) {
+    tdb_cat = msg68_cat("timedb", "time database", DEBUG_TIMEDB68_O);
+    if (tdb_cat == -1)
+      tdb_cat = msg68_DEFAULT;
   }
-  return -1;
+
+  if (fname = tdb_path(TDB_IMAGE), !fname)
+    return -1;
+  map_image(fname);
+  free(fname);
+
+  if (fname = tdb_path(TDB_JOURNAL), !fname)
+    return -1;
+  if (f = fopen(fname, "rb"), f) {
+    n = replay_journal(f);
+    fclose(f);
+  }
+  free(fname);
+  dbchange = n > 0;
+
+  return 0;
+}
+
+/* Reload the image file, keep the current one on failure. */
+static void reload_image(const char * fname)
+{
+  const tdbimg_t old = img;
+
+  memset(&img, 0, sizeof(img));
+  if (map_image(fname))
+    img = old;
+  else {
+    const tdbimg_t cur = img;
+    img = old;
+    unmap_image();
+    img = cur;
+  }
+}
+
+static int save(void)
+{
+  tdbrec_t * rec = 0;
+  unsigned int i, j, k;
+  char * fname;
+  int err = -1, locked = 0;
+
+  if (!dbchange)
+    return 0;
+  if (fname = tdb_path(TDB_IMAGE), !fname)
+    return -1;
+
+  /* Another process may have appended the journal or saved a new
+   * image since they were loaded. Reload both with the journal
+   * locked, then add our own records again: some of them may have
+   * failed to reach the journal. */
+  if (!open_journal()) {
+    const tdbjnl_t own = jnl;
+    int fail;
+
+    lock_journal(1);
+    locked = 1;
+    jnl.rec = 0;
+    jnl.count = jnl.max = jnl.sorted = 0;
+    fail = check_journal() || replay_journal(jnl.f) < 0;
+    for (i = 0; !fail && i < own.count; ++i)
+      fail = add_jnl(own.rec+i);
+    if (fail) {
+      free(jnl.rec);
+      jnl.rec    = own.rec;
+      jnl.count  = own.count;
+      jnl.max    = own.max;
+      jnl.sorted = own.sorted;
+      goto out;
+    }
+    free(own.rec);
+    reload_image(fname);
+  }
+
+  merge_jnl();
+  rec = malloc((img.count + jnl.count + 1) * sizeof(*rec));
+  if (!rec)
+    goto out;
+
+  /* Merge image and journal, journal wins. */
+  for (i = j = k = 0; i < img.count || j < jnl.count; ) {
+    const int v = i == img.count ? 1
+      : j == jnl.count ? -1
+      : cmp_rec(img.rec+i, jnl.rec+j);
+    if (v < 0)
+      rec[k++] = img.rec[i++];
+    else {
+      i += !v;
+      rec[k++] = jnl.rec[j++];
+    }
+  }
+
+  err = write_image(fname, rec, k);
+  if (!err) {
+    TRACE68(tdb_cat, "timedb68: saved image -- %u entries\n", k);
+    /* The new image replaces the journal. */
+    if (locked && cut_journal(0))
+      close_journal();
+    jnl.count = jnl.sorted = 0;
+    dbchange = 0;
+    unmap_image();
+    if (map_image(fname)) {
+      /* Keep the records in memory if the image can't be mapped. */
+      img.base  = rec;
+      img.rec   = rec;
+      img.count = k;
+      rec = 0;
+    }
+  } else
+    msg68_warning("timedb68: failed to save -- *%s*\n", fname);
+
+out:
+  if (locked && jnl.f)
+    lock_journal(0);
+  free(rec);
+  free(fname);
+  return err;
+}
+
+/* ,-----------------------------------------------------------------.
+ * |                          Public API                             |
+ * `-----------------------------------------------------------------'
+ */
+
+int timedb68_add(int hash, int track, unsigned int frames, int flags)
+{
+  int idx;
+  tdb_lock();
+  idx = add_rec(hash, track, frames, flags);
+  tdb_unlock();
+  return idx;
+}
+
+int timedb68_get(int hash, int track, unsigned int * frames, int * flags)
+{
+  int idx;
+  tdb_lock();
+  idx = get_rec(hash, track, frames, flags);
+  tdb_unlock();
+  return idx;
+}
+
+int timedb68_load(void)
+{
+  int err;
+  tdb_lock();
+  err = load();
+  tdb_unlock();
+  return err;
+}
+
+int timedb68_save(void)
+{
+  int err;
+  tdb_lock();
+  err = save();
+  tdb_unlock();
+  return err;
+}
+
+void timedb68_unload(void)
+{
+  tdb_lock();
+  unload();
+  tdb_unlock();
 }
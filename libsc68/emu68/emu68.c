@@ -35,6 +35,8 @@
 
 #include "emu68.h"
 #include "ioplug68.h"
+#include "icache68.h"
+#include "memimg68.h"
 #include "io68/io68.h"
 
 #include "macro68.h"
@@ -44,6 +46,10 @@
 #include <stdio.h>
 
 EMU68_EXTERN linefunc68_t *line_func[1024];
+#ifdef EMU68_OPTABLE
+EMU68_EXTERN linefunc68_t *emu68_optable[0x10000];
+EMU68_EXTERN void emu68_optable_init(void);
+#endif
 
 /* ,-----------------------------------------------------------------.
  * |                     Internal struct access                      |
@@ -184,7 +190,7 @@ const char * emu68_exception_name(unsigned int vector, char * buf)
  * `-----------------------------------------------------------------'
  */
 
-u8 * emu68_memptr(emu68_t * const emu68, addr68_t dst, uint68_t sz)
+static u8 * memptr(emu68_t * const emu68, addr68_t dst, uint68_t sz)
 {
   u8 * ptr = 0;
   if (emu68) {
@@ -202,9 +208,18 @@ u8 * emu68_memptr(emu68_t * const emu68, addr68_t dst, uint68_t sz)
   return ptr;
 }
 
+/* The returned pointer might be used to modify the memory. */
+u8 * emu68_memptr(emu68_t * const emu68, addr68_t dst, uint68_t sz)
+{
+  u8 * ptr = memptr(emu68,dst,sz);
+  if (ptr && sz)
+    icache68_inval(emu68, dst, sz);
+  return ptr;
+}
+
 u8 * emu68_chkptr(emu68_t * const emu68, addr68_t dst, uint68_t sz)
 {
-  u8 * ptr = emu68_memptr(emu68,dst,sz);
+  u8 * ptr = memptr(emu68,dst,sz);
   if (ptr && emu68->chk) {
     ptr = emu68->chk + (ptr - emu68->mem);
   }
@@ -230,10 +245,10 @@ int emu68_chkpeek(emu68_t * const emu68, addr68_t addr)
 
 int emu68_poke(emu68_t * const emu68, addr68_t addr, int68_t v)
 {
-  return emu68
-    ? (emu68->mem[addr & MEMMSK68] = v)
-    : -1
-    ;
+  if (!emu68)
+    return -1;
+  icache68_write(emu68, addr, 1);
+  return emu68->mem[addr & MEMMSK68] = v;
 }
 
 int emu68_chkpoke(emu68_t * const emu68, addr68_t addr, int68_t v)
@@ -260,7 +275,7 @@ int emu68_memput(emu68_t * const emu68, addr68_t dst, const u8 *src, uint68_t sz
  */
 int emu68_memget(emu68_t * const emu68, u8 *dst, addr68_t src, uint68_t sz)
 {
-  u8 * ptr = emu68_memptr(emu68,src,sz);
+  u8 * ptr = memptr(emu68,src,sz);
   if (ptr) {
     memcpy(dst,ptr,sz);
   }
@@ -344,7 +359,10 @@ uint68_t emu68_crc32(emu68_t * const emu68)
 /* Process a single instruction emulation. */
 static inline void step68(emu68_t * const emu68)
 {
-  int line,opw,reg9;
+#ifndef EMU68_OPTABLE
+  int line,reg9;
+#endif
+  int opw;
   u8 * mem;
 
   assert( emu68->status == EMU68_NRM );
@@ -356,11 +374,34 @@ static inline void step68(emu68_t * const emu68)
       return;
   }
 
+  /* Predecoded instruction. The cache is not used when memory
+   * accesses are routed to a memory IO (debug mode).
+   */
+  if (emu68->icache && !emu68->memio &&
+      !mem68_is_io(REG68.pc | (REG68.pc + ICACHE68_SPAN - 1))) {
+    const addr68_t adr = REG68.pc & MEMMSK68;
+    icache68_entry_t * e
+      = emu68->icache->ent + ( (adr >> 1) & emu68->icache->msk );
+    if (e->pc == adr || (e = icache68_decode(emu68, REG68.pc), e)) {
+      REG68.pc += 2;
+      emu68->icx_pc  = REG68.pc;
+      emu68->icx_len = ICACHE68_SPAN - 2;
+      emu68->icx     = e->ext;
+      (e->fn)(emu68, e->reg9, e->reg0);
+      return;
+    }
+  }
+  emu68->icx_len = 0;
+
   /* TODO: check address valid */
   mem = emu68->mem + (REG68.pc & (MEMMSK68 & ~1));
   REG68.pc += 2;
   opw  = (mem[0]<<8) | mem[1];
 
+#ifdef EMU68_OPTABLE
+  /* Direct op-word dispatch. */
+  (emu68_optable[opw])(emu68, (opw >> 9) & 7, opw & 7);
+#else
  /* 68000 OP-WORD format :
   *  1111 0000 0000 0000 ( LINE  )
   *  0000 0001 1111 1000 ( OP    )
@@ -379,6 +420,7 @@ static inline void step68(emu68_t * const emu68)
   line >>= 6;
   opw  &=  7;           /* 0000 000 000-000 111 */
   (line_func[line])(emu68, reg9, opw);
+#endif
 }
 
 static inline int valid_bp(const unsigned int id) {
@@ -426,6 +468,7 @@ static inline int controlled_step68(emu68_t * const emu68)
 
   /* Execute 68K instruction. */
   step68(emu68);
+  ++emu68->inst_cnt;
 
   /* Instruction countdown */
   if ( emu68->instructions && !--emu68->instructions )
@@ -547,6 +590,7 @@ int emu68_interrupt(emu68_t * const emu68, cycle68_t cycleperpass)
         break;
       emu68->cycle = t->cycle;
       if (t->level > ipl) {
+        ++emu68->irq_cnt;
         inl_exception68(emu68, t->vector, t->level);
         if (emu68->status != EMU68_NRM)
 
@@ -687,6 +731,13 @@ emu68_t * emu68_create(emu68_parms_t * const parms)
     goto error;
   }
 
+#ifdef EMU68_NODEBUG
+  if (p->debug) {
+    emu68_error_add(emu68, "debug mode not supported by this build");
+    goto error;
+  }
+#endif
+
   if (!p->clock) {
     p->clock = def_parms.clock;
   }
@@ -697,7 +748,7 @@ emu68_t * emu68_create(emu68_parms_t * const parms)
   }
 
   memsize = 1 << p->log2mem;
-  membyte = sizeof(emu68_t) + (memsize << !!p->debug);
+  membyte = sizeof(emu68_t) + (p->debug ? memsize : 0);
   emu68   = emu68_alloc(membyte);
   if (!emu68)
     goto error;
@@ -710,8 +761,18 @@ emu68_t * emu68_create(emu68_parms_t * const parms)
 
   emu68->log2mem = p->log2mem;
   emu68->memmsk  = memsize-1;
-  emu68->chk     = p->debug ? emu68->mem + memsize + 8 : 0;
+  emu68->chk     = p->debug ? emu68->buf : 0;
+  if (memimg68_alloc(emu68)) {
+    emu68_free(emu68);
+    emu68 = 0;
+    goto error;
+  }
   emu68_mem_init(emu68);
+
+  /* The instruction cache is optional, run without on failure. */
+  if (p->icache >= 0)
+    icache68_create(emu68, p->icache);
+
   /* Notice that emu68_reset() triggers the HWVECTOR_INIT exception
    * but it won't be catch by the user as as at this point it is null.
    */
@@ -721,30 +782,60 @@ error:
   return emu68;
 }
 
+/* Duplicate the IO-list from its tail so that the duplicate IOs end
+ * up in the same order. */
+static int dup_iolist(emu68_t * const emu68, emu68_t * const emu68src,
+                      io68_t * const io)
+{
+  io68_t * dup;
+
+  if (!io)
+    return 0;
+  if (dup_iolist(emu68, emu68src, io->next))
+    return -1;
+  dup = io->duplicate ? io->duplicate(io, emu68) : 0;
+  if (!dup) {
+    emu68_error_add(emu68src, "duplicate -- failed to duplicate IO '%s'",
+                    io->name);
+    return -1;
+  }
+  emu68_ioplug(emu68, dup);
+  if (emu68src->interrupt_io == io)
+    emu68->interrupt_io = dup;
+  return 0;
+}
+
 emu68_t * emu68_duplicate(emu68_t * emu68src, const char * dupname)
 {
   emu68_parms_t parms;
   emu68_t * emu68 = 0;
 
-  assert(!"This function needs rework");
-  return 0;
-
   assert(emu68src);
   if (!emu68src)
     goto error;
 
   /* Create an instance with the same parameters */
-  parms.name    = dupname;
-  parms.log2mem = emu68->log2mem;
-  parms.clock   = emu68->clock;
-  parms.debug   = !!emu68->chk;
+  parms.name    = dupname ? dupname : emu68src->name;
+  parms.log2mem = emu68src->log2mem;
+  parms.clock   = emu68src->clock;
+  parms.debug   = !!emu68src->chk;
+  parms.icache  = -1;
+  if (emu68src->icache)
+    for (parms.icache = 0;
+         (1 << parms.icache) <= emu68src->icache->msk;
+         ++parms.icache)
+      ;
   emu68 = emu68_create(&parms);
   if (!emu68)
     goto error;
 
   /* Copy registers and status */
   emu68->reg          = emu68src->reg;
+  emu68->inst_pc      = emu68src->inst_pc;
+  emu68->inst_sr      = emu68src->inst_sr;
   emu68->cycle        = emu68src->cycle;
+  emu68->bus_addr     = emu68src->bus_addr;
+  emu68->bus_data     = emu68src->bus_data;
 
   /* Copy memory access control stuff */
   emu68->frm_chk_fl   = emu68src->frm_chk_fl;
@@ -764,7 +855,12 @@ emu68_t * emu68_duplicate(emu68_t * emu68src, const char * dupname)
   memcpy(emu68->breakpoints, emu68src->breakpoints,
          sizeof(emu68->breakpoints));
 
-  /* TODO: all related IO stuff */
+  /* Duplicate and plug all IO. The exception handler and its cookie
+   * belong to the caller and are not copied. */
+  if (dup_iolist(emu68, emu68src, emu68src->iohead)) {
+    emu68_destroy(emu68);
+    emu68 = 0;
+  }
 
 error:
   return emu68;
@@ -776,6 +872,8 @@ void emu68_destroy(emu68_t * const emu68)
   if (emu68) {
     emu68_ioplug_destroy_all(emu68);
     emu68_mem_destroy(emu68);
+    icache68_destroy(emu68);
+    memimg68_free(emu68);
     emu68_free(emu68);
   }
 }
@@ -825,6 +923,9 @@ void emu68_reset(emu68_t * const emu68)
     if (emu68->chk)
       memset(emu68->chk, 0, emu68->memmsk+1);
 
+    /* Reset instruction cache */
+    emu68_icache_flush(emu68);
+
     /* Notify init is complete */
     inl_exception68(emu68, HWINIT_VECTOR, -1);
   }
@@ -843,6 +944,10 @@ int emu68_init(int * argc, char ** argv)
   def_parms.clock   = EMU68_ATARIST_CLOCK;
   def_parms.debug   = 0;
 
+#ifdef EMU68_OPTABLE
+  emu68_optable_init();
+#endif
+
   /* $$$ TODO: parse argument */
   return 0;
 }
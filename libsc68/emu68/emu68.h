@@ -97,6 +97,7 @@ typedef struct {
   int log2mem;        /**< Memory amount (value of the power of 2). */
   int clock;          /**< CPU clock frequency (in hz).             */
   int debug;          /**< Run in debug mode (0:off).               */
+  int icache;         /**< Instruction cache size (2^N, -1:off).    */
 } emu68_parms_t;
 
 EMU68_API
@@ -121,17 +122,18 @@ EMU68_API
 /**
  * Duplicate a 68k emulator instance.
  *
- *   The emu68_dup() function creates an new instance of the 68k
- *   emulator which is a duplicate of the given emu68 instance.
+ *   The emu68_duplicate() function creates an new instance of the
+ *   68k emulator which is a duplicate of the given emu68 instance:
+ *   registers, memory, breakpoints and all pluged IO (using their
+ *   io68_t::duplicate function) in the same order. The duplicate runs
+ *   independently of the original. The exception handler and the
+ *   cookie are not copied.
  *
  * @param  emu68  emulator instance to duplicate
- * @param  name   duplicate emulator name [0:auto]
+ * @param  name   duplicate emulator name [0:same]
  *
  * @return        duplicated emu68 instance
- * @retval  0     on error
- *
- * @todo Duplicate attached IO is currently not supported since IO
- *       modules do not have a dup() function.
+ * @retval  0     on error (IO without duplicate function ...)
  */
 emu68_t * emu68_duplicate(emu68_t * emu68, const char * name);
 
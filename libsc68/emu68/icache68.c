@@ -0,0 +1,164 @@
+/*
+ * @file    emu68/icache68.c
+ * @brief   68k predecoded instruction cache
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "emu68_private.h"
+#include "icache68.h"
+#include "mem68.h"
+#include "error68.h"
+#include "assert68.h"
+
+#include <string.h>
+
+EMU68_EXTERN linefunc68_t *line_func[1024];
+#ifdef EMU68_OPTABLE
+EMU68_EXTERN linefunc68_t *emu68_optable[0x10000];
+#endif
+
+int icache68_create(emu68_t * const emu68, int log2ent)
+{
+  icache68_t * ic;
+  int nent, npage, size;
+
+  assert(emu68);
+  assert(!emu68->icache);
+
+  if (!log2ent)
+    log2ent = ICACHE68_LOG2ENT;
+  if (log2ent < 4 || log2ent > 16) {
+    emu68_error_add(emu68, "icache -- invalid number of entries -- 2^%d",
+                    log2ent);
+    return -1;
+  }
+  nent  = 1 << log2ent;
+  npage = (emu68->memmsk >> ICACHE68_LOG2PAGE) + 1;
+  size  = sizeof(*ic) + nent * sizeof(*ic->ent) + npage;
+
+  ic = emu68_alloc(size);
+  if (!ic) {
+    emu68_error_add(emu68, "icache -- alloc error (%d bytes)", size);
+    return -1;
+  }
+  ic->msk  = nent - 1;
+  ic->ent  = (icache68_entry_t *) (ic + 1);
+  ic->page = (u8 *) (ic->ent + nent);
+  emu68->icache = ic;
+  emu68_icache_flush(emu68);
+
+  return 0;
+}
+
+void icache68_destroy(emu68_t * const emu68)
+{
+  if (emu68) {
+    emu68_free(emu68->icache);
+    emu68->icache  = 0;
+    emu68->icx_len = 0;
+  }
+}
+
+void emu68_icache_flush(emu68_t * const emu68)
+{
+  if (emu68) {
+    icache68_t * const ic = emu68->icache;
+    emu68->icx_len = 0;
+    if (ic) {
+      /* All bits set gives an odd (thus invalid) address. */
+      memset(ic->ent, 0xFF, (ic->msk + 1) * sizeof(*ic->ent));
+      memset(ic->page, 0, (emu68->memmsk >> ICACHE68_LOG2PAGE) + 1);
+    }
+  }
+}
+
+icache68_entry_t * icache68_decode(emu68_t * const emu68, const addr68_t pc)
+{
+  icache68_t * const ic = emu68->icache;
+  const addr68_t msk = MEMMSK68;
+  const addr68_t adr = pc & msk;
+  const u8 * const mem = emu68->mem;
+  icache68_entry_t * const e = ic->ent + ( (adr >> 1) & ic->msk );
+  int line, opw, reg9, i;
+
+  /* Extension words must not be read from IO space. */
+  if ( (pc & 1) || mem68_is_io(pc | (pc + ICACHE68_SPAN - 1)) )
+    return 0;
+
+  /* Same decoding than step68() */
+  opw  = (mem[adr] << 8) | mem[adr+1];
+  line = opw & 0170000;
+  opw -= line;
+  reg9 = opw &   07000;
+  opw -= reg9;
+  line |= opw << 3;
+  line >>= 6;
+
+  e->pc   = adr;
+#ifdef EMU68_OPTABLE
+  e->fn   = emu68_optable[(mem[adr] << 8) | mem[adr+1]];
+#else
+  e->fn   = line_func[line];
+#endif
+  e->reg9 = reg9 >> 9;
+  e->reg0 = opw & 7;
+  for (i = 0; i < ICACHE68_NEXT; ++i) {
+    const addr68_t a = (adr + 2 + 2*i) & msk;
+    e->ext[i] = (mem[a] << 8) | mem[a+1];
+  }
+
+  ic->page[ adr >> ICACHE68_LOG2PAGE ] = 1;
+  ic->page[ ((adr + ICACHE68_SPAN - 1) & msk) >> ICACHE68_LOG2PAGE ] = 1;
+
+  return e;
+}
+
+void icache68_inval(emu68_t * const emu68, addr68_t addr, int len)
+{
+  icache68_t * const ic = emu68->icache;
+  const addr68_t msk = MEMMSK68;
+  addr68_t adr, end;
+
+  if (!ic)
+    return;
+
+  /* Large areas are faster to flush entirely. */
+  if (len > 2 * ic->msk) {
+    emu68_icache_flush(emu68);
+    return;
+  }
+
+  /* The instruction being executed might have been modified. */
+  emu68->icx_len = 0;
+
+  /* Every entry that spans over the written bytes. */
+  for (adr = (addr - ICACHE68_SPAN + 2) & ~1, end = addr + len;
+       adr < end; adr += 2) {
+    const addr68_t a = adr & msk;
+    icache68_entry_t * const e = ic->ent + ( (a >> 1) & ic->msk );
+    if (e->pc == a)
+      e->pc = -1;
+  }
+}
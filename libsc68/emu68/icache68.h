@@ -0,0 +1,130 @@
+/**
+ * @ingroup   lib_emu68
+ * @file      emu68/icache68.h
+ * @brief     68k predecoded instruction cache header.
+ * @author    Benjamin Gerard
+ * @date      2016/03/12
+ */
+
+/* Copyright (c) 1998-2016 Benjamin Gerard */
+
+#ifndef EMU68_ICACHE68_H
+#define EMU68_ICACHE68_H
+
+#include "emu68_api.h"
+#include "struct68.h"
+
+/**
+ * @defgroup  lib_emu68_icache  68k instruction cache
+ * @ingroup   lib_emu68
+ * @brief     Predecoded instruction cache.
+ *
+ *   The instruction cache is a direct mapped table indexed by the
+ *   program counter. Each entry holds the decoded op-word (handler
+ *   and register fields) and the words that follow it, so that the
+ *   extension words are read from the cache instead of going through
+ *   the memory access functions.
+ *
+ *   Entries are invalidated by any write into a memory page that
+ *   contains cached code. Pages are flagged when an entry is
+ *   decoded so that writes to data pages cost a single table lookup.
+ *
+ *   The cache is bypassed whenever a memory IO is installed (debug
+ *   mode or memory access hooks) so that the memory access control
+ *   flags remain exact.
+ *
+ * @{
+ */
+
+enum {
+  ICACHE68_LOG2ENT  = 12,          /**< default number of entries (2^N) */
+  ICACHE68_LOG2PAGE = 8,           /**< invalidation page size (2^N)    */
+  ICACHE68_NEXT     = 4,           /**< cached words after the op-word  */
+  ICACHE68_SPAN     = 2 + 2*ICACHE68_NEXT /**< bytes covered by an entry */
+};
+
+/** Instruction cache entry. */
+typedef struct {
+  addr68_t       pc;               /**< op-word address (odd:invalid). */
+  linefunc68_t * fn;               /**< instruction handler.           */
+  int            reg9;             /**< op-word bits 9-11.             */
+  int            reg0;             /**< op-word bits 0-2.              */
+  u16            ext[ICACHE68_NEXT]; /**< words following the op-word. */
+} icache68_entry_t;
+
+/** Instruction cache. */
+struct icache68_s {
+  int                msk;          /**< entry index mask.              */
+  u8               * page;         /**< pages with cached code.        */
+  icache68_entry_t * ent;          /**< entries.                       */
+};
+
+EMU68_EXTERN
+/**
+ * Create the instruction cache of an emulator instance.
+ *
+ * @param  emu68    emulator instance
+ * @param  log2ent  number of entries (2^log2ent) [0:default]
+ *
+ * @return error-code
+ * @retval  0  on success
+ * @retval -1  on error
+ */
+int icache68_create(emu68_t * const emu68, int log2ent);
+
+EMU68_EXTERN
+/**
+ * Destroy the instruction cache of an emulator instance.
+ */
+void icache68_destroy(emu68_t * const emu68);
+
+EMU68_API
+/**
+ * Invalidate all cache entries.
+ *
+ *   Must be called after the memory has been modified by other means
+ *   than the emulated CPU or the emu68 memory functions.
+ *
+ * @param  emu68  emulator instance
+ */
+void emu68_icache_flush(emu68_t * const emu68);
+
+EMU68_EXTERN
+/**
+ * Decode an instruction into its cache entry (cache miss).
+ *
+ * @return cache entry
+ * @retval 0 if the instruction can not be cached
+ */
+icache68_entry_t * icache68_decode(emu68_t * const emu68, const addr68_t pc);
+
+EMU68_EXTERN
+/**
+ * Invalidate entries overlapping a memory range (slow path).
+ */
+void icache68_inval(emu68_t * const emu68, addr68_t addr, int len);
+
+/**
+ * Invalidate entries overlapping a memory written range.
+ *
+ *   This is a quick test on the written page(s). The slow path is
+ *   only taken for pages that hold cached code.
+ */
+static inline
+void icache68_write(emu68_t * const emu68, const addr68_t addr, const int len)
+{
+  const icache68_t * const ic = emu68->icache;
+  if (ic) {
+    const u8 * const page = ic->page;
+    const addr68_t msk = emu68->memmsk;
+    if (page[(addr & msk) >> ICACHE68_LOG2PAGE] |
+        page[((addr+len-1) & msk) >> ICACHE68_LOG2PAGE])
+      icache68_inval(emu68, addr, len);
+  }
+}
+
+/**
+ * @}
+ */
+
+#endif
@@ -620,6 +620,1330 @@ DECL_STATIC_LINE68((* const line4_3_func[8])) = {
   line4_r4_s3,line4_r5_s3,line4_r6_s3,line4_r7_s3,
 };
 
+#ifdef EMU68_OPTABLE
+
+DECL_LINE68(op4_r0_s0_m0)
+{
+  line4_r0_s0(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r0_s0_m1)
+{
+  line4_r0_s0(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r0_s0_m2)
+{
+  line4_r0_s0(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r0_s0_m3)
+{
+  line4_r0_s0(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r0_s0_m4)
+{
+  line4_r0_s0(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r0_s0_m5)
+{
+  line4_r0_s0(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r0_s0_m6)
+{
+  line4_r0_s0(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r0_s0_m7)
+{
+  line4_r0_s0(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r1_s0_m0)
+{
+  line4_r1_s0(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r1_s0_m1)
+{
+  line4_r1_s0(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r1_s0_m2)
+{
+  line4_r1_s0(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r1_s0_m3)
+{
+  line4_r1_s0(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r1_s0_m4)
+{
+  line4_r1_s0(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r1_s0_m5)
+{
+  line4_r1_s0(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r1_s0_m6)
+{
+  line4_r1_s0(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r1_s0_m7)
+{
+  line4_r1_s0(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r2_s0_m0)
+{
+  line4_r2_s0(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r2_s0_m1)
+{
+  line4_r2_s0(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r2_s0_m2)
+{
+  line4_r2_s0(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r2_s0_m3)
+{
+  line4_r2_s0(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r2_s0_m4)
+{
+  line4_r2_s0(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r2_s0_m5)
+{
+  line4_r2_s0(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r2_s0_m6)
+{
+  line4_r2_s0(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r2_s0_m7)
+{
+  line4_r2_s0(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r3_s0_m0)
+{
+  line4_r3_s0(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r3_s0_m1)
+{
+  line4_r3_s0(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r3_s0_m2)
+{
+  line4_r3_s0(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r3_s0_m3)
+{
+  line4_r3_s0(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r3_s0_m4)
+{
+  line4_r3_s0(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r3_s0_m5)
+{
+  line4_r3_s0(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r3_s0_m6)
+{
+  line4_r3_s0(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r3_s0_m7)
+{
+  line4_r3_s0(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r4_s0_m0)
+{
+  line4_r4_s0(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r4_s0_m1)
+{
+  line4_r4_s0(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r4_s0_m2)
+{
+  line4_r4_s0(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r4_s0_m3)
+{
+  line4_r4_s0(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r4_s0_m4)
+{
+  line4_r4_s0(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r4_s0_m5)
+{
+  line4_r4_s0(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r4_s0_m6)
+{
+  line4_r4_s0(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r4_s0_m7)
+{
+  line4_r4_s0(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r5_s0_m0)
+{
+  line4_r5_s0(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r5_s0_m1)
+{
+  line4_r5_s0(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r5_s0_m2)
+{
+  line4_r5_s0(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r5_s0_m3)
+{
+  line4_r5_s0(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r5_s0_m4)
+{
+  line4_r5_s0(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r5_s0_m5)
+{
+  line4_r5_s0(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r5_s0_m6)
+{
+  line4_r5_s0(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r5_s0_m7)
+{
+  line4_r5_s0(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r6_s0_m0)
+{
+  line4_r6_s0(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r6_s0_m1)
+{
+  line4_r6_s0(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r6_s0_m2)
+{
+  line4_r6_s0(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r6_s0_m3)
+{
+  line4_r6_s0(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r6_s0_m4)
+{
+  line4_r6_s0(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r6_s0_m5)
+{
+  line4_r6_s0(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r6_s0_m6)
+{
+  line4_r6_s0(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r6_s0_m7)
+{
+  line4_r6_s0(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r7_s0_m0)
+{
+  line4_r7_s0(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r7_s0_m1)
+{
+  line4_r7_s0(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r7_s0_m2)
+{
+  line4_r7_s0(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r7_s0_m3)
+{
+  line4_r7_s0(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r7_s0_m4)
+{
+  line4_r7_s0(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r7_s0_m5)
+{
+  line4_r7_s0(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r7_s0_m6)
+{
+  line4_r7_s0(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r7_s0_m7)
+{
+  line4_r7_s0(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r0_s1_m0)
+{
+  line4_r0_s1(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r0_s1_m1)
+{
+  line4_r0_s1(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r0_s1_m2)
+{
+  line4_r0_s1(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r0_s1_m3)
+{
+  line4_r0_s1(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r0_s1_m4)
+{
+  line4_r0_s1(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r0_s1_m5)
+{
+  line4_r0_s1(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r0_s1_m6)
+{
+  line4_r0_s1(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r0_s1_m7)
+{
+  line4_r0_s1(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r1_s1_m0)
+{
+  line4_r1_s1(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r1_s1_m1)
+{
+  line4_r1_s1(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r1_s1_m2)
+{
+  line4_r1_s1(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r1_s1_m3)
+{
+  line4_r1_s1(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r1_s1_m4)
+{
+  line4_r1_s1(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r1_s1_m5)
+{
+  line4_r1_s1(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r1_s1_m6)
+{
+  line4_r1_s1(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r1_s1_m7)
+{
+  line4_r1_s1(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r2_s1_m0)
+{
+  line4_r2_s1(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r2_s1_m1)
+{
+  line4_r2_s1(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r2_s1_m2)
+{
+  line4_r2_s1(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r2_s1_m3)
+{
+  line4_r2_s1(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r2_s1_m4)
+{
+  line4_r2_s1(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r2_s1_m5)
+{
+  line4_r2_s1(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r2_s1_m6)
+{
+  line4_r2_s1(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r2_s1_m7)
+{
+  line4_r2_s1(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r3_s1_m0)
+{
+  line4_r3_s1(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r3_s1_m1)
+{
+  line4_r3_s1(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r3_s1_m2)
+{
+  line4_r3_s1(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r3_s1_m3)
+{
+  line4_r3_s1(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r3_s1_m4)
+{
+  line4_r3_s1(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r3_s1_m5)
+{
+  line4_r3_s1(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r3_s1_m6)
+{
+  line4_r3_s1(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r3_s1_m7)
+{
+  line4_r3_s1(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r4_s1_m0)
+{
+  line4_r4_s1(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r4_s1_m1)
+{
+  line4_r4_s1(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r4_s1_m2)
+{
+  line4_r4_s1(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r4_s1_m3)
+{
+  line4_r4_s1(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r4_s1_m4)
+{
+  line4_r4_s1(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r4_s1_m5)
+{
+  line4_r4_s1(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r4_s1_m6)
+{
+  line4_r4_s1(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r4_s1_m7)
+{
+  line4_r4_s1(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r5_s1_m0)
+{
+  line4_r5_s1(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r5_s1_m1)
+{
+  line4_r5_s1(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r5_s1_m2)
+{
+  line4_r5_s1(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r5_s1_m3)
+{
+  line4_r5_s1(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r5_s1_m4)
+{
+  line4_r5_s1(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r5_s1_m5)
+{
+  line4_r5_s1(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r5_s1_m6)
+{
+  line4_r5_s1(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r5_s1_m7)
+{
+  line4_r5_s1(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r6_s1_m0)
+{
+  line4_r6_s1(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r6_s1_m1)
+{
+  line4_r6_s1(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r6_s1_m2)
+{
+  line4_r6_s1(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r6_s1_m3)
+{
+  line4_r6_s1(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r6_s1_m4)
+{
+  line4_r6_s1(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r6_s1_m5)
+{
+  line4_r6_s1(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r6_s1_m6)
+{
+  line4_r6_s1(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r6_s1_m7)
+{
+  line4_r6_s1(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r7_s1_m0)
+{
+  funky4_m0(emu68,reg0);
+}
+
+DECL_LINE68(op4_r7_s1_m1)
+{
+  funky4_m1(emu68,reg0);
+}
+
+DECL_LINE68(op4_r7_s1_m2)
+{
+  funky4_m2(emu68,reg0);
+}
+
+DECL_LINE68(op4_r7_s1_m3)
+{
+  funky4_m3(emu68,reg0);
+}
+
+DECL_LINE68(op4_r7_s1_m4)
+{
+  funky4_m4(emu68,reg0);
+}
+
+DECL_LINE68(op4_r7_s1_m5)
+{
+  funky4_m5(emu68,reg0);
+}
+
+DECL_LINE68(op4_r7_s1_m6)
+{
+  funky4_m6_func[reg0](emu68);
+}
+
+DECL_LINE68(op4_r7_s1_m7)
+{
+  funky4_m7(emu68,reg0);
+}
+
+DECL_LINE68(op4_r0_s2_m0)
+{
+  line4_r0_s2(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r0_s2_m1)
+{
+  line4_r0_s2(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r0_s2_m2)
+{
+  line4_r0_s2(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r0_s2_m3)
+{
+  line4_r0_s2(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r0_s2_m4)
+{
+  line4_r0_s2(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r0_s2_m5)
+{
+  line4_r0_s2(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r0_s2_m6)
+{
+  line4_r0_s2(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r0_s2_m7)
+{
+  line4_r0_s2(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r1_s2_m0)
+{
+  line4_r1_s2(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r1_s2_m1)
+{
+  line4_r1_s2(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r1_s2_m2)
+{
+  line4_r1_s2(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r1_s2_m3)
+{
+  line4_r1_s2(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r1_s2_m4)
+{
+  line4_r1_s2(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r1_s2_m5)
+{
+  line4_r1_s2(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r1_s2_m6)
+{
+  line4_r1_s2(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r1_s2_m7)
+{
+  line4_r1_s2(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r2_s2_m0)
+{
+  line4_r2_s2(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r2_s2_m1)
+{
+  line4_r2_s2(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r2_s2_m2)
+{
+  line4_r2_s2(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r2_s2_m3)
+{
+  line4_r2_s2(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r2_s2_m4)
+{
+  line4_r2_s2(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r2_s2_m5)
+{
+  line4_r2_s2(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r2_s2_m6)
+{
+  line4_r2_s2(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r2_s2_m7)
+{
+  line4_r2_s2(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r3_s2_m0)
+{
+  line4_r3_s2(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r3_s2_m1)
+{
+  line4_r3_s2(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r3_s2_m2)
+{
+  line4_r3_s2(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r3_s2_m3)
+{
+  line4_r3_s2(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r3_s2_m4)
+{
+  line4_r3_s2(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r3_s2_m5)
+{
+  line4_r3_s2(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r3_s2_m6)
+{
+  line4_r3_s2(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r3_s2_m7)
+{
+  line4_r3_s2(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r4_s2_m0)
+{
+  line4_r4_s2(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r4_s2_m1)
+{
+  line4_r4_s2(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r4_s2_m2)
+{
+  line4_r4_s2(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r4_s2_m3)
+{
+  line4_r4_s2(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r4_s2_m4)
+{
+  line4_r4_s2(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r4_s2_m5)
+{
+  line4_r4_s2(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r4_s2_m6)
+{
+  line4_r4_s2(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r4_s2_m7)
+{
+  line4_r4_s2(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r5_s2_m0)
+{
+  line4_r5_s2(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r5_s2_m1)
+{
+  line4_r5_s2(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r5_s2_m2)
+{
+  line4_r5_s2(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r5_s2_m3)
+{
+  line4_r5_s2(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r5_s2_m4)
+{
+  line4_r5_s2(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r5_s2_m5)
+{
+  line4_r5_s2(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r5_s2_m6)
+{
+  line4_r5_s2(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r5_s2_m7)
+{
+  line4_r5_s2(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r6_s2_m0)
+{
+  line4_r6_s2(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r6_s2_m1)
+{
+  line4_r6_s2(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r6_s2_m2)
+{
+  line4_r6_s2(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r6_s2_m3)
+{
+  line4_r6_s2(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r6_s2_m4)
+{
+  line4_r6_s2(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r6_s2_m5)
+{
+  line4_r6_s2(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r6_s2_m6)
+{
+  line4_r6_s2(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r6_s2_m7)
+{
+  line4_r6_s2(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r7_s2_m0)
+{
+  line4_r7_s2(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r7_s2_m1)
+{
+  line4_r7_s2(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r7_s2_m2)
+{
+  line4_r7_s2(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r7_s2_m3)
+{
+  line4_r7_s2(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r7_s2_m4)
+{
+  line4_r7_s2(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r7_s2_m5)
+{
+  line4_r7_s2(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r7_s2_m6)
+{
+  line4_r7_s2(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r7_s2_m7)
+{
+  line4_r7_s2(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r0_s3_m0)
+{
+  line4_r0_s3(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r0_s3_m1)
+{
+  line4_r0_s3(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r0_s3_m2)
+{
+  line4_r0_s3(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r0_s3_m3)
+{
+  line4_r0_s3(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r0_s3_m4)
+{
+  line4_r0_s3(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r0_s3_m5)
+{
+  line4_r0_s3(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r0_s3_m6)
+{
+  line4_r0_s3(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r0_s3_m7)
+{
+  line4_r0_s3(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r1_s3_m0)
+{
+  line4_r1_s3(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r1_s3_m1)
+{
+  line4_r1_s3(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r1_s3_m2)
+{
+  line4_r1_s3(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r1_s3_m3)
+{
+  line4_r1_s3(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r1_s3_m4)
+{
+  line4_r1_s3(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r1_s3_m5)
+{
+  line4_r1_s3(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r1_s3_m6)
+{
+  line4_r1_s3(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r1_s3_m7)
+{
+  line4_r1_s3(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r2_s3_m0)
+{
+  line4_r2_s3(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r2_s3_m1)
+{
+  line4_r2_s3(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r2_s3_m2)
+{
+  line4_r2_s3(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r2_s3_m3)
+{
+  line4_r2_s3(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r2_s3_m4)
+{
+  line4_r2_s3(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r2_s3_m5)
+{
+  line4_r2_s3(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r2_s3_m6)
+{
+  line4_r2_s3(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r2_s3_m7)
+{
+  line4_r2_s3(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r3_s3_m0)
+{
+  line4_r3_s3(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r3_s3_m1)
+{
+  line4_r3_s3(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r3_s3_m2)
+{
+  line4_r3_s3(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r3_s3_m3)
+{
+  line4_r3_s3(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r3_s3_m4)
+{
+  line4_r3_s3(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r3_s3_m5)
+{
+  line4_r3_s3(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r3_s3_m6)
+{
+  line4_r3_s3(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r3_s3_m7)
+{
+  line4_r3_s3(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r4_s3_m0)
+{
+  line4_r4_s3(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r4_s3_m1)
+{
+  line4_r4_s3(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r4_s3_m2)
+{
+  line4_r4_s3(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r4_s3_m3)
+{
+  line4_r4_s3(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r4_s3_m4)
+{
+  line4_r4_s3(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r4_s3_m5)
+{
+  line4_r4_s3(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r4_s3_m6)
+{
+  line4_r4_s3(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r4_s3_m7)
+{
+  line4_r4_s3(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r5_s3_m0)
+{
+  line4_r5_s3(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r5_s3_m1)
+{
+  line4_r5_s3(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r5_s3_m2)
+{
+  line4_r5_s3(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r5_s3_m3)
+{
+  line4_r5_s3(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r5_s3_m4)
+{
+  line4_r5_s3(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r5_s3_m5)
+{
+  line4_r5_s3(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r5_s3_m6)
+{
+  line4_r5_s3(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r5_s3_m7)
+{
+  line4_r5_s3(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r6_s3_m0)
+{
+  line4_r6_s3(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r6_s3_m1)
+{
+  line4_r6_s3(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r6_s3_m2)
+{
+  line4_r6_s3(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r6_s3_m3)
+{
+  line4_r6_s3(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r6_s3_m4)
+{
+  line4_r6_s3(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r6_s3_m5)
+{
+  line4_r6_s3(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r6_s3_m6)
+{
+  line4_r6_s3(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r6_s3_m7)
+{
+  line4_r6_s3(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_r7_s3_m0)
+{
+  line4_r7_s3(emu68,0,reg0);
+}
+
+DECL_LINE68(op4_r7_s3_m1)
+{
+  line4_r7_s3(emu68,1,reg0);
+}
+
+DECL_LINE68(op4_r7_s3_m2)
+{
+  line4_r7_s3(emu68,2,reg0);
+}
+
+DECL_LINE68(op4_r7_s3_m3)
+{
+  line4_r7_s3(emu68,3,reg0);
+}
+
+DECL_LINE68(op4_r7_s3_m4)
+{
+  line4_r7_s3(emu68,4,reg0);
+}
+
+DECL_LINE68(op4_r7_s3_m5)
+{
+  line4_r7_s3(emu68,5,reg0);
+}
+
+DECL_LINE68(op4_r7_s3_m6)
+{
+  line4_r7_s3(emu68,6,reg0);
+}
+
+DECL_LINE68(op4_r7_s3_m7)
+{
+  line4_r7_s3(emu68,7,reg0);
+}
+
+DECL_LINE68(op4_funky_m6_0)
+{
+  funky4_m6_0(emu68);
+}
+
+DECL_LINE68(op4_funky_m6_1)
+{
+  funky4_m6_1(emu68);
+}
+
+DECL_LINE68(op4_funky_m6_2)
+{
+  funky4_m6_2(emu68);
+}
+
+DECL_LINE68(op4_funky_m6_3)
+{
+  funky4_m6_3(emu68);
+}
+
+DECL_LINE68(op4_funky_m6_4)
+{
+  funky4_m6_4(emu68);
+}
+
+DECL_LINE68(op4_funky_m6_5)
+{
+  funky4_m6_5(emu68);
+}
+
+DECL_LINE68(op4_funky_m6_6)
+{
+  funky4_m6_6(emu68);
+}
+
+DECL_LINE68(op4_funky_m6_7)
+{
+  funky4_m6_7(emu68);
+}
+
+#endif
+
 DECL_LINE68(line400)
 {
   line4_0_func[reg9](emu68,0,reg0);
@@ -0,0 +1,206 @@
+/*
+ * @file    optable.c
+ * @brief   68k simulator generated by gen68
+ * @date    2014-07-03
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "struct68.h"
+
+#ifdef EMU68_OPTABLE
+
+EMU68_EXTERN linefunc68_t *line_func[1024];
+
+#ifndef EMU68_MONOLITIC
+EMU68_EXTERN linefunc68_t
+  op4_r0_s0_m0,op4_r0_s0_m1,op4_r0_s0_m2,op4_r0_s0_m3,
+  op4_r0_s0_m4,op4_r0_s0_m5,op4_r0_s0_m6,op4_r0_s0_m7,
+  op4_r1_s0_m0,op4_r1_s0_m1,op4_r1_s0_m2,op4_r1_s0_m3,
+  op4_r1_s0_m4,op4_r1_s0_m5,op4_r1_s0_m6,op4_r1_s0_m7,
+  op4_r2_s0_m0,op4_r2_s0_m1,op4_r2_s0_m2,op4_r2_s0_m3,
+  op4_r2_s0_m4,op4_r2_s0_m5,op4_r2_s0_m6,op4_r2_s0_m7,
+  op4_r3_s0_m0,op4_r3_s0_m1,op4_r3_s0_m2,op4_r3_s0_m3,
+  op4_r3_s0_m4,op4_r3_s0_m5,op4_r3_s0_m6,op4_r3_s0_m7,
+  op4_r4_s0_m0,op4_r4_s0_m1,op4_r4_s0_m2,op4_r4_s0_m3,
+  op4_r4_s0_m4,op4_r4_s0_m5,op4_r4_s0_m6,op4_r4_s0_m7,
+  op4_r5_s0_m0,op4_r5_s0_m1,op4_r5_s0_m2,op4_r5_s0_m3,
+  op4_r5_s0_m4,op4_r5_s0_m5,op4_r5_s0_m6,op4_r5_s0_m7,
+  op4_r6_s0_m0,op4_r6_s0_m1,op4_r6_s0_m2,op4_r6_s0_m3,
+  op4_r6_s0_m4,op4_r6_s0_m5,op4_r6_s0_m6,op4_r6_s0_m7,
+  op4_r7_s0_m0,op4_r7_s0_m1,op4_r7_s0_m2,op4_r7_s0_m3,
+  op4_r7_s0_m4,op4_r7_s0_m5,op4_r7_s0_m6,op4_r7_s0_m7,
+  op4_r0_s1_m0,op4_r0_s1_m1,op4_r0_s1_m2,op4_r0_s1_m3,
+  op4_r0_s1_m4,op4_r0_s1_m5,op4_r0_s1_m6,op4_r0_s1_m7,
+  op4_r1_s1_m0,op4_r1_s1_m1,op4_r1_s1_m2,op4_r1_s1_m3,
+  op4_r1_s1_m4,op4_r1_s1_m5,op4_r1_s1_m6,op4_r1_s1_m7,
+  op4_r2_s1_m0,op4_r2_s1_m1,op4_r2_s1_m2,op4_r2_s1_m3,
+  op4_r2_s1_m4,op4_r2_s1_m5,op4_r2_s1_m6,op4_r2_s1_m7,
+  op4_r3_s1_m0,op4_r3_s1_m1,op4_r3_s1_m2,op4_r3_s1_m3,
+  op4_r3_s1_m4,op4_r3_s1_m5,op4_r3_s1_m6,op4_r3_s1_m7,
+  op4_r4_s1_m0,op4_r4_s1_m1,op4_r4_s1_m2,op4_r4_s1_m3,
+  op4_r4_s1_m4,op4_r4_s1_m5,op4_r4_s1_m6,op4_r4_s1_m7,
+  op4_r5_s1_m0,op4_r5_s1_m1,op4_r5_s1_m2,op4_r5_s1_m3,
+  op4_r5_s1_m4,op4_r5_s1_m5,op4_r5_s1_m6,op4_r5_s1_m7,
+  op4_r6_s1_m0,op4_r6_s1_m1,op4_r6_s1_m2,op4_r6_s1_m3,
+  op4_r6_s1_m4,op4_r6_s1_m5,op4_r6_s1_m6,op4_r6_s1_m7,
+  op4_r7_s1_m0,op4_r7_s1_m1,op4_r7_s1_m2,op4_r7_s1_m3,
+  op4_r7_s1_m4,op4_r7_s1_m5,op4_r7_s1_m6,op4_r7_s1_m7,
+  op4_r0_s2_m0,op4_r0_s2_m1,op4_r0_s2_m2,op4_r0_s2_m3,
+  op4_r0_s2_m4,op4_r0_s2_m5,op4_r0_s2_m6,op4_r0_s2_m7,
+  op4_r1_s2_m0,op4_r1_s2_m1,op4_r1_s2_m2,op4_r1_s2_m3,
+  op4_r1_s2_m4,op4_r1_s2_m5,op4_r1_s2_m6,op4_r1_s2_m7,
+  op4_r2_s2_m0,op4_r2_s2_m1,op4_r2_s2_m2,op4_r2_s2_m3,
+  op4_r2_s2_m4,op4_r2_s2_m5,op4_r2_s2_m6,op4_r2_s2_m7,
+  op4_r3_s2_m0,op4_r3_s2_m1,op4_r3_s2_m2,op4_r3_s2_m3,
+  op4_r3_s2_m4,op4_r3_s2_m5,op4_r3_s2_m6,op4_r3_s2_m7,
+  op4_r4_s2_m0,op4_r4_s2_m1,op4_r4_s2_m2,op4_r4_s2_m3,
+  op4_r4_s2_m4,op4_r4_s2_m5,op4_r4_s2_m6,op4_r4_s2_m7,
+  op4_r5_s2_m0,op4_r5_s2_m1,op4_r5_s2_m2,op4_r5_s2_m3,
+  op4_r5_s2_m4,op4_r5_s2_m5,op4_r5_s2_m6,op4_r5_s2_m7,
+  op4_r6_s2_m0,op4_r6_s2_m1,op4_r6_s2_m2,op4_r6_s2_m3,
+  op4_r6_s2_m4,op4_r6_s2_m5,op4_r6_s2_m6,op4_r6_s2_m7,
+  op4_r7_s2_m0,op4_r7_s2_m1,op4_r7_s2_m2,op4_r7_s2_m3,
+  op4_r7_s2_m4,op4_r7_s2_m5,op4_r7_s2_m6,op4_r7_s2_m7,
+  op4_r0_s3_m0,op4_r0_s3_m1,op4_r0_s3_m2,op4_r0_s3_m3,
+  op4_r0_s3_m4,op4_r0_s3_m5,op4_r0_s3_m6,op4_r0_s3_m7,
+  op4_r1_s3_m0,op4_r1_s3_m1,op4_r1_s3_m2,op4_r1_s3_m3,
+  op4_r1_s3_m4,op4_r1_s3_m5,op4_r1_s3_m6,op4_r1_s3_m7,
+  op4_r2_s3_m0,op4_r2_s3_m1,op4_r2_s3_m2,op4_r2_s3_m3,
+  op4_r2_s3_m4,op4_r2_s3_m5,op4_r2_s3_m6,op4_r2_s3_m7,
+  op4_r3_s3_m0,op4_r3_s3_m1,op4_r3_s3_m2,op4_r3_s3_m3,
+  op4_r3_s3_m4,op4_r3_s3_m5,op4_r3_s3_m6,op4_r3_s3_m7,
+  op4_r4_s3_m0,op4_r4_s3_m1,op4_r4_s3_m2,op4_r4_s3_m3,
+  op4_r4_s3_m4,op4_r4_s3_m5,op4_r4_s3_m6,op4_r4_s3_m7,
+  op4_r5_s3_m0,op4_r5_s3_m1,op4_r5_s3_m2,op4_r5_s3_m3,
+  op4_r5_s3_m4,op4_r5_s3_m5,op4_r5_s3_m6,op4_r5_s3_m7,
+  op4_r6_s3_m0,op4_r6_s3_m1,op4_r6_s3_m2,op4_r6_s3_m3,
+  op4_r6_s3_m4,op4_r6_s3_m5,op4_r6_s3_m6,op4_r6_s3_m7,
+  op4_r7_s3_m0,op4_r7_s3_m1,op4_r7_s3_m2,op4_r7_s3_m3,
+  op4_r7_s3_m4,op4_r7_s3_m5,op4_r7_s3_m6,op4_r7_s3_m7,
+  op4_funky_m6_0,op4_funky_m6_1,op4_funky_m6_2,op4_funky_m6_3,
+  op4_funky_m6_4,op4_funky_m6_5,op4_funky_m6_6,op4_funky_m6_7;
+#endif
+
+/* Line 4 handlers by size, reg9 and mode. */
+static linefunc68_t * const line4_ops[4][8][8] = {
+  {
+    {op4_r0_s0_m0,op4_r0_s0_m1,op4_r0_s0_m2,op4_r0_s0_m3,
+     op4_r0_s0_m4,op4_r0_s0_m5,op4_r0_s0_m6,op4_r0_s0_m7,},
+    {op4_r1_s0_m0,op4_r1_s0_m1,op4_r1_s0_m2,op4_r1_s0_m3,
+     op4_r1_s0_m4,op4_r1_s0_m5,op4_r1_s0_m6,op4_r1_s0_m7,},
+    {op4_r2_s0_m0,op4_r2_s0_m1,op4_r2_s0_m2,op4_r2_s0_m3,
+     op4_r2_s0_m4,op4_r2_s0_m5,op4_r2_s0_m6,op4_r2_s0_m7,},
+    {op4_r3_s0_m0,op4_r3_s0_m1,op4_r3_s0_m2,op4_r3_s0_m3,
+     op4_r3_s0_m4,op4_r3_s0_m5,op4_r3_s0_m6,op4_r3_s0_m7,},
+    {op4_r4_s0_m0,op4_r4_s0_m1,op4_r4_s0_m2,op4_r4_s0_m3,
+     op4_r4_s0_m4,op4_r4_s0_m5,op4_r4_s0_m6,op4_r4_s0_m7,},
+    {op4_r5_s0_m0,op4_r5_s0_m1,op4_r5_s0_m2,op4_r5_s0_m3,
+     op4_r5_s0_m4,op4_r5_s0_m5,op4_r5_s0_m6,op4_r5_s0_m7,},
+    {op4_r6_s0_m0,op4_r6_s0_m1,op4_r6_s0_m2,op4_r6_s0_m3,
+     op4_r6_s0_m4,op4_r6_s0_m5,op4_r6_s0_m6,op4_r6_s0_m7,},
+    {op4_r7_s0_m0,op4_r7_s0_m1,op4_r7_s0_m2,op4_r7_s0_m3,
+     op4_r7_s0_m4,op4_r7_s0_m5,op4_r7_s0_m6,op4_r7_s0_m7,},
+  },
+  {
+    {op4_r0_s1_m0,op4_r0_s1_m1,op4_r0_s1_m2,op4_r0_s1_m3,
+     op4_r0_s1_m4,op4_r0_s1_m5,op4_r0_s1_m6,op4_r0_s1_m7,},
+    {op4_r1_s1_m0,op4_r1_s1_m1,op4_r1_s1_m2,op4_r1_s1_m3,
+     op4_r1_s1_m4,op4_r1_s1_m5,op4_r1_s1_m6,op4_r1_s1_m7,},
+    {op4_r2_s1_m0,op4_r2_s1_m1,op4_r2_s1_m2,op4_r2_s1_m3,
+     op4_r2_s1_m4,op4_r2_s1_m5,op4_r2_s1_m6,op4_r2_s1_m7,},
+    {op4_r3_s1_m0,op4_r3_s1_m1,op4_r3_s1_m2,op4_r3_s1_m3,
+     op4_r3_s1_m4,op4_r3_s1_m5,op4_r3_s1_m6,op4_r3_s1_m7,},
+    {op4_r4_s1_m0,op4_r4_s1_m1,op4_r4_s1_m2,op4_r4_s1_m3,
+     op4_r4_s1_m4,op4_r4_s1_m5,op4_r4_s1_m6,op4_r4_s1_m7,},
+    {op4_r5_s1_m0,op4_r5_s1_m1,op4_r5_s1_m2,op4_r5_s1_m3,
+     op4_r5_s1_m4,op4_r5_s1_m5,op4_r5_s1_m6,op4_r5_s1_m7,},
+    {op4_r6_s1_m0,op4_r6_s1_m1,op4_r6_s1_m2,op4_r6_s1_m3,
+     op4_r6_s1_m4,op4_r6_s1_m5,op4_r6_s1_m6,op4_r6_s1_m7,},
+    {op4_r7_s1_m0,op4_r7_s1_m1,op4_r7_s1_m2,op4_r7_s1_m3,
+     op4_r7_s1_m4,op4_r7_s1_m5,op4_r7_s1_m6,op4_r7_s1_m7,},
+  },
+  {
+    {op4_r0_s2_m0,op4_r0_s2_m1,op4_r0_s2_m2,op4_r0_s2_m3,
+     op4_r0_s2_m4,op4_r0_s2_m5,op4_r0_s2_m6,op4_r0_s2_m7,},
+    {op4_r1_s2_m0,op4_r1_s2_m1,op4_r1_s2_m2,op4_r1_s2_m3,
+     op4_r1_s2_m4,op4_r1_s2_m5,op4_r1_s2_m6,op4_r1_s2_m7,},
+    {op4_r2_s2_m0,op4_r2_s2_m1,op4_r2_s2_m2,op4_r2_s2_m3,
+     op4_r2_s2_m4,op4_r2_s2_m5,op4_r2_s2_m6,op4_r2_s2_m7,},
+    {op4_r3_s2_m0,op4_r3_s2_m1,op4_r3_s2_m2,op4_r3_s2_m3,
+     op4_r3_s2_m4,op4_r3_s2_m5,op4_r3_s2_m6,op4_r3_s2_m7,},
+    {op4_r4_s2_m0,op4_r4_s2_m1,op4_r4_s2_m2,op4_r4_s2_m3,
+     op4_r4_s2_m4,op4_r4_s2_m5,op4_r4_s2_m6,op4_r4_s2_m7,},
+    {op4_r5_s2_m0,op4_r5_s2_m1,op4_r5_s2_m2,op4_r5_s2_m3,
+     op4_r5_s2_m4,op4_r5_s2_m5,op4_r5_s2_m6,op4_r5_s2_m7,},
+    {op4_r6_s2_m0,op4_r6_s2_m1,op4_r6_s2_m2,op4_r6_s2_m3,
+     op4_r6_s2_m4,op4_r6_s2_m5,op4_r6_s2_m6,op4_r6_s2_m7,},
+    {op4_r7_s2_m0,op4_r7_s2_m1,op4_r7_s2_m2,op4_r7_s2_m3,
+     op4_r7_s2_m4,op4_r7_s2_m5,op4_r7_s2_m6,op4_r7_s2_m7,},
+  },
+  {
+    {op4_r0_s3_m0,op4_r0_s3_m1,op4_r0_s3_m2,op4_r0_s3_m3,
+     op4_r0_s3_m4,op4_r0_s3_m5,op4_r0_s3_m6,op4_r0_s3_m7,},
+    {op4_r1_s3_m0,op4_r1_s3_m1,op4_r1_s3_m2,op4_r1_s3_m3,
+     op4_r1_s3_m4,op4_r1_s3_m5,op4_r1_s3_m6,op4_r1_s3_m7,},
+    {op4_r2_s3_m0,op4_r2_s3_m1,op4_r2_s3_m2,op4_r2_s3_m3,
+     op4_r2_s3_m4,op4_r2_s3_m5,op4_r2_s3_m6,op4_r2_s3_m7,},
+    {op4_r3_s3_m0,op4_r3_s3_m1,op4_r3_s3_m2,op4_r3_s3_m3,
+     op4_r3_s3_m4,op4_r3_s3_m5,op4_r3_s3_m6,op4_r3_s3_m7,},
+    {op4_r4_s3_m0,op4_r4_s3_m1,op4_r4_s3_m2,op4_r4_s3_m3,
+     op4_r4_s3_m4,op4_r4_s3_m5,op4_r4_s3_m6,op4_r4_s3_m7,},
+    {op4_r5_s3_m0,op4_r5_s3_m1,op4_r5_s3_m2,op4_r5_s3_m3,
+     op4_r5_s3_m4,op4_r5_s3_m5,op4_r5_s3_m6,op4_r5_s3_m7,},
+    {op4_r6_s3_m0,op4_r6_s3_m1,op4_r6_s3_m2,op4_r6_s3_m3,
+     op4_r6_s3_m4,op4_r6_s3_m5,op4_r6_s3_m6,op4_r6_s3_m7,},
+    {op4_r7_s3_m0,op4_r7_s3_m1,op4_r7_s3_m2,op4_r7_s3_m3,
+     op4_r7_s3_m4,op4_r7_s3_m5,op4_r7_s3_m6,op4_r7_s3_m7,},
+  },
+};
+
+/* Line 4 funky mode 6 handlers (RESET ... RTR) by reg0. */
+static linefunc68_t * const funky4_m6_ops[8] = {
+  op4_funky_m6_0,op4_funky_m6_1,op4_funky_m6_2,op4_funky_m6_3,
+  op4_funky_m6_4,op4_funky_m6_5,op4_funky_m6_6,op4_funky_m6_7,
+};
+
+linefunc68_t * emu68_optable[0x10000];
+
+void emu68_optable_init(void)
+{
+  int opw;
+
+  for ( opw = 0; opw < 0x10000; ++opw ) {
+    const int line = opw >> 12, reg9 = ( opw >> 9 ) & 7;
+    const int n = ( opw >> 3 ) & 077, reg0 = opw & 7;
+    linefunc68_t * fn = line_func[ ( line << 6 ) | n ];
+
+    if ( line == 4 && ! ( n & 040 ) ) {
+      const int s = n >> 3, m = n & 7;
+      fn = ( reg9 == 7 && s == 1 && m == 6 )
+        ? funky4_m6_ops[reg0]
+        : line4_ops[s][reg9][m]
+        ;
+    }
+    emu68_optable[opw] = fn;
+  }
+}
+
+#endif
@@ -58,4 +58,5 @@
 # include "lines/lineE.c"
 # include "lines/lineF.c"
 # include "lines/table.c"
+# include "lines/optable.c"
 #endif
@@ -29,6 +29,7 @@
 
 #include "emu68_private.h"
 #include "mem68.h"
+#include "icache68.h"
 #include "error68.h"
 #include "emu68.h"
 #include "io68/io68.h"
@@ -181,24 +182,66 @@ static const io68_t fault_io = {
   0,"Fault",0,0,
   fault_rab,fault_raw,fault_ral,
   fault_wab,fault_waw,fault_wal,
-  0,0,0,0,no_destroy
+  0,0,0,0,no_destroy,
+  0,0,0,0
 };
 
 static const io68_t ram_io = {
   0,"RAM",0,0,
   memchk_rb,memchk_rw,memchk_rl,
   memchk_wb,memchk_ww,memchk_wl,
-  0,0,0,0,no_destroy
+  0,0,0,0,no_destroy,
+  0,0,0,0
 };
 
 static const io68_t nop_io = {
   0,"NOP",0,0,
   nop_rwa,nop_rwa,nop_rwa,
   nop_rwa,nop_rwa,nop_rwa,
-  0,0,0,0,no_destroy
+  0,0,0,0,no_destroy,
+  0,0,0,0
 };
 
 
+#ifdef EMU68_NODEBUG
+
+/* ,--------------------------------------------------------.
+ * |             Read/Write functions (release)             |
+ * `--------------------------------------------------------'
+ */
+
+void mem68_read_b(emu68_t * const emu68)
+{
+  inl_read_b68(emu68);
+}
+
+void mem68_read_w(emu68_t * const emu68)
+{
+  inl_read_w68(emu68);
+}
+
+void mem68_read_l(emu68_t * const emu68)
+{
+  inl_read_l68(emu68);
+}
+
+void mem68_write_b(emu68_t * const emu68)
+{
+  inl_write_b68(emu68);
+}
+
+void mem68_write_w(emu68_t * const emu68)
+{
+  inl_write_w68(emu68);
+}
+
+void mem68_write_l(emu68_t * const emu68)
+{
+  inl_write_l68(emu68);
+}
+
+#else /* EMU68_NODEBUG */
+
 /* ,--------------------------------------------------------.
  * |                   Read functions                       |
  * `--------------------------------------------------------'
@@ -257,10 +300,13 @@ void mem68_write_b(emu68_t * const emu68)
   if (mem68_is_io(addr)) {
     io68_t * const io = emu68->mapped_io[(u8)((addr)>>8)];
     io->w_byte(io);
-  } else if (!emu68->memio) {
-    emu68->mem[addr&MEMMSK68] = emu68->bus_data;
   } else {
-    emu68->memio->w_byte(emu68->memio);
+    icache68_write(emu68, addr, 1);
+    if (!emu68->memio) {
+      emu68->mem[addr&MEMMSK68] = emu68->bus_data;
+    } else {
+      emu68->memio->w_byte(emu68->memio);
+    }
   }
 }
 
@@ -270,12 +316,15 @@ void mem68_write_w(emu68_t * const emu68)
   if (mem68_is_io(addr)) {
     io68_t * const io = emu68->mapped_io[(u8)((addr)>>8)];
     io->w_word(io);
-  } else if (!emu68->memio) {
-    u8 * mem = emu68->mem + (addr&MEMMSK68);
-    int68_t v = emu68->bus_data;
-    mem[1] = v; v>>=8; mem[0] = v;
   } else {
-    emu68->memio->w_word(emu68->memio);
+    icache68_write(emu68, addr, 2);
+    if (!emu68->memio) {
+      u8 * mem = emu68->mem + (addr&MEMMSK68);
+      int68_t v = emu68->bus_data;
+      mem[1] = v; v>>=8; mem[0] = v;
+    } else {
+      emu68->memio->w_word(emu68->memio);
+    }
   }
 }
 
@@ -285,15 +334,20 @@ void mem68_write_l(emu68_t * const emu68)
   if (mem68_is_io(addr)) {
     io68_t * const io = emu68->mapped_io[(u8)((addr)>>8)];
     io->w_long(io);
-  } else if (!emu68->memio) {
-    u8 * mem = emu68->mem + (addr&MEMMSK68);
-    int68_t v = emu68->bus_data;
-    mem[3] = v; v>>=8; mem[2] = v; v>>=8; mem[1] = v; v>>=8; mem[0] = v;
   } else {
-    emu68->memio->w_long(emu68->memio);
+    icache68_write(emu68, addr, 4);
+    if (!emu68->memio) {
+      u8 * mem = emu68->mem + (addr&MEMMSK68);
+      int68_t v = emu68->bus_data;
+      mem[3] = v; v>>=8; mem[2] = v; v>>=8; mem[1] = v; v>>=8; mem[0] = v;
+    } else {
+      emu68->memio->w_long(emu68->memio);
+    }
   }
 }
 
+#endif /* EMU68_NODEBUG */
+
 
 /* Read 68000 (PC)+ word
  * - This version assume PC is in 68000 memory
@@ -13,6 +13,9 @@
 
 #include "emu68_api.h"
 #include "struct68.h"
+#ifdef EMU68_NODEBUG
+# include "icache68.h"
+#endif
 
 /**
  * @defgroup  lib_emu68_mem  68k memory and IO manager
@@ -117,6 +120,13 @@ addr68_t (*const get_eal68[8])(emu68_t * const,int reg);
 #define get_EAL(MODE,REG) get_eal68[MODE](emu68,REG)
 
 
+/**
+ * Test for direct memory access or IO quick table access
+ */
+static inline int mem68_is_io(const addr68_t addr) {
+  return addr & 0x800000;
+}
+
 /**
  * @name  68K onboard memory access.
  * @{
@@ -158,11 +168,106 @@ EMU68_EXTERN
  */
 void mem68_write_l(emu68_t * const emu68);
 
+#ifdef EMU68_NODEBUG
+
+/*
+ * Release build: there is no debug mode hence no memory IO. Onboard
+ * memory is a single buffer so a RAM access is one masked access to
+ * emu68_t::mem. Only IO pages go through emu68_t::mapped_io[].
+ */
+
+static inline void inl_read_b68(emu68_t * const emu68)
+{
+  const addr68_t addr = emu68->bus_addr;
+  if (!mem68_is_io(addr)) {
+    emu68->bus_data = emu68->mem[addr&MEMMSK68];
+  } else {
+    io68_t * const io = emu68->mapped_io[(u8)(addr>>8)];
+    io->r_byte(io);
+  }
+}
+
+static inline void inl_read_w68(emu68_t * const emu68)
+{
+  const addr68_t addr = emu68->bus_addr;
+  if (!mem68_is_io(addr)) {
+    const u8 * const mem = emu68->mem+(addr&MEMMSK68);
+    emu68->bus_data = (mem[0]<<8) + mem[1];
+  } else {
+    io68_t * const io = emu68->mapped_io[(u8)(addr>>8)];
+    io->r_word(io);
+  }
+}
+
+static inline void inl_read_l68(emu68_t * const emu68)
+{
+  const addr68_t addr = emu68->bus_addr;
+  if (!mem68_is_io(addr)) {
+    const u8 * const mem = emu68->mem+(addr&MEMMSK68);
+    emu68->bus_data = (mem[0]<<24) + (mem[1]<<16) + (mem[2]<<8) + mem[3];
+  } else {
+    io68_t * const io = emu68->mapped_io[(u8)(addr>>8)];
+    io->r_long(io);
+  }
+}
+
+static inline void inl_write_b68(emu68_t * const emu68)
+{
+  const addr68_t addr = emu68->bus_addr;
+  if (!mem68_is_io(addr)) {
+    icache68_write(emu68, addr, 1);
+    emu68->mem[addr&MEMMSK68] = emu68->bus_data;
+  } else {
+    io68_t * const io = emu68->mapped_io[(u8)(addr>>8)];
+    io->w_byte(io);
+  }
+}
+
+static inline void inl_write_w68(emu68_t * const emu68)
+{
+  const addr68_t addr = emu68->bus_addr;
+  if (!mem68_is_io(addr)) {
+    u8 * const mem = emu68->mem + (addr&MEMMSK68);
+    int68_t v = emu68->bus_data;
+    icache68_write(emu68, addr, 2);
+    mem[1] = v; v>>=8; mem[0] = v;
+  } else {
+    io68_t * const io = emu68->mapped_io[(u8)(addr>>8)];
+    io->w_word(io);
+  }
+}
+
+static inline void inl_write_l68(emu68_t * const emu68)
+{
+  const addr68_t addr = emu68->bus_addr;
+  if (!mem68_is_io(addr)) {
+    u8 * const mem = emu68->mem + (addr&MEMMSK68);
+    int68_t v = emu68->bus_data;
+    icache68_write(emu68, addr, 4);
+    mem[3] = v; v>>=8; mem[2] = v; v>>=8; mem[1] = v; v>>=8; mem[0] = v;
+  } else {
+    io68_t * const io = emu68->mapped_io[(u8)(addr>>8)];
+    io->w_long(io);
+  }
+}
+
+#else /* EMU68_NODEBUG */
+
+/* Debug capable build: memory may be routed to a memory IO. */
+# define inl_read_b68(E)  mem68_read_b(E)
+# define inl_read_w68(E)  mem68_read_w(E)
+# define inl_read_l68(E)  mem68_read_l(E)
+# define inl_write_b68(E) mem68_write_b(E)
+# define inl_write_w68(E) mem68_write_w(E)
+# define inl_write_l68(E) mem68_write_l(E)
+
+#endif /* EMU68_NODEBUG */
+
 static inline uint68_t _read_B(emu68_t * const emu68,
                                const addr68_t addr)
 {
   emu68->bus_addr = addr;
-  mem68_read_b(emu68);
+  inl_read_b68(emu68);
   return (u8) emu68->bus_data;
 }
 
@@ -170,7 +275,7 @@ static inline uint68_t _read_EAB(emu68_t * const emu68,
                                  const int mode, const int reg)
 {
   emu68->bus_addr = get_eab68[mode](emu68,reg);
-  mem68_read_b(emu68);
+  inl_read_b68(emu68);
   return (u8) emu68->bus_data;
 }
 
@@ -179,7 +284,7 @@ static inline uint68_t _read_W(emu68_t * const emu68,
                                const addr68_t addr)
 {
   emu68->bus_addr = addr;
-  mem68_read_w(emu68);
+  inl_read_w68(emu68);
   return (u16) emu68->bus_data;
 }
 
@@ -187,7 +292,7 @@ static inline uint68_t _read_EAW(emu68_t * const emu68,
                                  const int mode, const int reg)
 {
   emu68->bus_addr = get_eaw68[mode](emu68,reg);
-  mem68_read_w(emu68);
+  inl_read_w68(emu68);
   return (u16) emu68->bus_data;
 }
 
@@ -196,7 +301,7 @@ static inline uint68_t _read_L(emu68_t * const emu68,
                                const addr68_t addr)
 {
   emu68->bus_addr = addr;
-  mem68_read_l(emu68);
+  inl_read_l68(emu68);
   return (u32) emu68->bus_data;
 }
 
@@ -204,7 +309,7 @@ static inline uint68_t _read_EAL(emu68_t * const emu68,
                                  const int mode, const int reg)
 {
   emu68->bus_addr = get_eal68[mode](emu68,reg);
-  mem68_read_l(emu68);
+  inl_read_l68(emu68);
   return (u32) emu68->bus_data;
 }
 
@@ -243,7 +348,7 @@ static inline void _write_B(emu68_t * const emu68,
 {
   emu68->bus_addr = addr;
   emu68->bus_data = v;
-  mem68_write_b(emu68);
+  inl_write_b68(emu68);
 }
 
 static inline void _write_EAB(emu68_t * const emu68,
@@ -251,7 +356,7 @@ static inline void _write_EAB(emu68_t * const emu68,
 {
   emu68->bus_addr = get_eab68[mode](emu68,reg);
   emu68->bus_data = v;
-  mem68_write_b(emu68);
+  inl_write_b68(emu68);
 }
 
 
@@ -259,7 +364,7 @@ static inline void _write_W(emu68_t * const emu68, addr68_t addr, int68_t v)
 {
   emu68->bus_addr = addr;
   emu68->bus_data = v;
-  mem68_write_w(emu68);
+  inl_write_w68(emu68);
 }
 
 static inline void _write_EAW(emu68_t * const emu68,
@@ -267,7 +372,7 @@ static inline void _write_EAW(emu68_t * const emu68,
 {
   emu68->bus_addr = get_eaw68[mode](emu68,reg);
   emu68->bus_data = v;
-  mem68_write_w(emu68);
+  inl_write_w68(emu68);
 }
 
 
@@ -275,7 +380,7 @@ static inline void _write_L(emu68_t * const emu68, addr68_t addr, int68_t v)
 {
   emu68->bus_addr = addr;
   emu68->bus_data = v;
-  mem68_write_l(emu68);
+  inl_write_l68(emu68);
 }
 
 static inline void _write_EAL(emu68_t * const emu68,
@@ -283,7 +388,7 @@ static inline void _write_EAL(emu68_t * const emu68,
 {
   emu68->bus_addr = get_eal68[mode](emu68,reg);
   emu68->bus_data = v;
-  mem68_write_l(emu68);
+  inl_write_l68(emu68);
 }
 
 
@@ -332,14 +437,41 @@ EMU68_EXTERN
 int68_t mem68_nextl(emu68_t * const emu68);  /**< Decode long and update PC */
 
 /**
- * mem68_nextw() convenience macro.
+ * Decode word and update PC (from instruction cache if possible).
+ */
+static inline int68_t inl_nextw68(emu68_t * const emu68)
+{
+  const uint68_t off = (u32) ( REG68.pc - emu68->icx_pc );
+  if (off < emu68->icx_len) {
+    REG68.pc += 2;
+    return (s16) emu68->icx[off >> 1];
+  }
+  return mem68_nextw(emu68);
+}
+
+/**
+ * Decode long and update PC (from instruction cache if possible).
+ */
+static inline int68_t inl_nextl68(emu68_t * const emu68)
+{
+  const uint68_t off = (u32) ( REG68.pc - emu68->icx_pc );
+  if (off < emu68->icx_len && off + 2 < emu68->icx_len) {
+    const u16 * const ext = emu68->icx + (off >> 1);
+    REG68.pc += 4;
+    return (s32) ( ( (u32) ext[0] << 16 ) | ext[1] );
+  }
+  return mem68_nextl(emu68);
+}
+
+/**
+ * inl_nextw68() convenience macro.
  */
-#define get_nextw() mem68_nextw(emu68)
+#define get_nextw() inl_nextw68(emu68)
 
 /**
- * mem68_nextl() convenience macro.
+ * inl_nextl68() convenience macro.
  */
-#define get_nextl() mem68_nextl(emu68)
+#define get_nextl() inl_nextl68(emu68)
 
 /**
  * @}
@@ -400,13 +532,6 @@ int68_t mem68_popw(emu68_t * const emu68);
  */
 
 
-/**
- * Test for direct memory access or IO quick table access
- */
-static inline int mem68_is_io(const addr68_t addr) {
-  return addr & 0x800000;
-}
-
 /**
  * Set memory access check flags.
  */
@@ -0,0 +1,261 @@
+/*
+ * @file    emu68/memimg68.c
+ * @brief   68k emulator shared memory images
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#if defined(HAVE_MEMFD_CREATE) && !defined(_GNU_SOURCE)
+# define _GNU_SOURCE 1                  /* memfd_create() */
+#endif
+
+#include "emu68_private.h"
+#include "memimg68.h"
+#include "icache68.h"
+#include "error68.h"
+#include "assert68.h"
+
+#include <string.h>
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H) && defined(HAVE_UNISTD_H)
+# define USE_MMAP 1
+# include <stdio.h>
+# include <unistd.h>
+# include <sys/mman.h>
+#endif
+
+enum {
+  MEM_SLACK = 8      /* bytes after the memory (access overflow) */
+};
+
+/* ,-----------------------------------------------------------------.
+ * |                         Onboard memory                          |
+ * `-----------------------------------------------------------------'
+ */
+
+#ifdef USE_MMAP
+
+struct emu68_memimg_s {
+  int        ref;                       /* reference counter */
+  int        fd;                        /* backing file */
+  int        size;                      /* memory size */
+  const u8 * data;                      /* read-only view */
+};
+
+#ifdef __GNUC__
+# define ref_add(P,N) __sync_add_and_fetch((P),(N))
+#else
+# define ref_add(P,N) (*(P) += (N))
+#endif
+
+static long pagesize(void)
+{
+  static long size;
+  if (!size)
+    size = sysconf(_SC_PAGESIZE);
+  return size;
+}
+
+/* The onboard memory is mapped apart with a slack page so that
+ * images can be mapped over it without moving it. */
+int memimg68_alloc(emu68_t * const emu68)
+{
+  const long len = (emu68->memmsk + 1) + pagesize();
+  void * mem = mmap(0, len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS,
+                    -1, 0);
+  if (mem == MAP_FAILED) {
+    emu68_error_add(emu68, "memory -- mmap error (%ld bytes)", len);
+    return -1;
+  }
+  emu68->mem    = mem;
+  emu68->memmap = len;
+  return 0;
+}
+
+void memimg68_free(emu68_t * const emu68)
+{
+  if (emu68->mem)
+    munmap(emu68->mem, emu68->memmap);
+  emu68->mem    = 0;
+  emu68->memmap = 0;
+  emu68_memimg_free(emu68->memimg);
+  emu68->memimg = 0;
+}
+
+static int tmpfd(void)
+{
+  int fd;
+  FILE * f;
+# ifdef HAVE_MEMFD_CREATE
+  fd = memfd_create("emu68", MFD_CLOEXEC);
+  if (fd != -1)
+    return fd;
+# endif
+  f = tmpfile();
+  if (!f)
+    return -1;
+  fd = dup(fileno(f));
+  fclose(f);
+  return fd;
+}
+
+emu68_memimg_t * emu68_memimg_create(emu68_t * const emu68)
+{
+  emu68_memimg_t * img;
+  const int size = emu68 ? emu68->memmsk + 1 : 0;
+  int off, n;
+
+  if (!emu68 || !emu68->mem)
+    return 0;
+  if (size % pagesize()) {
+    emu68_error_add(emu68, "memimg -- memory is not page aligned");
+    return 0;
+  }
+
+  img = emu68_alloc(sizeof(*img));
+  if (!img) {
+    emu68_error_add(emu68, "memimg -- alloc error");
+    return 0;
+  }
+  img->ref  = 1;
+  img->size = size;
+  img->data = MAP_FAILED;
+  img->fd   = tmpfd();
+  if (img->fd == -1 || ftruncate(img->fd, size))
+    goto error;
+
+  /* Zero pages are left as holes. */
+  for (off = 0; off < size; off += n) {
+    const u8 * const mem = emu68->mem + off;
+    n = pagesize();
+    if (!mem[0] && !memcmp(mem, mem + 1, n - 1))
+      continue;
+    if (pwrite(img->fd, mem, n, off) != n)
+      goto error;
+  }
+  img->data = mmap(0, size, PROT_READ, MAP_SHARED, img->fd, 0);
+  if (img->data == MAP_FAILED)
+    goto error;
+  return img;
+
+error:
+  emu68_error_add(emu68, "memimg -- failed to create image file");
+  emu68_memimg_free(img);
+  return 0;
+}
+
+int emu68_memimg_cmp(emu68_t * const emu68, const emu68_memimg_t * img)
+{
+  return !emu68 || !img || img->size != emu68->memmsk + 1
+    || memcmp(emu68->mem, img->data, img->size);
+}
+
+int emu68_memimg_attach(emu68_t * const emu68, emu68_memimg_t * img)
+{
+  if (!emu68 || !img)
+    return -1;
+  if (img->size != emu68->memmsk + 1)
+    return emu68_error_add(emu68, "memimg -- memory size mismatch");
+  if (mmap(emu68->mem, img->size, PROT_READ|PROT_WRITE,
+           MAP_PRIVATE|MAP_FIXED, img->fd, 0) == MAP_FAILED)
+    return emu68_error_add(emu68, "memimg -- mmap error");
+  emu68_icache_flush(emu68);
+  memimg68_ref(img);
+  emu68_memimg_free(emu68->memimg);
+  emu68->memimg = img;
+  return 0;
+}
+
+emu68_memimg_t * memimg68_ref(emu68_memimg_t * img)
+{
+  if (img)
+    ref_add(&img->ref, 1);
+  return img;
+}
+
+const u8 * memimg68_data(const emu68_memimg_t * img)
+{
+  return img ? img->data : 0;
+}
+
+void emu68_memimg_free(emu68_memimg_t * img)
+{
+  if (img && !ref_add(&img->ref, -1)) {
+    if (img->data != MAP_FAILED)
+      munmap((void *) img->data, img->size);
+    if (img->fd != -1)
+      close(img->fd);
+    emu68_free(img);
+  }
+}
+
+#else /* USE_MMAP */
+
+int memimg68_alloc(emu68_t * const emu68)
+{
+  const int len = (emu68->memmsk + 1) + MEM_SLACK;
+  emu68->mem = emu68_alloc(len);
+  if (!emu68->mem) {
+    emu68_error_add(emu68, "memory -- alloc error (%d bytes)", len);
+    return -1;
+  }
+  return 0;
+}
+
+void memimg68_free(emu68_t * const emu68)
+{
+  emu68_free(emu68->mem);
+  emu68->mem = 0;
+}
+
+emu68_memimg_t * emu68_memimg_create(emu68_t * const emu68)
+{
+  return 0;
+}
+
+int emu68_memimg_cmp(emu68_t * const emu68, const emu68_memimg_t * img)
+{
+  return 1;
+}
+
+int emu68_memimg_attach(emu68_t * const emu68, emu68_memimg_t * img)
+{
+  return -1;
+}
+
+emu68_memimg_t * memimg68_ref(emu68_memimg_t * img)
+{
+  return img;
+}
+
+const u8 * memimg68_data(const emu68_memimg_t * img)
+{
+  return 0;
+}
+
+void emu68_memimg_free(emu68_memimg_t * img)
+{
+}
+
+#endif /* USE_MMAP */
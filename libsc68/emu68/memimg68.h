@@ -0,0 +1,123 @@
+/**
+ * @ingroup   lib_emu68
+ * @file      emu68/memimg68.h
+ * @brief     68k emulator shared memory images header.
+ * @author    Benjamin Gerard
+ * @date      2016/03/20
+ */
+
+/* Copyright (c) 1998-2016 Benjamin Gerard */
+
+#ifndef EMU68_MEMIMG68_H
+#define EMU68_MEMIMG68_H
+
+#include "emu68_api.h"
+#include "struct68.h"
+
+/**
+ * @defgroup  lib_emu68_memimg  68k shared memory images
+ * @ingroup   lib_emu68
+ * @brief     Share onboard memory between emulator instances.
+ *
+ *   A memory image is a read-only copy of the onboard memory of an
+ *   emulator instance. Once attached to an emulator its onboard
+ *   memory becomes a copy-on-write view of the image: all instances
+ *   attached to the same image share the same physical pages until
+ *   they write to them. Only the written pages become private.
+ *
+ *   The onboard memory address never changes so pointers taken by
+ *   IO (DMA) stay valid. Attaching is only available on systems that
+ *   support mmap(); emu68_memimg_create() fails otherwise.
+ *
+ *   Images are reference counted: the emulator it is attached to and
+ *   the snapshots sharing its pages keep it alive.
+ *
+ * @{
+ */
+
+EMU68_API
+/**
+ * Create a memory image from the current onboard memory.
+ *
+ * @param  emu68  emulator instance
+ *
+ * @return memory image
+ * @retval 0 on error or if copy-on-write is not supported
+ */
+emu68_memimg_t * emu68_memimg_create(emu68_t * const emu68);
+
+EMU68_API
+/**
+ * Compare the onboard memory with a memory image.
+ *
+ * @param  emu68  emulator instance
+ * @param  img    memory image
+ *
+ * @retval  0  same size and same content
+ * @retval  1  different
+ */
+int emu68_memimg_cmp(emu68_t * const emu68, const emu68_memimg_t * img);
+
+EMU68_API
+/**
+ * Attach a memory image.
+ *
+ *   The onboard memory content is replaced by the image content. The
+ *   caller can release the image after it has been attached.
+ *
+ * @param  emu68  emulator instance
+ * @param  img    memory image of the same size
+ *
+ * @return error-code
+ * @retval  0  on success
+ * @retval -1  on error (the onboard memory is unchanged)
+ */
+int emu68_memimg_attach(emu68_t * const emu68, emu68_memimg_t * img);
+
+EMU68_API
+/**
+ * Release a memory image.
+ *
+ *   The image is destroyed once it is no longer referenced.
+ *
+ * @param  img    memory image to release
+ */
+void emu68_memimg_free(emu68_memimg_t * img);
+
+EMU68_EXTERN
+/**
+ * Add a reference to a memory image.
+ *
+ * @return img
+ */
+emu68_memimg_t * memimg68_ref(emu68_memimg_t * img);
+
+EMU68_EXTERN
+/**
+ * Get memory image content.
+ *
+ * @return read-only memory image content
+ */
+const u8 * memimg68_data(const emu68_memimg_t * img);
+
+EMU68_EXTERN
+/**
+ * Allocate the onboard memory of an emulator instance.
+ *
+ * @return error-code
+ * @retval  0  on success
+ * @retval -1  on error
+ */
+int memimg68_alloc(emu68_t * const emu68);
+
+EMU68_EXTERN
+/**
+ * Release the onboard memory of an emulator instance.
+ */
+void memimg68_free(emu68_t * const emu68);
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,266 @@
+/*
+ * @file    emu68/snap68.c
+ * @brief   68k emulator snapshots
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "emu68_private.h"
+#include "snap68.h"
+#include "icache68.h"
+#include "memimg68.h"
+#include "error68.h"
+#include "assert68.h"
+
+#include <string.h>
+
+enum {
+  SNAP_LOG2PAGE = 12,                   /* 4KB memory pages */
+  SNAP_ALIGN    = 7                     /* blob alignment mask */
+};
+
+#define SNAP_ALIGNED(N) (((N)+SNAP_ALIGN)&~SNAP_ALIGN)
+
+typedef struct {
+  char name[32];                        /* IO name (sanity check) */
+  int  off;                             /* state offset in snapshot */
+  int  len;                             /* state length (-1:none) */
+} snap_io_t;
+
+struct emu68_snap_s {
+  int        size;                      /* allocated size */
+
+  reg68_t    reg;
+  int        inst_pc;
+  int        inst_sr;
+  cycle68_t  cycle;
+  int        status;
+  uint68_t   instructions;
+  addr68_t   finish_sp;
+  addr68_t   bus_addr;
+  int68_t    bus_data;
+  int        frm_chk_fl;
+
+  int        log2mem;                   /* memory size (2^log2mem) */
+  int        log2page;                  /* page size (2^log2page) */
+  int        npage;                     /* number of pages */
+  const u8 **page;                      /* page table */
+  emu68_memimg_t * img;                 /* memory image pages are from */
+
+  int        nio;                       /* number of IO */
+  snap_io_t *io;                        /* IO states */
+};
+
+static const u8 zero_page[1 << SNAP_LOG2PAGE];
+
+/* Find an existing copy of a memory page in the reference snapshot,
+ * in the attached memory image or the zero page. */
+static const u8 * page_shared(const emu68_snap_t * ref, const u8 * img,
+                              const emu68_t * emu68,
+                              const int i, const int log2page)
+{
+  const int off = i << log2page, len = 1 << log2page;
+  const u8 * const mem = emu68->mem + off;
+
+  if (ref && !memcmp(ref->page[i], mem, len))
+    return ref->page[i];
+  if (img && !memcmp(img + off, mem, len))
+    return img + off;
+  if (!memcmp(zero_page, mem, len))
+    return zero_page;
+  return 0;
+}
+
+emu68_snap_t * emu68_snap_save(emu68_t * const emu68,
+                               const emu68_snap_t * ref)
+{
+  emu68_snap_t * snap;
+  io68_t * io;
+  int i, log2page, npage, nown, iolen, size;
+  const u8 * const img = memimg68_data(emu68 ? emu68->memimg : 0);
+  u8 * ptr;
+
+  if (!emu68)
+    return 0;
+
+  log2page = SNAP_LOG2PAGE < emu68->log2mem ? SNAP_LOG2PAGE : emu68->log2mem;
+  npage    = 1 << (emu68->log2mem - log2page);
+  if (ref && (ref->log2mem != emu68->log2mem || ref->log2page != log2page))
+    ref = 0;
+
+  /* Count pages that can not be shared */
+  for (i = nown = 0; i < npage; ++i)
+    nown += !page_shared(ref, img, emu68, i, log2page);
+
+  /* Size of all IO states */
+  for (io = emu68->iohead, iolen = 0; io; io = io->next) {
+    if (io->save) {
+      const int len = io->save(io, 0, 0);
+      if (len < 0) {
+        emu68_error_add(emu68, "snapshot -- failed to save IO '%s'",
+                        io->name);
+        return 0;
+      }
+      iolen += SNAP_ALIGNED(len);
+    }
+  }
+
+  size = SNAP_ALIGNED(sizeof(*snap))
+    + SNAP_ALIGNED(npage * sizeof(*snap->page))
+    + SNAP_ALIGNED(emu68->nio * sizeof(*snap->io))
+    + iolen
+    + (nown << log2page);
+  snap = emu68_alloc(size);
+  if (!snap) {
+    emu68_error_add(emu68, "snapshot -- alloc error (%d bytes)", size);
+    return 0;
+  }
+
+  snap->size         = size;
+  snap->reg          = emu68->reg;
+  snap->inst_pc      = emu68->inst_pc;
+  snap->inst_sr      = emu68->inst_sr;
+  snap->cycle        = emu68->cycle;
+  snap->status       = emu68->status;
+  snap->instructions = emu68->instructions;
+  snap->finish_sp    = emu68->finish_sp;
+  snap->bus_addr     = emu68->bus_addr;
+  snap->bus_data     = emu68->bus_data;
+  snap->frm_chk_fl   = emu68->frm_chk_fl;
+  snap->log2mem      = emu68->log2mem;
+  snap->log2page     = log2page;
+  snap->npage        = npage;
+  snap->nio          = emu68->nio;
+  snap->img          = memimg68_ref(emu68->memimg);
+
+  ptr = (u8 *) snap + SNAP_ALIGNED(sizeof(*snap));
+  snap->page = (const u8 **) ptr;
+  ptr += SNAP_ALIGNED(npage * sizeof(*snap->page));
+  snap->io = (snap_io_t *) ptr;
+  ptr += SNAP_ALIGNED(emu68->nio * sizeof(*snap->io));
+
+  /* IO states */
+  for (io = emu68->iohead, i = 0; io; io = io->next, ++i) {
+    snap_io_t * const sio = snap->io + i;
+    assert(i < snap->nio);
+    strncpy(sio->name, io->name, sizeof(sio->name));
+    sio->off = ptr - (u8 *) snap;
+    sio->len = -1;
+    if (io->save) {
+      const int max = size - sio->off;
+      sio->len = io->save(io, ptr, max);
+      if (sio->len < 0) {
+        emu68_error_add(emu68, "snapshot -- failed to save IO '%s'",
+                        io->name);
+        emu68_snap_free(snap);
+        return 0;
+      }
+      ptr += SNAP_ALIGNED(sio->len);
+    }
+  }
+
+  /* Memory pages */
+  for (i = 0; i < npage; ++i) {
+    snap->page[i] = page_shared(ref, img, emu68, i, log2page);
+    if (!snap->page[i]) {
+      memcpy(ptr, emu68->mem + (i << log2page), 1 << log2page);
+      snap->page[i] = ptr;
+      ptr += 1 << log2page;
+    }
+  }
+  assert(ptr == (u8 *) snap + size);
+
+  return snap;
+}
+
+int emu68_snap_restore(emu68_t * const emu68, const emu68_snap_t * snap)
+{
+  io68_t * io;
+  int i;
+
+  if (!emu68 || !snap)
+    return -1;
+
+  /* Check everything before altering the emulator. */
+  if (snap->log2mem != emu68->log2mem || snap->nio != emu68->nio) {
+    emu68_error_add(emu68, "snapshot -- %s", "incompatible emulator");
+    return -1;
+  }
+  for (io = emu68->iohead, i = 0; io; io = io->next, ++i) {
+    const snap_io_t * const sio = snap->io + i;
+    if (strncmp(sio->name, io->name, sizeof(sio->name)) ||
+        (sio->len >= 0 && !io->restore)) {
+      emu68_error_add(emu68, "snapshot -- incompatible IO '%s'", io->name);
+      return -1;
+    }
+  }
+
+  emu68->reg          = snap->reg;
+  emu68->inst_pc      = snap->inst_pc;
+  emu68->inst_sr      = snap->inst_sr;
+  emu68->cycle        = snap->cycle;
+  emu68->status       = snap->status;
+  emu68->instructions = snap->instructions;
+  emu68->finish_sp    = snap->finish_sp;
+  emu68->bus_addr     = snap->bus_addr;
+  emu68->bus_data     = snap->bus_data;
+  emu68->frm_chk_fl   = snap->frm_chk_fl;
+
+  /* Map the image the pages are from then only write modified pages
+   * so that shared pages stay shared (see emu68_memimg_attach()). On
+   * failure all pages are simply written. */
+  if (snap->img && snap->img != emu68->memimg)
+    emu68_memimg_attach(emu68, snap->img);
+  for (i = 0; i < snap->npage; ++i) {
+    u8 * const mem = emu68->mem + (i << snap->log2page);
+    if (memcmp(mem, snap->page[i], 1 << snap->log2page))
+      memcpy(mem, snap->page[i], 1 << snap->log2page);
+  }
+  emu68_icache_flush(emu68);
+
+  for (io = emu68->iohead, i = 0; io; io = io->next, ++i) {
+    const snap_io_t * const sio = snap->io + i;
+    if (sio->len >= 0 &&
+        io->restore(io, (const u8 *) snap + sio->off, sio->len)) {
+      emu68_error_add(emu68, "snapshot -- failed to restore IO '%s'",
+                      io->name);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+int emu68_snap_size(const emu68_snap_t * snap)
+{
+  return snap ? snap->size : 0;
+}
+
+void emu68_snap_free(emu68_snap_t * snap)
+{
+  if (snap) {
+    emu68_memimg_free(snap->img);
+    emu68_free(snap);
+  }
+}
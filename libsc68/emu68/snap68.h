@@ -0,0 +1,91 @@
+/**
+ * @ingroup   lib_emu68
+ * @file      emu68/snap68.h
+ * @brief     68k emulator snapshot header.
+ * @author    Benjamin Gerard
+ * @date      2016/03/05
+ */
+
+/* Copyright (c) 1998-2016 Benjamin Gerard */
+
+#ifndef EMU68_SNAP68_H
+#define EMU68_SNAP68_H
+
+#include "emu68_api.h"
+#include "struct68.h"
+
+/**
+ * @defgroup  lib_emu68_snap  68k emulator snapshots
+ * @ingroup   lib_emu68
+ * @brief     Save and restore the whole emulator state.
+ *
+ *   A snapshot holds the 68k registers, the onboard memory and the
+ *   state of every plugged IO that implements the io68_t::save() and
+ *   io68_t::restore() callbacks.
+ *
+ *   The memory is stored by pages. When a reference snapshot is
+ *   given pages identical to the reference are shared instead of
+ *   being copied. The reference (and its own references) must be
+ *   kept alive as long as the snapshot is. Pages identical to the
+ *   attached @ref lib_emu68_memimg "memory image" and zero pages are
+ *   never copied either.
+ *
+ * @{
+ */
+
+/**
+ * Snapshot opaque type.
+ */
+typedef struct emu68_snap_s emu68_snap_t;
+
+EMU68_API
+/**
+ * Take a snapshot.
+ *
+ * @param  emu68  emulator instance
+ * @param  ref    reference snapshot to share pages with [0:none]
+ *
+ * @return snapshot
+ * @retval 0 on error
+ */
+emu68_snap_t * emu68_snap_save(emu68_t * const emu68,
+                               const emu68_snap_t * ref);
+
+EMU68_API
+/**
+ * Restore a snapshot.
+ *
+ *   The emulator must have the same memory size and the same IO
+ *   plugged in the same order than when the snapshot was taken.
+ *
+ * @param  emu68  emulator instance
+ * @param  snap   snapshot to restore
+ *
+ * @return error-code
+ * @retval  0  on success
+ * @retval -1  on error
+ */
+int emu68_snap_restore(emu68_t * const emu68, const emu68_snap_t * snap);
+
+EMU68_API
+/**
+ * Get snapshot memory footprint.
+ *
+ * @param  snap   snapshot
+ * @return number of bytes allocated by this snapshot
+ */
+int emu68_snap_size(const emu68_snap_t * snap);
+
+EMU68_API
+/**
+ * Destroy a snapshot.
+ *
+ * @param  snap   snapshot to destroy
+ */
+void emu68_snap_free(emu68_snap_t * snap);
+
+/**
+ * @}
+ */
+
+#endif
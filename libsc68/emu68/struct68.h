@@ -109,6 +109,12 @@ struct io68_s
   int            (*reset)(io68_t * const);
   /** Destructor. */
   void           (*destroy)(io68_t * const);
+  /** Save state (returns size; size query if buffer is null). */
+  int            (*save)(io68_t * const, void * const, const int);
+  /** Restore state saved by io68_t::save. */
+  int            (*restore)(io68_t * const, const void * const, const int);
+  /** Create an unplugged copy of this IO for another emulator. */
+  io68_t *       (*duplicate)(io68_t * const, emu68_t * const);
 
   /** Emulator this IO is attached to. */
   emu68_t * emu68;
@@ -204,6 +210,10 @@ struct emu68_s {
   uint68_t instructions;                /**< Instruction countdown. */
   addr68_t finish_sp;                   /**< Finish Stack Pointer.  */
 
+  /* Statistics (never reset by the emulator). */
+  uint68_t inst_cnt;                    /**< Executed instructions. */
+  uint68_t irq_cnt;                     /**< Taken interruptions.   */
+
   /* IO chips. */
   int      nio;                       /**< # IO plug in IO-list.    */
   io68_t * iohead;                    /**< Head of IO-list.         */
@@ -228,10 +238,19 @@ struct emu68_s {
 
   emu68_bp_t breakpoints[31];           /**< Hardware breakpoints.  */
 
+  /* Instruction cache. */
+  icache68_t * icache;      /**< Predecoded instructions (0:off).   */
+  addr68_t     icx_pc;      /**< Address of cached extension words. */
+  uint68_t     icx_len;     /**< Cached extension bytes (0:none).   */
+  const u16  * icx;         /**< Cached extension words.            */
+
   /* Onboard memory. */
   addr68_t memmsk;     /**< Onboard memory mask (2^log2mem-1).      */
   int      log2mem;    /**< Onboard memory buffer size (2^log2mem). */
-  u8       mem[32];    /**< Onboard memory buffer.
+  u8     * mem;        /**< Onboard memory buffer (never moves).    */
+  long     memmap;     /**< Mapped length of mem (0:allocated).     */
+  emu68_memimg_t * memimg; /**< Attached memory image (0:none).     */
+  u8       buf[32];    /**< Access-control memory (debug mode).
                             @note   Must be last in struct.         */
 };
 
@@ -80,6 +80,8 @@ typedef       uint68_t cycle68_t; /**< Type for cycle counters.        */
 typedef        int68_t  addr68_t; /**< Type for 68k memory addressing. */
 typedef struct  io68_s    io68_t; /**< IO chip instance type.          */
 typedef struct emu68_s   emu68_t; /**< 68k emulator instance type.     */
+typedef struct icache68_s icache68_t; /**< Instruction cache type.   */
+typedef struct emu68_memimg_s emu68_memimg_t; /**< Memory image type. */
 
 /** 68k memory access function. */
 typedef void (*memfunc68_t)(emu68_t * const);
@@ -30,6 +30,7 @@
 #include "mfp_io.h"
 #include "mfpemul.h"
 #include <assert.h>
+#include <string.h>
 
 #ifdef DEBUG
 # include <sc68/file68_msg.h>
@@ -540,6 +541,29 @@ void mfpio_destroy(io68_t * const io)
   }
 }
 
+static int mfpio_save(io68_t * const io, void * const data, const int max)
+{
+  mfp_io68_t * const mfpio = (mfp_io68_t *)io;
+  if (data) {
+    if (max < (int)sizeof(mfpio->mfp))
+      return -1;
+    memcpy(data, &mfpio->mfp, sizeof(mfpio->mfp));
+  }
+  return sizeof(mfpio->mfp);
+}
+
+static int mfpio_restore(io68_t * const io, const void * const data,
+                         const int len)
+{
+  mfp_io68_t * const mfpio = (mfp_io68_t *)io;
+  if (!data || len != (int)sizeof(mfpio->mfp))
+    return -1;
+  memcpy(&mfpio->mfp, data, sizeof(mfpio->mfp));
+  return 0;
+}
+
+static io68_t * mfpio_duplicate(io68_t * const, emu68_t * const);
+
 static io68_t mfp_io =
 {
   0,
@@ -550,7 +574,9 @@ static io68_t mfp_io =
   mfpio_interrupt,/* mfpio_nextinterrupt */0,
   mfpio_adjust_cycle,
   mfpio_reset,
-  mfpio_destroy
+  mfpio_destroy,
+  mfpio_save, mfpio_restore,
+  mfpio_duplicate
 };
 
 int mfpio_init(int * argc, char ** argv)
@@ -578,3 +604,15 @@ io68_t * mfpio_create(emu68_t * const emu68)
   }
   return &mfpio->io;
 }
+
+static io68_t * mfpio_duplicate(io68_t * const io, emu68_t * const emu68)
+{
+  mfp_io68_t * const mfpio = (mfp_io68_t *)io;
+  io68_t * dup = mfpio_create(emu68);
+
+  if (dup && mfpio_restore(dup, &mfpio->mfp, sizeof(mfpio->mfp))) {
+    mfpio_destroy(dup);
+    dup = 0;
+  }
+  return dup;
+}
@@ -106,6 +106,15 @@ static mfp_timer_t * find_next_int(const mfp_t * const mfp)
   return (mfp_timer_t *)itimer;
 }
 
+/* Cache the next interrupting timer. It must be called each time a
+ * timer cti or tcr changes.
+ */
+static void update_next_int(mfp_t * const mfp)
+{
+  const mfp_timer_t * const itimer = find_next_int(mfp);
+  mfp->next = itimer ? itimer - mfp->timers : -1;
+}
+
 /* Number of bogo-cycle before this timer interruption. */
 /* static inline bogoc68_t timer_ncti(const mfp_timer_t * const ptimer) */
 /* { */
@@ -367,6 +376,7 @@ void mfp_put_tcr(mfp_t * const mfp,
     mfp_put_tcr_bogo(mfp->timers+TIMER_C, v>>4, bogoc);
     mfp_put_tcr_bogo(mfp->timers+TIMER_D, v&07, bogoc);
   }
+  update_next_int(mfp);
 }
 
 /* ,-----------------------------------------------------------------.
@@ -376,9 +386,8 @@ void mfp_put_tcr(mfp_t * const mfp,
 
 bogoc68_t mfp_nextinterrupt(const mfp_t * const mfp)
 {
-  const mfp_timer_t * itimer = find_next_int(mfp);
   const bogoc68_t bogoc =
-    (!itimer) ? IO68_NO_INT : itimer->cti;
+    (mfp->next < 0) ? IO68_NO_INT : mfp->timers[mfp->next].cti;
   return bogoc;
 }
 
@@ -391,16 +400,17 @@ void timer_interrupt(mfp_t * const mfp, mfp_timer_t * const ptimer)
   ptimer->interrupt.cycle  = ptimer->cti;
   ptimer->cti += prediv_width[ptimer->tcr] * ptimer->tdr_res;
   ptimer->tdr_cur = ptimer->tdr_res;
+  update_next_int(mfp);
 }
 
 interrupt68_t * mfp_interrupt(mfp_t * const mfp, const bogoc68_t bogoc)
 {
   mfp_timer_t * itimer;
 
-  /* Better recheck which timer interrupts because previous interrupt
-     code may have modified timer.
+  /* The cached next timer is up to date even if previous interrupt
+     code has modified timers.
   */
-  while ((itimer = find_next_int(mfp)) && itimer->cti < bogoc) {
+  while (mfp->next >= 0 && (itimer = mfp->timers+mfp->next)->cti < bogoc) {
     /* Have a candidate */
     mfp_timer_t * const ptimer = itimer;
 
@@ -477,6 +487,7 @@ void mfp_adjust_bogoc(mfp_t * const mfp, const bogoc68_t bogoc)
       ptimer->cti -= bogoc;
     }
   }
+  update_next_int(mfp);
 }
 
 /* ,-----------------------------------------------------------------.
@@ -512,6 +523,7 @@ static int mfp_reset_bogo(mfp_t * const mfp, const bogoc68_t bogoc)
   for (i=0; i<4;i++) {
     reset_timer(mfp->timers+i, bogoc);
   }
+  mfp->next = -1;
   return 0;
 }
 
@@ -1199,6 +1199,7 @@ enum {
 typedef struct {
   u8 map[0x40];                       /**< Registers map.        */
   mfp_timer_t timers[4];              /**< Timers.               */
+  int next;                           /**< Next timer (-1:none). */
 } mfp_t;
 
 /**
@@ -33,12 +33,30 @@
 #include "emu68/assert68.h"
 
 #include <sc68/file68_msg.h>
+#include <string.h>
 extern int mw_cat;
 #define MWHD "ste-mw : "
 
+enum {
+  MWIO_MAX_EVENTS = 64          /* Max register writes in a pass. */
+};
+
+/* Register write in the middle of a pass. */
+typedef struct {
+  cycle68_t cycle;              /* CPU cycle of the write.        */
+  addr68_t  addr;               /* Register address.              */
+  int68_t   data;               /* Written value.                 */
+  int       size;               /* Access size (1, 2 or 4).       */
+} mwio_event_t;
+
 typedef struct {
   io68_t io;
   mw_t mw;
+
+  /* Register writes of the current pass (see mwio_run()). */
+  int          nevt;            /* # queued writes.               */
+  mw_t         org;             /* Emulator at the first write.   */
+  mwio_event_t evt[MWIO_MAX_EVENTS];
 } mw_io68_t;
 
 static int68_t _mw_readB(mw_io68_t * const mwio, const u8 addr)
@@ -173,11 +191,37 @@ static void _mw_writeL(mw_io68_t * const mwio, const u8 addr, int68_t v)
   }
 }
 
+/* Queue a write done after the pass start so that mwio_run() can
+ * replay it at the right PCM. Writes are applied to the registers
+ * as well so that the CPU reads them back.
+ */
+static void queue_write(mw_io68_t * const mwio, const int size)
+{
+  emu68_t * const emu68 = mwio->io.emu68;
+  mwio_event_t * e;
+
+  if (!emu68->cycle && !mwio->nevt)
+    return;                             /* at pass start */
+  if (mwio->nevt == MWIO_MAX_EVENTS) {
+    /* Too many: what is queued already happens at pass start. */
+    TRACE68(mw_cat, MWHD "too many writes in a pass -- %d\n", mwio->nevt);
+    mwio->nevt = 0;
+  }
+  if (!mwio->nevt)
+    mwio->org = mwio->mw;
+  e = mwio->evt + mwio->nevt++;
+  e->cycle = emu68->cycle;
+  e->addr  = emu68->bus_addr;
+  e->data  = emu68->bus_data;
+  e->size  = size;
+}
+
 static void mwio_writeB(io68_t * const io)
 {
   TRACE68(mw_cat, MWHD "write BYTE [%06x] <= %02x\n",
           (unsigned)io->emu68->bus_addr & 0xFFFFFF,
           (unsigned)io->emu68->bus_data & 0xFF);
+  queue_write((mw_io68_t *)io, 1);
   _mw_writeB((mw_io68_t *)io,
              io->emu68->bus_addr, io->emu68->bus_data);
 }
@@ -187,6 +231,7 @@ static void mwio_writeW(io68_t * const io)
   TRACE68(mw_cat, MWHD "write WORD [%06x] <= %04x\n",
           (unsigned)io->emu68->bus_addr & 0xFFFFFF,
           (unsigned)io->emu68->bus_data & 0xFFFF);
+  queue_write((mw_io68_t *)io, 2);
   _mw_writeW((mw_io68_t *)io,
              io->emu68->bus_addr, io->emu68->bus_data);
 }
@@ -196,6 +241,7 @@ static void mwio_writeL(io68_t * const io)
   TRACE68(mw_cat, MWHD "write LONG [%06x] <= %08x\n",
           (unsigned)io->emu68->bus_addr & 0xFFFFFF,
           (unsigned)io->emu68->bus_data & 0xFFFFFFFF);
+  queue_write((mw_io68_t *)io, 4);
   _mw_writeL((mw_io68_t *)io,
              io->emu68->bus_addr, io->emu68->bus_data);
 }
@@ -216,6 +262,7 @@ static void mwio_adjust_cycle(io68_t * const io, cycle68_t cycle)
 
 static int mwio_reset(io68_t * const io)
 {
+  ((mw_io68_t *)io)->nevt = 0;
   return mw_reset(&((mw_io68_t *)io)->mw);
 }
 
@@ -227,6 +274,35 @@ static void mwio_destroy(io68_t * const io)
   }
 }
 
+static int mwio_save(io68_t * const io, void * const data, const int max)
+{
+  mw_io68_t * const mwio = (mw_io68_t *)io;
+  if (data) {
+    if (max < (int)sizeof(mwio->mw))
+      return -1;
+    memcpy(data, &mwio->mw, sizeof(mwio->mw));
+  }
+  return sizeof(mwio->mw);
+}
+
+static int mwio_restore(io68_t * const io, const void * const data,
+                        const int len)
+{
+  mw_io68_t * const mwio = (mw_io68_t *)io;
+  const u8 * const mem = mwio->mw.mem;
+  const int log2mem = mwio->mw.log2mem;
+
+  if (!data || len != (int)sizeof(mwio->mw))
+    return -1;
+  memcpy(&mwio->mw, data, sizeof(mwio->mw));
+  /* Keep our own 68K memory. */
+  mwio->mw.mem     = mem;
+  mwio->mw.log2mem = log2mem;
+  return 0;
+}
+
+static io68_t * mwio_duplicate(io68_t * const, emu68_t * const);
+
 static io68_t mw_io = {
   0,
   "STE-Sound",
@@ -237,6 +313,8 @@ static io68_t mw_io = {
   mwio_adjust_cycle,
   mwio_reset,
   mwio_destroy,
+  mwio_save, mwio_restore,
+  mwio_duplicate
 };
 
 int mwio_init(int * argc, char ** argv)
@@ -266,12 +344,29 @@ io68_t * mwio_create(emu68_t * const emu68, mw_parms_t * const parms)
       setup.mem     = emu68->mem;
       setup.log2mem = emu68->log2mem;
       mwio->io      = mw_io;
+      mwio->nevt    = 0;
       mw_setup(&mwio->mw, &setup);
     }
   }
   return &mwio->io;
 }
 
+static io68_t * mwio_duplicate(io68_t * const io, emu68_t * const emu68)
+{
+  mw_io68_t * const mwio = (mw_io68_t *)io;
+  mw_parms_t parms;
+  io68_t * dup;
+
+  parms.engine = mwio->mw.engine;
+  parms.hz     = mwio->mw.hz;
+  dup = mwio_create(emu68, &parms);
+  if (dup && mwio_restore(dup, &mwio->mw, sizeof(mwio->mw))) {
+    mwio_destroy(dup);
+    dup = 0;
+  }
+  return dup;
+}
+
 mw_t * mwio_emulator(io68_t * const io)
 {
   return io
@@ -284,3 +379,45 @@ int mwio_sampling_rate(io68_t * const io, int sampling_rate)
 {
   return mw_sampling_rate(mwio_emulator(io), sampling_rate);
 }
+
+void mwio_run(io68_t * const io, s32 * b, int n, const cycle68_t cycles)
+{
+  mw_io68_t * const mwio = (mw_io68_t *)io;
+  mw_t * const mw = &mwio->mw;
+
+  if (!io)
+    return;
+
+  if (mwio->nevt && n > 0 && cycles) {
+    const mwio_event_t * e = mwio->evt, * const end = e + mwio->nevt;
+    int pos = 0;
+
+    /* Back to the state of the first write and replay the writes
+     * between the mixing of each part. */
+    memcpy(mw->map, mwio->org.map, sizeof(mw->map));
+    mw->ct      = mwio->org.ct;
+    mw->end     = mwio->org.end;
+    mw->lmc     = mwio->org.lmc;
+    mw->db_conv = mwio->org.db_conv;
+
+    for ( ; e < end; ++e) {
+      int at = (u64) e->cycle * n / cycles;
+      if (at > n)
+        at = n;
+      if (at > pos) {
+        mw_mix(mw, b ? b + pos : 0, at - pos);
+        pos = at;
+      }
+      switch (e->size) {
+      case 1: _mw_writeB(mwio, e->addr, e->data); break;
+      case 2: _mw_writeW(mwio, e->addr, e->data); break;
+      default: _mw_writeL(mwio, e->addr, e->data); break;
+      }
+    }
+    if (b)
+      b += pos;
+    n -= pos;
+  }
+  mwio->nevt = 0;
+  mw_mix(mw, b, n);
+}
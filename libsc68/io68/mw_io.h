@@ -80,6 +80,22 @@ IO68_EXTERN
  */
 mw_t * mwio_emulator(io68_t * const io);
 
+IO68_EXTERN
+/**
+ * Mix a pass.
+ *
+ *   Register writes done during the pass are replayed at their PCM
+ *   position so that mid-pass changes are heard at the right sample.
+ *
+ * @param  io      MW IO instance
+ * @param  b       PCM buffer with the YM output (0: advance only)
+ * @param  n       number of PCM in the pass
+ * @param  cycles  number of CPU cycles in the pass
+ *
+ * @see mw_mix()
+ */
+void mwio_run(io68_t * const io, s32 * b, int n, const cycle68_t cycles);
+
 /**
  * @}
  */
@@ -42,6 +42,7 @@
 
 #include "emu68/assert68.h"
 #include <sc68/file68_msg.h>
+#include <sc68/file68_opt.h>
 
 #ifndef DEBUG_MW_O
 # define DEBUG_MW_O 0
@@ -109,6 +110,23 @@ static void init_volume(void) { }
 
 static mw_parms_t default_parms;
 
+static int onchange_interp(const option68_t * opt, value68_t * val)
+{
+  mw_engine(0, MW_ENGINE_SIMPLE + val->num);
+  return 0;
+}
+
+static const char * f_interp[] = { "none","linear","cubic" };
+
+/* Command line options */
+#define prefix 0
+static const char engcat[] = "ste";
+static option68_t opts[] = {
+  OPT68_ENUM(prefix,"ste-interp",engcat,"STE DMA sound interpolation",
+             f_interp,sizeof(f_interp)/sizeof(*f_interp),1,onchange_interp),
+};
+#undef prefix
+
 /* ,-----------------------------------------------------------------.
  * |                   Set/Get emulator engine                       |
  * `-----------------------------------------------------------------'
@@ -120,6 +138,7 @@ const char * mw_engine_name(const int engine)
   switch (engine) {
   case MW_ENGINE_SIMPLE: return "SIMPLE";
   case MW_ENGINE_LINEAR: return "LINEAR";
+  case MW_ENGINE_CUBIC:  return "CUBIC";
   }
   return 0;
 }
@@ -140,6 +159,7 @@ int mw_engine(mw_t * const mw, int engine)
 
   case MW_ENGINE_SIMPLE:
   case MW_ENGINE_LINEAR:
+  case MW_ENGINE_CUBIC:
     *(mw ? &mw->engine : &default_parms.engine) = engine;
     msg68(mw_cat, MWHD "%s engine -- *%s*\n",
           mw ? "select" : "default",
@@ -427,12 +447,22 @@ int mw_init(int * argc, char ** argv)
     mw_cat = msg68_cat("ste","STE sound (DMA/Microwire/LMC1992)", DEBUG_MW_O);
 
   /* Setup defaults */
-  default_parms.engine = MW_ENGINE_LINEAR;
+  default_parms.engine = MW_ENGINE_SIMPLE;
   default_parms.hz     = SPR_DEF;
 
   /* Init volume table */
   init_volume();
 
+  /* Register STE options */
+  option68_append(opts,sizeof(opts)/sizeof(*opts));
+
+  /* Default option values */
+  option68_iset(opts+0, default_parms.engine-MW_ENGINE_SIMPLE,
+                opt68_NOTSET,opt68_CFG);
+
+  /* Parse options */
+  *argc = option68_parse(*argc,argv);
+
   return 0;
 }
 
@@ -509,17 +539,176 @@ out:
 #define _VOL(LR) \
   (mw->db_conv[mw->lmc.master+mw->lmc.LR] >> 1)
 
+/* Fractional bits of the interpolation factor. */
+#define MW_INTERP_FIX 12
+
+/* Mixing parameters shared by the span kernels. */
+typedef struct {
+  const s8 * spl;                 /* 68K memory.                      */
+  int68_t    vl, vr;              /* Left and right volumes.          */
+  int68_t    ym_mult;             /* YM multiplier (0 in Db_alone).   */
+  int        ct_fix;              /* Counter fixed point.             */
+  int        fr_shr;              /* Counter to interpolation factor: */
+  int        fr_shl;              /* right then left shift.           */
+  int        first;               /* First frame offset of the block. */
+  int        last;                /* Last frame offset of the block.  */
+  int        wrap;                /* Frame offset following last.     */
+} mw_span_t;
+
+/* Mix one output sample. */
+static inline
+s32 mix_one(const mw_span_t * const s, const s32 in,
+            const int68_t l, const int68_t r)
+{
+  const int68_t ym = in * s->ym_mult;
+  return
+    (u16)((l*s->vl + ym) >> MW_MIX_FIX)
+    +
+    (((r*s->vr + ym) >> MW_MIX_FIX) << 16);
+}
+
+/* Frame offset following i in the current block. */
+static inline
+int next_frame(const mw_span_t * const s, const int i, const int chn)
+{
+  return i < s->last ? i + chn : s->wrap;
+}
+
+/* Catmull-Rom interpolation of p1..p2 at f (MW_INTERP_FIX). */
+static inline
+int68_t cubic(const int p0, const int p1, const int p2, const int p3,
+              const int f)
+{
+  const int a = -p0 + 3*p1 - 3*p2 + p3;
+  const int b = 2*p0 - 5*p1 + 4*p2 - p3;
+  const int c = p2 - p0;
+  int v;
+
+  v = ( ( ( ( ( a*f >> MW_INTERP_FIX ) + b ) * f >> MW_INTERP_FIX ) + c )
+        * f >> MW_INTERP_FIX );
+  v = p1 + ( v >> 1 );
+  return v < -128 ? -128 : v > 127 ? 127 : v;
+}
+
+/* Mix n samples of a wrap-free span (nearest sample). Each step
+ * only depends on ct, but it reads a byte at a computed offset and
+ * GCC does not vectorize it. There is no mixer68 kernel either: the
+ * STE mixer is a few percent of the render time at most.
+ */
+static inline
+void span_simple(const mw_span_t * const s, s32 * const b, const int n,
+                 mwct_t ct, const mwct_t stp, const int chn)
+{
+  const s8 * const spl = s->spl;
+  int j;
+
+  for (j = 0; j < n; ++j, ct += stp) {
+    const int i = (int)( ct >> s->ct_fix ) & -chn;
+    b[j] = mix_one(s, b[j], spl[i], spl[i+chn-1]);
+  }
+}
+
+/* Mix n samples of a wrap-free span (linear interpolation). */
+static inline
+void span_linear(const mw_span_t * const s, s32 * const b, const int n,
+                 mwct_t ct, const mwct_t stp, const int chn)
+{
+  const s8 * const spl = s->spl;
+  const int fmsk = ( 1 << MW_INTERP_FIX ) - 1;
+  int j;
+
+  for (j = 0; j < n; ++j, ct += stp) {
+    const int i = (int)( ct >> s->ct_fix ) & -chn;
+    const int k = next_frame(s, i, chn);
+    const int f = (int)( ct >> s->fr_shr << s->fr_shl ) & fmsk;
+    const int l = spl[i], r = spl[i+chn-1];
+    b[j] = mix_one(s, b[j],
+                   l + ( ( ( spl[k] - l ) * f ) >> MW_INTERP_FIX ),
+                   r + ( ( ( spl[k+chn-1] - r ) * f ) >> MW_INTERP_FIX ));
+  }
+}
+
+/* Mix n samples of a wrap-free span (cubic interpolation). */
+static inline
+void span_cubic(const mw_span_t * const s, s32 * const b, const int n,
+                mwct_t ct, const mwct_t stp, const int chn)
+{
+  const s8 * const spl = s->spl;
+  const int fmsk = ( 1 << MW_INTERP_FIX ) - 1;
+  int j;
+
+  for (j = 0; j < n; ++j, ct += stp) {
+    const int i = (int)( ct >> s->ct_fix ) & -chn;
+    const int h = i > s->first ? i - chn : i;
+    const int k = next_frame(s, i, chn);
+    const int m = next_frame(s, k, chn);
+    const int f = (int)( ct >> s->fr_shr << s->fr_shl ) & fmsk;
+    b[j] = mix_one(s, b[j],
+                   cubic(spl[h], spl[i], spl[k], spl[m], f),
+                   cubic(spl[h+chn-1], spl[i+chn-1],
+                         spl[k+chn-1], spl[m+chn-1], f));
+  }
+}
+
+/* Dispatch a span to the engine kernel, specialized for mono (1)
+ * and stereo (2) frames.
+ */
+static void mix_span(const mw_span_t * const s, s32 * const b, const int n,
+                     const mwct_t ct, const mwct_t stp,
+                     const int engine, const int mono)
+{
+  switch (engine) {
+  case MW_ENGINE_LINEAR:
+    if (mono) span_linear(s, b, n, ct, stp, 1);
+    else      span_linear(s, b, n, ct, stp, 2);
+    break;
+  case MW_ENGINE_CUBIC:
+    if (mono) span_cubic(s, b, n, ct, stp, 1);
+    else      span_cubic(s, b, n, ct, stp, 2);
+    break;
+  default:
+    if (mono) span_simple(s, b, n, ct, stp, 1);
+    else      span_simple(s, b, n, ct, stp, 2);
+    break;
+  }
+}
+
+/* Frame offsets of the block [ct..end[ for the interpolating kernels. */
+static void span_block(mw_span_t * const s, const mwct_t ct,
+                       const mwct_t end, const mwct_t base,
+                       const int loop, const int chn)
+{
+  s->first = (int)( ct  >> s->ct_fix ) & -chn;
+  s->last  = (int)( ( end - 1 ) >> s->ct_fix ) & -chn;
+  if (s->last < s->first)
+    s->last = s->first;
+  s->wrap  = loop ? (int)( base >> s->ct_fix ) & -chn : s->last;
+}
+
 static void mix_ste(mw_t * const mw, s32 *b, int n)
 {
   mwct_t base, end2, ct, end, stp;
-  const int          vl = _VOL(left);
-  const int          vr = _VOL(right);
+  mw_span_t s;
   const int        loop = mw->map[MW_ACTI] & 2;
   const int        mono = (mw->map[MW_MODE]>>7) & 1;
+  const int         chn = 2 - mono;
   const uint_t      frq = 50066u >> ((mw->map[MW_MODE]&3)^3);
-  const int68_t ym_mult = (mw->db_conv == Db_alone) ? 0 : MW_YM_MULT;
   const int      ct_fix = mw->ct_fix;
-  const s8 *        spl = (const s8 *)mw->mem;
+  const int      engine = mw->engine;
+
+  s.spl      = (const s8 *)mw->mem;
+  s.vl       = _VOL(left);
+  s.vr       = _VOL(right);
+  s.ym_mult  = (mw->db_conv == Db_alone) ? 0 : MW_YM_MULT;
+  s.ct_fix   = ct_fix;
+  /* A frame has ct_fix+1-mono fractional bits which are fewer than
+   * MW_INTERP_FIX with a large 68K memory. */
+  s.fr_shr   = ct_fix + 1 - mono - MW_INTERP_FIX;
+  s.fr_shl   = 0;
+  if (s.fr_shr < 0) {
+    s.fr_shl = -s.fr_shr;
+    s.fr_shr = 0;
+  }
 
   /* Get internal register for sample base and sample end
    * $$$ ??? what if base > end2 ???
@@ -549,70 +738,33 @@ static void mix_ste(mw_t * const mw, s32 *b, int n)
    */
   stp = ( (mwct_t) frq << ( ct_fix + 1 - mono ) ) / mw->hz;
 
-  if (mono) {
-    /* mix mono */
-    do {
-      int68_t v, ym;
-
-      ym = (*b) * ym_mult;
-      v = spl[ (int)( ct >> ct_fix ) ];
-      *b++ =
-        (
-          (u16)((v*vl + ym) >> MW_MIX_FIX)
-          +
-          (((v*vr + ym)>>MW_MIX_FIX)<<16)
-          );
-
-      ct += stp;
-      if (ct >= end) {
-        if (!loop) {
-          --n;
-          break;
-        } else {
-          mwct_t overflow = ct-end;
-          mwct_t length   = end-base;
-          ct  = base;
-          if (length) {
-            ct += overflow>length ? overflow%length : overflow;
-          }
-          end = end2;
-        }
-      }
-    } while (--n);
-
-  } else {
-    /* mix stereo */
-    do {
-      int68_t l,r,ym;
-      int addr;
-
-      ym = (*b) * ym_mult;
-      addr = ( ct >> ct_fix ) & ~1;
-      l = spl[addr+0];
-      r = spl[addr+1];
-      *b++ =
-        (
-          (u16)((l*vl + ym)>>MW_MIX_FIX)
-          +
-          (((r*vr + ym)>>MW_MIX_FIX)<<16)
-          );
-
-      ct += stp;
-      if (ct >= end) {
-        if (!loop) {
-          --n;
-          break;
-        } else {
-          mwct_t overflow = ct-end;
-          mwct_t length   = end-base;
-          ct  = base;
-          if (length) {
-            ct += overflow>length ? overflow%length : overflow;
-          }
-          end = end2;
+  /* Split the buffer into spans that do not reach the block end so
+   * that the kernels have no wrap test. The block end is handled
+   * once per span.
+   */
+  span_block(&s, ct, end, base, loop, chn);
+  while (n > 0) {
+    const mwct_t cnt = ct < end ? ( end - ct - 1 ) / stp + 1 : 1;
+    const int m = cnt < (mwct_t) n ? (int) cnt : n;
+
+    mix_span(&s, b, m, ct, stp, engine, mono);
+    b  += m;
+    n  -= m;
+    ct += stp * m;
+    if (ct >= end) {
+      if (!loop) {
+        break;
+      } else {
+        mwct_t overflow = ct-end;
+        mwct_t length   = end-base;
+        ct  = base;
+        if (length) {
+          ct += overflow>length ? overflow%length : overflow;
         }
+        end = end2;
+        span_block(&s, ct, end, base, loop, chn);
       }
-    } while (--n);
+    }
   }
 
   out:
@@ -116,7 +116,8 @@ enum mw_engine_e {
   MW_ENGINE_QUERY   = -1, /**< Query default or current engine.         */
   MW_ENGINE_DEFAULT = 0,  /**< Use default engine.                      */
   MW_ENGINE_SIMPLE,       /**< Simple engine without interpolation.     */
-  MW_ENGINE_LINEAR        /**< Simple engine with linear interpolation. */
+  MW_ENGINE_LINEAR,       /**< Simple engine with linear interpolation. */
+  MW_ENGINE_CUBIC         /**< Simple engine with cubic interpolation.  */
 };
 
 /**
@@ -307,9 +308,12 @@ IO68_EXTERN
  *   pointer locates the 68K memory buffer where samples are stored to
  *   allow DMA fetch emulation.
  *
+ *   If out is 0 nothing is mixed but the DMA counters are advanced
+ *   as if n samples were.
+ *
  * @param  mw     microwire instance
  * @param  out    pointer to YM-2149 source sample directly used for
- *                microwire output mixing.
+ *                microwire output mixing [0:skip].
  * @param  n      number of sample to mix in out buffer
  *
  * @see YM_mix()  @see YM_get_buffer()
@@ -29,9 +29,28 @@
 
 #include "paula_io.h"
 
+#include <string.h>
+
+enum {
+  PAULAIO_MAX_EVENTS = 128      /* Max register writes in a pass. */
+};
+
+/* Register write in the middle of a pass. */
+typedef struct {
+  cycle68_t cycle;              /* CPU cycle of the write.        */
+  addr68_t  addr;               /* Register address.              */
+  int68_t   data;               /* Written value.                 */
+  int       size;               /* Access size (1, 2 or 4).       */
+} paulaio_event_t;
+
 typedef struct {
   io68_t io;
   paula_t paula;
+
+  /* Register writes of the current pass (see paulaio_run()). */
+  int             nevt;         /* # queued writes.               */
+  paula_t         org;          /* Emulator at the first write.   */
+  paulaio_event_t evt[PAULAIO_MAX_EVENTS];
 } paula_io68_t;
 
 static void reload(paulav_t * const v, const u8 * const p, const int fix);
@@ -313,20 +332,46 @@ static void _paula_writeW(paula_io68_t * const paulaio,
   }
 }
 
+/* Queue a write done after the pass start so that paulaio_run() can
+ * replay it at the right PCM. Writes are applied to the registers
+ * as well so that the CPU reads them back.
+ */
+static void queue_write(paula_io68_t * const paulaio, const int size)
+{
+  emu68_t * const emu68 = paulaio->io.emu68;
+  paulaio_event_t * e;
+
+  if (!emu68->cycle && !paulaio->nevt)
+    return;                             /* at pass start */
+  if (paulaio->nevt == PAULAIO_MAX_EVENTS)
+    /* Too many: what is queued already happens at pass start. */
+    paulaio->nevt = 0;
+  if (!paulaio->nevt)
+    paulaio->org = paulaio->paula;
+  e = paulaio->evt + paulaio->nevt++;
+  e->cycle = emu68->cycle;
+  e->addr  = emu68->bus_addr;
+  e->data  = emu68->bus_data;
+  e->size  = size;
+}
+
 static void paulaio_writeB(io68_t * const io)
 {
+  queue_write((paula_io68_t *)io, 1);
   _paula_writeB((paula_io68_t *)io,
                 io->emu68->bus_addr, io->emu68->bus_data);
 }
 
 static void paulaio_writeW(io68_t * const io)
 {
+  queue_write((paula_io68_t *)io, 2);
   _paula_writeW((paula_io68_t *)io,
                 io->emu68->bus_addr, io->emu68->bus_data);
 }
 
 static void paulaio_writeL(io68_t * const io)
 {
+  queue_write((paula_io68_t *)io, 4);
   _paula_writeW((paula_io68_t *)io,
                 io->emu68->bus_addr+0, io->emu68->bus_data>>16);
   _paula_writeW((paula_io68_t *)io,
@@ -349,6 +394,7 @@ static void paulaio_adjust_cycle(io68_t * const io, cycle68_t cycle)
 
 static int paulaio_reset(io68_t * const io)
 {
+  ((paula_io68_t *)io)->nevt = 0;
   return paula_reset(&((paula_io68_t *)io)->paula);
 }
 
@@ -360,6 +406,37 @@ static void paulaio_destroy(io68_t * const io)
   }
 }
 
+static int paulaio_save(io68_t * const io, void * const data, const int max)
+{
+  paula_io68_t * const paulaio = (paula_io68_t *)io;
+  if (data) {
+    if (max < (int)sizeof(paulaio->paula))
+      return -1;
+    memcpy(data, &paulaio->paula, sizeof(paulaio->paula));
+  }
+  return sizeof(paulaio->paula);
+}
+
+static int paulaio_restore(io68_t * const io, const void * const data,
+                           const int len)
+{
+  paula_io68_t * const paulaio = (paula_io68_t *)io;
+  const u8 * const mem = paulaio->paula.mem;
+  const int log2mem = paulaio->paula.log2mem;
+  int * const chansptr = paulaio->paula.chansptr;
+
+  if (!data || len != (int)sizeof(paulaio->paula))
+    return -1;
+  memcpy(&paulaio->paula, data, sizeof(paulaio->paula));
+  /* Keep our own 68K memory and channel mask. */
+  paulaio->paula.mem      = mem;
+  paulaio->paula.log2mem  = log2mem;
+  paulaio->paula.chansptr = chansptr;
+  return 0;
+}
+
+static io68_t * paulaio_duplicate(io68_t * const, emu68_t * const);
+
 static io68_t paula_io = {
   0,
   "AMIGA Paula",
@@ -369,7 +446,9 @@ static io68_t paula_io = {
   paulaio_interrupt, paulaio_next_interrupt,
   paulaio_adjust_cycle,
   paulaio_reset,
-  paulaio_destroy
+  paulaio_destroy,
+  paulaio_save, paulaio_restore,
+  paulaio_duplicate
 };
 
 
@@ -391,12 +470,30 @@ io68_t * paulaio_create(emu68_t * const emu68, paula_parms_t * const parms)
       setup.mem     = emu68->mem;
       setup.log2mem = emu68->log2mem;
       paulaio->io = paula_io;
+      paulaio->nevt = 0;
       paula_setup(&paulaio->paula, &setup);
     }
   }
   return &paulaio->io;
 }
 
+static io68_t * paulaio_duplicate(io68_t * const io, emu68_t * const emu68)
+{
+  paula_io68_t * const paulaio = (paula_io68_t *)io;
+  paula_parms_t parms;
+  io68_t * dup;
+
+  parms.engine = paulaio->paula.engine;
+  parms.clock  = paulaio->paula.clock;
+  parms.hz     = paulaio->paula.hz;
+  dup = paulaio_create(emu68, &parms);
+  if (dup && paulaio_restore(dup, &paulaio->paula, sizeof(paulaio->paula))) {
+    paulaio_destroy(dup);
+    dup = 0;
+  }
+  return dup;
+}
+
 int paulaio_init(int * argc, char ** argv)
 {
   return paula_init(argc, argv);
@@ -419,3 +516,50 @@ int paulaio_sampling_rate(io68_t * const io, int hz)
 {
   return paula_sampling_rate(paulaio_emulator(io),hz);
 }
+
+void paulaio_run(io68_t * const io, s32 * b, int n, const cycle68_t cycles)
+{
+  paula_io68_t * const paulaio = (paula_io68_t *)io;
+  paula_t * const paula = &paulaio->paula;
+
+  if (!io)
+    return;
+
+  if (paulaio->nevt && n > 0 && cycles) {
+    const paulaio_event_t * e = paulaio->evt;
+    const paulaio_event_t * const end = e + paulaio->nevt;
+    int pos = 0;
+
+    /* Back to the state of the first write and replay the writes
+     * between the mixing of each part. */
+    memcpy(paula->map, paulaio->org.map, sizeof(paula->map));
+    memcpy(paula->voice, paulaio->org.voice, sizeof(paula->voice));
+    paula->dmacon = paulaio->org.dmacon;
+    paula->intena = paulaio->org.intena;
+    paula->intreq = paulaio->org.intreq;
+    paula->adkcon = paulaio->org.adkcon;
+
+    for ( ; e < end; ++e) {
+      int at = (u64) e->cycle * n / cycles;
+      if (at > n)
+        at = n;
+      if (at > pos) {
+        paula_mix(paula, b ? b + pos : 0, at - pos);
+        pos = at;
+      }
+      if (e->size == 1)
+        _paula_writeB(paulaio, e->addr, e->data);
+      else if (e->size == 2)
+        _paula_writeW(paulaio, e->addr, e->data);
+      else {
+        _paula_writeW(paulaio, e->addr+0, e->data>>16);
+        _paula_writeW(paulaio, e->addr+2, e->data);
+      }
+    }
+    if (b)
+      b += pos;
+    n -= pos;
+  }
+  paulaio->nevt = 0;
+  paula_mix(paula, b, n);
+}
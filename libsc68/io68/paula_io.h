@@ -64,6 +64,22 @@ IO68_EXTERN
  */
 paula_t * paulaio_emulator(io68_t * const io);
 
+IO68_EXTERN
+/**
+ * Mix a pass.
+ *
+ *   Register writes done during the pass are replayed at their PCM
+ *   position so that mid-pass changes are heard at the right sample.
+ *
+ * @param  io      Paula IO instance
+ * @param  b       PCM buffer (0: advance only)
+ * @param  n       number of PCM in the pass
+ * @param  cycles  number of CPU cycles in the pass
+ *
+ * @see paula_mix()
+ */
+void paulaio_run(io68_t * const io, s32 * b, int n, const cycle68_t cycles);
+
 /**
  * @}
  */
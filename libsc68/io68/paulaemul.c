@@ -359,107 +359,74 @@ static void poll_irq(paula_t * const paula, unsigned int N)
 }
 #endif
 
-/* Mix with laudio channel data (1 char instead of 2) */
-
-static void mix_one(paula_t * const paula,
-                    int N, const int shift,
-                    s32 * b, int n)
+/* Advance voice counters as mix_voice() does without mixing. */
+static void skip_one(paula_t * const paula, int N, int n)
 {
   const u8 * const mem = paula->mem;
   paulav_t * const w   = paula->voice+N;
   u8       * const p   = paula->map+PAULA_VOICE(N);
-  s16      *       b2  = (s16 *)b + shift;
   const int     ct_fix = paula->ct_fix;
-  plct_t adr, stp, readr, reend, end, vol, per;
+  plct_t adr, stp, readr, reend, end, per;
   u8 last, hasloop;
-
-  /* Mask to get the fractionnal part of the sample counter. Therefore
-   * forcing it to 0 will disable linear interpolation by forcing
-   * exact sample point.
-   */
-  const plct_t imask = paula->engine == PAULA_ENGINE_LINEAR
-    ? ( ( (plct_t) 1 << ct_fix ) - 1 )
-    : 0
-    ;
-  const signed_plct_t one = (signed_plct_t) 1 << ct_fix;
+  u64 m;
 
   hasloop = 0;
 
-  /* $$$ FIXME
-   * Dunno exactly what if volume is not in proper range [0..64]
-   */
-  vol = p[9] & 127;
-  if (vol >= 64)
-    vol = 64;
-  vol <<= 1;
-
-
   per = ( p[6] << 8 ) + p[7];
-  if (!per) per = 1;                    /* or is it +1 for all ?? */
+  if (!per) per = 1;
   stp = paula->clkperspl / per;
 
-  /* Audio irq disable for this voice :
-   * Internal will be reload at end of block
-   */
   readr   = ( p[1] << 16 ) | ( p[2] << 8 ) | ( p[3] & 0xFE );
   readr <<= ct_fix;
   reend   = ((p[4] << 8) | p[5]);
-  reend  |= (!reend) << 16;           /* 0 is 0x10000 */
-  reend <<= (1 + ct_fix);             /* +1 as unit is 16-bit word */
+  reend  |= (!reend) << 16;
+  reend <<= (1 + ct_fix);
   reend  += readr;
-  assert( reend > readr );
-  if (reend <= readr) {
-    /* $$$ ??? dunno why I did this !!! May be could happen on a
-     * modulo. */
+  if (reend <= readr)
     return;
-  }
 
   adr = w->adr;
   end = w->end;
   if (end <= adr)
     return;
 
-  /* mix stereo */
-  do {
-    int idx;
-    signed_plct_t low, v0, v1;
-
-    low = adr & imask;
-    idx = adr >> ct_fix;                /* current index         */
-    last = mem[idx++];                  /* save last sample read */
-
-    if ( ( (plct_t) idx << ct_fix ) >= end )
-      idx = readr >> ct_fix;            /* loop index     */
-    v1 = (s8) mem[idx];                 /* next sample    */
-    v0 = (s8) last;                     /* current sample */
-
-    /* linear interpolation (or not if imask is zero) */
-    v0 = ( v1 * low + v0 * ( one - low ) ) >> ct_fix;
-
-    /* apply volume */
-    v0  *= vol;
-
-    assert(v0 >= -16384);
-    assert(v0 <   16384);
-
-    /* Store and advance output buffer */
-    *b2 += v0;
-    b2  += 2;
-
-    /* Advance */
-    adr += stp;
-    if (adr >= end) {
-      plct_t relen = reend - readr;
+  /* Advance all but the last step at once. */
+  if (m = n - 1, m && stp) {
+    const u64 toend = ( (u64) (end - adr) + stp - 1 ) / stp;
+    if (m < toend) {
+      adr += m * stp;
+    } else {
+      const plct_t relen = reend - readr;
+      adr += toend * stp;
       hasloop = 1;
       adr = readr + adr - end;
       end = reend;
       while (adr >= end) {
         adr -= relen;
       }
+      for (m -= toend; m; ) {
+        /* Split to avoid 64-bit overflow with tiny periods. */
+        const u64 max = ( ~(u64) 0 - relen ) / stp;
+        const u64 cnt = m < max ? m : max;
+        adr = readr + ( (u64) (adr - readr) + cnt * stp ) % relen;
+        m -= cnt;
+      }
+    }
+  }
+
+  /* Last step gets the last sample read */
+  last = mem[adr >> ct_fix];
+  adr += stp;
+  if (adr >= end) {
+    plct_t relen = reend - readr;
+    hasloop = 1;
+    adr = readr + adr - end;
+    end = reend;
+    while (adr >= end) {
+      adr -= relen;
     }
-  } while (--n);
+  }
 
-  last &= 0xFF;
   p[0xA] = last + (last << 8);
   w->adr = adr;
   if (hasloop) {
@@ -484,6 +451,213 @@ static void clear_buffer(s32 * b, int n)
 }
 
 
+/* Voice state used by the fused mixer. */
+typedef struct {
+  plct_t adr, stp, readr, reend, end;
+  signed_plct_t vol;
+  int out;                        /* s16 half of the output frame. */
+  int N;                          /* voice number.                 */
+  u8 last, hasloop;
+} plmix_t;
+
+enum {
+  PL_MIX_BLK = 256                /* frames per accumulator block. */
+};
+
+/* Load voice N registers. Returns 0 if the voice has nothing to
+ * mix.
+ */
+static int mix_voice_start(paula_t * const paula, plmix_t * const v,
+                           int N, const int shift)
+{
+  paulav_t * const w   = paula->voice+N;
+  u8       * const p   = paula->map+PAULA_VOICE(N);
+  const int     ct_fix = paula->ct_fix;
+  plct_t vol, per;
+
+  /* $$$ FIXME
+   * Dunno exactly what if volume is not in proper range [0..64]
+   */
+  vol = p[9] & 127;
+  if (vol >= 64)
+    vol = 64;
+  v->vol = vol << 1;
+
+  per = ( p[6] << 8 ) + p[7];
+  if (!per) per = 1;                    /* or is it +1 for all ?? */
+  v->stp = paula->clkperspl / per;
+
+  /* Audio irq disable for this voice :
+   * Internal will be reload at end of block
+   */
+  v->readr   = ( p[1] << 16 ) | ( p[2] << 8 ) | ( p[3] & 0xFE );
+  v->readr <<= ct_fix;
+  v->reend   = ((p[4] << 8) | p[5]);
+  v->reend  |= (!v->reend) << 16;     /* 0 is 0x10000 */
+  v->reend <<= (1 + ct_fix);          /* +1 as unit is 16-bit word */
+  v->reend  += v->readr;
+  assert( v->reend > v->readr );
+  if (v->reend <= v->readr) {
+    /* $$$ ??? dunno why I did this !!! May be could happen on a
+     * modulo. */
+    return 0;
+  }
+
+  v->adr = w->adr;
+  v->end = w->end;
+  if (v->end <= v->adr)
+    return 0;
+
+  v->out     = shift;
+  v->N       = N;
+  v->last    = 0;
+  v->hasloop = 0;
+  return 1;
+}
+
+/* Store voice counters and last sample read back. */
+static void mix_voice_end(paula_t * const paula, const plmix_t * const v)
+{
+  paulav_t * const w = paula->voice+v->N;
+  u8       * const p = paula->map+PAULA_VOICE(v->N);
+
+  p[0xA] = v->last + (v->last << 8);
+  w->adr = v->adr;
+  if (v->hasloop) {
+    w->start = v->readr;
+    w->end   = v->end;
+  }
+}
+
+/* Accumulate n samples of a voice that do not reach its block end
+ * (no interpolation). Like the STE mixer it reads bytes at computed
+ * offsets, which GCC does not vectorize, and it is too small a part
+ * of the render time to deserve mixer68 kernels.
+ */
+static void mix_span_simple(const paula_t * const paula,
+                            const plmix_t * const v,
+                            s32 * const acc, const int n)
+{
+  const u8 * const mem = paula->mem;
+  const int     ct_fix = paula->ct_fix;
+  const signed_plct_t vol = v->vol;
+  plct_t adr = v->adr;
+  int j;
+
+  for (j = 0; j < n; ++j, adr += v->stp)
+    acc[j] += (s8) mem[adr >> ct_fix] * vol;
+}
+
+/* Accumulate n samples of a voice that do not reach its block end
+ * (linear interpolation).
+ */
+static void mix_span_linear(const paula_t * const paula,
+                            const plmix_t * const v,
+                            s32 * const acc, const int n)
+{
+  const u8 * const mem = paula->mem;
+  const int     ct_fix = paula->ct_fix;
+  const plct_t   imask = ( (plct_t) 1 << ct_fix ) - 1;
+  const signed_plct_t one = (signed_plct_t) 1 << ct_fix;
+  const signed_plct_t vol = v->vol;
+  const int       loop = v->readr >> ct_fix;
+  plct_t adr = v->adr;
+  int j;
+
+  for (j = 0; j < n; ++j, adr += v->stp) {
+    const signed_plct_t low = adr & imask;
+    int idx = adr >> ct_fix;            /* current index  */
+    signed_plct_t v0, v1;
+
+    v0 = (s8) mem[idx++];               /* current sample */
+    if ( ( (plct_t) idx << ct_fix ) >= v->end )
+      idx = loop;                       /* loop index     */
+    v1 = (s8) mem[idx];                 /* next sample    */
+
+    v0 = ( v1 * low + v0 * ( one - low ) ) >> ct_fix;
+    v0 *= vol;
+
+    assert(v0 >= -16384);
+    assert(v0 <   16384);
+    acc[j] += v0;
+  }
+}
+
+/* Accumulate n samples of a voice, one wrap-free span at a time. */
+static void mix_voice(const paula_t * const paula, plmix_t * const v,
+                      s32 * acc, int n)
+{
+  const int ct_fix = paula->ct_fix;
+
+  while (n > 0) {
+    /* Samples before the voice reaches its block end. */
+    const u64 cnt = !v->stp ? (u64) n
+      : ( (u64) (v->end - v->adr) - 1 ) / v->stp + 1;
+    const int m = cnt < (u64) n ? (int) cnt : n;
+
+    if (paula->engine == PAULA_ENGINE_LINEAR)
+      mix_span_linear(paula, v, acc, m);
+    else
+      mix_span_simple(paula, v, acc, m);
+    v->last = paula->mem[ ( v->adr + (plct_t) (m-1) * v->stp ) >> ct_fix ];
+    v->adr += (plct_t) m * v->stp;
+    acc += m;
+    n   -= m;
+
+    if (v->adr >= v->end) {
+      plct_t relen = v->reend - v->readr;
+      v->hasloop = 1;
+      v->adr = v->readr + v->adr - v->end;
+      v->end = v->reend;
+      while (v->adr >= v->end) {
+        v->adr -= relen;
+      }
+    }
+  }
+}
+
+/* Mix all active voices. Each voice is accumulated into a per
+ * channel s32 block; the output buffer is written once per block.
+ */
+static void mix_voices(paula_t * const paula, s32 * b, int n, const int on)
+{
+  s32 acc[2][PL_MIX_BLK];
+  plmix_t v[4];
+  int i, nv = 0;
+
+  for (i=0; i<4; i++) {
+    /* $$$ VERIFY: channel mapping ABCD => LRRL ? */
+    const int right = (i^(i>>1)^msw_first)&1;
+    if ( ( on >> i ) & 1 )
+      nv += mix_voice_start(paula, v+nv, i, right);
+  }
+  if (!nv) {
+    clear_buffer(b, n);
+    return;
+  }
+
+  while (n > 0) {
+    const int m = n < PL_MIX_BLK ? n : PL_MIX_BLK;
+    s16 * const b2 = (s16 *) b;
+    int j;
+
+    for (j = 0; j < m; ++j)
+      acc[0][j] = acc[1][j] = 0;
+    for (i = 0; i < nv; ++i)
+      mix_voice(paula, v+i, acc[v[i].out], m);
+    for (j = 0; j < m; ++j) {
+      b2[2*j+0] = acc[0][j];
+      b2[2*j+1] = acc[1][j];
+    }
+    b += m;
+    n -= m;
+  }
+
+  for (i = 0; i < nv; ++i)
+    mix_voice_end(paula, v+i);
+}
+
+
 #if DEBUG_PL_O == 1
 
 typedef struct {
@@ -525,18 +699,22 @@ void paula_mix(paula_t * const paula, s32 * splbuf, int n)
 #if DEBUG_PL_O == 1
     paulav_dbg_t d[4];
 #endif
-    clear_buffer(splbuf, n);
+    if (!splbuf) {
+      /* no buffer : advance counters only */
+      for (i=0; i<4; i++)
+        if ((paula->dmacon >> 9) & ( (pl_mask & paula->dmacon) >> i) & 1)
+          skip_one(paula, i, n);
+      paula->vhpos = 0;
+      return;
+    }
     for (i=0; i<4; i++) {
-      /* $$$ VERIFY: channel mapping ABCD => LRRL ? */
-      const int right = (i^(i>>1)^msw_first)&1;
 #if DEBUG_PL_O == 1
       paula_dbg(d+i, paula, i);
 #endif
-      if ((paula->dmacon >> 9) & ( (pl_mask & paula->dmacon) >> i) & 1) {
-        mix_one(paula, i, right, splbuf, n);
+      if ((paula->dmacon >> 9) & ( (pl_mask & paula->dmacon) >> i) & 1)
         b += 1 << i;
-      }
     }
+    mix_voices(paula, splbuf, n, b);
 
 #if DEBUG_PL_O == 1
     if (1) {
@@ -395,8 +395,11 @@ IO68_EXTERN
  *   RAM. This implies at leat 512Kb and PCM data must be in the first
  *   512Kb.
  *
+ *   If splbuf is 0 nothing is mixed but the voice counters are
+ *   advanced as if n samples were.
+ *
  * @param  paula   Paula emulator instance
- * @param  splbuf  Destination 32-bit sample buffer
+ * @param  splbuf  Destination 32-bit sample buffer [0:skip]
  * @param  n       Number of sample to mix in splbuf buffer
  *
  */
@@ -0,0 +1,364 @@
+/*
+ * @file    resample.c
+ * @brief   Polyphase resampler
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include "io68_private.h"
+#include "resample.h"
+#include "emu68/struct68.h"
+#include "emu68/assert68.h"
+
+#include <string.h>
+#include <math.h>
+
+/* Vector dot product. SSE2 is part of all x86-64 targets, NEON of
+ * all aarch64 ones; other targets use the scalar loop. */
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define RESAMPLE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define RESAMPLE_NEON 1
+#endif
+
+#ifndef M_PI
+# define M_PI 3.14159265358979323846
+#endif
+
+enum {
+  COEF_FIX  = 14,                       /* coefficients fixed point */
+  MAX_PHASE = 1024                      /* max number of exact phases */
+};
+
+struct resample_bank_s {
+  uint_t irate;                         /* source rate */
+  uint_t orate;                         /* target rate */
+  int    quality;                       /* quality tier */
+  uint_t len;                           /* phase modulus (L) */
+  uint_t istp;                          /* integer step */
+  uint_t fstp;                          /* fractional step (in 1/L) */
+  int    nph;                           /* number of filter phases */
+  int    taps;                          /* taps per phase */
+  s16    coef[1];                       /* nph * taps coefficients */
+};
+
+/* ,-----------------------------------------------------------------.
+ * |                         Filter design                           |
+ * `-----------------------------------------------------------------'
+ */
+
+static uint_t gcd(uint_t a, uint_t b)
+{
+  while (b) {
+    const uint_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+/* Zeroth order modified Bessel function of the first kind. */
+static double bessel_i0(const double x)
+{
+  double sum = 1.0, term = 1.0, k;
+  for (k = 1.0; k < 64.0; k += 1.0) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum  += term;
+    if (term < sum * 1E-12)
+      break;
+  }
+  return sum;
+}
+
+/* Window function over [-1..1]. */
+static double window(const int quality, const double x)
+{
+  if (x <= -1.0 || x >= 1.0)
+    return 0.0;
+  if (quality == RESAMPLE_SINC) {
+    /* Blackman */
+    return 0.42 + 0.5 * cos(M_PI * x) + 0.08 * cos(2.0 * M_PI * x);
+  } else {
+    /* Kaiser (beta=9) */
+    const double beta = 9.0;
+    return bessel_i0(beta * sqrt(1.0 - x * x)) / bessel_i0(beta);
+  }
+}
+
+/* Number of taps for a given quality and ratio. */
+static int filter_taps(const int quality, const uint_t irate,
+                       const uint_t orate)
+{
+  int base, taps;
+
+  switch (quality) {
+  case RESAMPLE_SINC:    base = 8;  break;
+  case RESAMPLE_SINC_HQ: base = 32; break;
+  default:
+    return 2;
+  }
+  /* Down-sampling widens the filter to keep the same transition
+   * band relatively to the target rate. */
+  taps = irate > orate
+    ? (int) (((u64) base * irate + orate - 1) / orate)
+    : base;
+  taps = (taps + 7) & ~7;             /* multiple of 8 for dot() */
+  return taps > RESAMPLE_MAX_TAPS ? RESAMPLE_MAX_TAPS : taps;
+}
+
+/* Compute one phase: f is the fractional position in [0..1). */
+static void filter_phase(s16 * const coef, const resample_bank_t * b,
+                         const double f)
+{
+  const int half = b->taps >> 1;
+  double h[RESAMPLE_MAX_TAPS], sum = 0.0;
+  int j, big = half - 1, acc = 0;
+
+  switch (b->quality) {
+
+  case RESAMPLE_NEAREST:
+    for (j = 0; j < b->taps; ++j) h[j] = 0.0;
+    h[half - (f < 0.5)] = 1.0;
+    break;
+
+  case RESAMPLE_LINEAR:
+    for (j = 0; j < b->taps; ++j) h[j] = 0.0;
+    h[half-1] = 1.0 - f;
+    h[half  ] = f;
+    break;
+
+  default: {
+    /* Cutoff relative to the source rate, a bit under Nyquist. */
+    const double rolloff = b->quality == RESAMPLE_SINC ? 0.90 : 0.95;
+    const double fc = 0.5 * rolloff *
+      (b->orate < b->irate ? (double) b->orate / b->irate : 1.0);
+    for (j = 0; j < b->taps; ++j) {
+      const double d = j - half + 1 - f; /* distance to the output */
+      const double x = 2.0 * M_PI * fc * d;
+      h[j] = (d == 0.0 ? 1.0 : sin(x) / x) * window(b->quality, d / half);
+    }
+  } break;
+  }
+
+  for (j = 0; j < b->taps; ++j)
+    sum += h[j];
+
+  /* Normalize for unity DC gain then fix rounding on the biggest tap. */
+  for (j = 0; j < b->taps; ++j) {
+    coef[j] = (s16) floor(h[j] * (1 << COEF_FIX) / sum + 0.5);
+    acc += coef[j];
+    if (h[j] > h[big])
+      big = j;
+  }
+  coef[big] += (1 << COEF_FIX) - acc;
+}
+
+resample_bank_t * resample_bank(resample_bank_t * bank,
+                                uint_t irate, uint_t orate, int quality)
+{
+  uint_t g;
+  int taps, nph, i;
+
+  if (bank && bank->irate == irate && bank->orate == orate &&
+      bank->quality == quality)
+    return bank;
+  resample_bank_free(bank);
+
+  if (!irate || !orate || quality < 0 || quality >= RESAMPLE_QUALITIES)
+    return 0;
+
+  g    = gcd(irate, orate);
+  taps = filter_taps(quality, irate, orate);
+  nph  = orate / g <= MAX_PHASE ? orate / g : MAX_PHASE / 2;
+
+  bank = emu68_alloc(sizeof(*bank) + (nph * taps - 1) * sizeof(*bank->coef));
+  if (!bank)
+    return 0;
+
+  bank->irate   = irate;
+  bank->orate   = orate;
+  bank->quality = quality;
+  bank->len     = orate / g;
+  bank->istp    = (irate / g) / bank->len;
+  bank->fstp    = (irate / g) % bank->len;
+  bank->nph     = nph;
+  bank->taps    = taps;
+
+  for (i = 0; i < nph; ++i)
+    filter_phase(bank->coef + i * taps, bank, (double) i / nph);
+
+  return bank;
+}
+
+void resample_bank_free(resample_bank_t * bank)
+{
+  emu68_free(bank);
+}
+
+/* ,-----------------------------------------------------------------.
+ * |                          Resampling                             |
+ * `-----------------------------------------------------------------'
+ */
+
+void resample_reset(resample_t * const rs)
+{
+  rs->quality = -1;
+}
+
+/* Actual reset to the bank parameters. */
+static void reset(resample_t * const rs, const resample_bank_t * b)
+{
+  const int half = b->taps >> 1;
+  rs->irate   = b->irate;
+  rs->orate   = b->orate;
+  rs->quality = b->quality;
+  rs->frac    = 0;
+  rs->pos     = half - 1;
+  rs->hlen    = half - 1;
+  memset(rs->hist, 0, rs->hlen * sizeof(*rs->hist));
+}
+
+static inline int clip16(const int v)
+{
+  return v < -32768 ? -32768 : v > 32767 ? 32767 : v;
+}
+
+/* Dot product of the history with a filter phase (taps is a
+ * multiple of 8). */
+static inline int dot(const s16 * x, const s16 * h, const int taps)
+{
+  int j;
+#if defined(RESAMPLE_SSE2)
+  __m128i acc = _mm_setzero_si128();
+  for (j = 0; j < taps; j += 8)
+    acc = _mm_add_epi32(
+      acc, _mm_madd_epi16(_mm_loadu_si128((const __m128i *) (x+j)),
+                          _mm_loadu_si128((const __m128i *) (h+j))));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+  return (_mm_cvtsi128_si32(acc) + (1 << (COEF_FIX-1))) >> COEF_FIX;
+#elif defined(RESAMPLE_NEON)
+  int32x4_t acc = vdupq_n_s32(0);
+  int32x2_t sum;
+  for (j = 0; j < taps; j += 8) {
+    const int16x8_t a = vld1q_s16(x+j), b = vld1q_s16(h+j);
+    acc = vmlal_s16(acc, vget_low_s16(a),  vget_low_s16(b));
+    acc = vmlal_s16(acc, vget_high_s16(a), vget_high_s16(b));
+  }
+  sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+  return (vget_lane_s32(vpadd_s32(sum, sum), 0) + (1 << (COEF_FIX-1)))
+    >> COEF_FIX;
+#else
+  int acc = 1 << (COEF_FIX-1);
+  for (j = 0; j < taps; ++j)
+    acc += x[j] * h[j];
+  return acc >> COEF_FIX;
+#endif
+}
+
+/* Common run/skip loop: src=0 for silence, dst=0 to only count. */
+static int process(resample_t * const rs, const resample_bank_t * b,
+                   s32 * dst, const s32 * src, int n)
+{
+  const int half = b->taps >> 1;
+  int cnt = 0;
+
+  assert(rs);
+  assert(b);
+
+  if (rs->quality != b->quality ||
+      rs->irate != b->irate || rs->orate != b->orate)
+    reset(rs, b);
+
+  while (n > 0) {
+    int m = RESAMPLE_HIST - rs->hlen, pos = rs->pos, k;
+    uint_t frac = rs->frac;
+
+    /* Append input to the history. */
+    if (m > n)
+      m = n;
+    if (src) {
+      s16 * h = rs->hist + rs->hlen;
+      for (k = 0; k < m; ++k)
+        h[k] = clip16(src[k]);
+      src += m;
+    } else
+      memset(rs->hist + rs->hlen, 0, m * sizeof(*rs->hist));
+    rs->hlen += m;
+    n -= m;
+
+    /* Produce all outputs which input is available. */
+    while (pos + half < rs->hlen) {
+      if (!dst)
+        ;
+      else if (b->quality == RESAMPLE_NEAREST)
+        *dst++ = rs->hist[pos + (frac >= b->len - frac)];
+      else {
+        const int ph = b->nph == (int) b->len
+          ? (int) frac
+          : (int) (((u64) frac * b->nph) / b->len);
+        const s16 * const x = rs->hist + pos - half + 1;
+        const s16 * const h = b->coef + ph * b->taps;
+        *dst++ = b->quality == RESAMPLE_LINEAR
+          ? (x[0] * h[0] + x[1] * h[1] + (1 << (COEF_FIX-1))) >> COEF_FIX
+          : clip16(dot(x, h, b->taps));
+      }
+      ++cnt;
+      pos  += b->istp;
+      frac += b->fstp;
+      if (frac >= b->len) {
+        frac -= b->len;
+        ++pos;
+      }
+    }
+
+    /* Discard the history that won't be used anymore. */
+    k = pos - half + 1;
+    if (k > rs->hlen)
+      k = rs->hlen;
+    if (k > 0) {
+      rs->hlen -= k;
+      memmove(rs->hist, rs->hist + k, rs->hlen * sizeof(*rs->hist));
+      pos -= k;
+    }
+    rs->pos  = pos;
+    rs->frac = frac;
+  }
+  return cnt;
+}
+
+int resample_run(resample_t * const rs, const resample_bank_t * bank,
+                 s32 * dst, const s32 * src, int n)
+{
+  assert(dst);
+  assert(src);
+  return process(rs, bank, dst, src, n);
+}
+
+int resample_skip(resample_t * const rs, const resample_bank_t * bank, int n)
+{
+  return process(rs, bank, 0, 0, n);
+}
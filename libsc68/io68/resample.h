@@ -0,0 +1,153 @@
+/**
+ * @ingroup   lib_io68
+ * @file      io68/resample.h
+ * @author    Benjamin Gerard
+ * @date      2016/03/14
+ * @brief     Polyphase resampler header.
+ */
+
+/* Copyright (c) 1998-2016 Benjamin Gerard */
+
+#ifndef IO68_RESAMPLE_H
+#define IO68_RESAMPLE_H
+
+#include "io68_api.h"
+#include "emu68/type68.h"
+
+/**
+ * @defgroup  lib_io68_resample  Polyphase resampler
+ * @ingroup   lib_io68
+ * @brief     Fixed ratio sampling rate converter.
+ *
+ *   The resampler converts a mono 16-bit stream from a source rate to
+ *   a target rate. Each output sample is the dot product of the input
+ *   history with one phase of a precomputed filter bank. The bank
+ *   only depends on the (source rate, target rate, quality) triplet
+ *   so it is computed once and kept apart from the stream state.
+ *
+ *   The stream state (resample_t) is a plain structure without any
+ *   pointer so that it can be copied along with the emulator state
+ *   (e.g. snapshots). The bank (resample_bank_t) is an opaque heap
+ *   allocated object owned by the caller.
+ *
+ *   The phase accumulator is exact (rational step) so that the
+ *   number of output samples never drifts. The filter phase is exact
+ *   too when the reduced ratio has less than 1024 phases which is the
+ *   case for all usual rates.
+ *
+ * @{
+ */
+
+/**
+ * Resampler quality.
+ */
+enum resample_quality_e {
+  RESAMPLE_NEAREST = 0,     /**< Nearest sample (no filtering).       */
+  RESAMPLE_LINEAR,          /**< Linear interpolation.                */
+  RESAMPLE_SINC,            /**< Short Blackman windowed sinc.        */
+  RESAMPLE_SINC_HQ,         /**< Long Kaiser windowed sinc.           */
+  RESAMPLE_QUALITIES        /**< Number of quality tiers.             */
+};
+
+enum {
+  RESAMPLE_MAX_TAPS = 256,  /**< Maximum number of taps per phase.    */
+  RESAMPLE_HIST     = 1024  /**< Input history size (in samples).     */
+};
+
+/**
+ * Resampler filter bank (opaque type).
+ */
+typedef struct resample_bank_s resample_bank_t;
+
+/**
+ * Resampler stream state.
+ */
+typedef struct {
+  uint_t irate;             /**< Source rate of the state.            */
+  uint_t orate;             /**< Target rate of the state.            */
+  int    quality;           /**< Quality of the state (-1:reset).     */
+  uint_t frac;              /**< Fractional position (in 1/L).        */
+  int    pos;               /**< Integer position into hist[].        */
+  int    hlen;              /**< Number of samples in hist[].         */
+  s16    hist[RESAMPLE_HIST]; /**< Input history.                     */
+} resample_t;
+
+IO68_EXTERN
+/**
+ * Get a filter bank.
+ *
+ *   If the given bank matches the requested parameters it is
+ *   returned as is. Otherwise it is destroyed and a new one is
+ *   created.
+ *
+ * @param  bank     current bank (0 for none)
+ * @param  irate    source sampling rate (in hz)
+ * @param  orate    target sampling rate (in hz)
+ * @param  quality  @ref resample_quality_e "quality"
+ *
+ * @return filter bank
+ * @retval 0 on error
+ */
+resample_bank_t * resample_bank(resample_bank_t * bank,
+                                uint_t irate, uint_t orate, int quality);
+
+IO68_EXTERN
+/**
+ * Destroy a filter bank.
+ *
+ * @param  bank  bank to destroy (0 is safe)
+ */
+void resample_bank_free(resample_bank_t * bank);
+
+IO68_EXTERN
+/**
+ * Reset a resampler state.
+ *
+ *   The state is actually reset on next resample_run() or
+ *   resample_skip() call. It also happens automatically when the
+ *   bank parameters differ from the state ones.
+ *
+ * @param  rs  resampler state
+ */
+void resample_reset(resample_t * const rs);
+
+IO68_EXTERN
+/**
+ * Resample a block of samples.
+ *
+ *   Input samples are clipped to 16-bit. The input is consumed
+ *   before the output is written so that the conversion can be done
+ *   in place (@p dst == @p src) as long as the number of output
+ *   samples is not greater than the number of input samples.
+ *
+ * @param  rs    resampler state
+ * @param  bank  filter bank
+ * @param  dst   output buffer
+ * @param  src   input buffer
+ * @param  n     number of input samples
+ *
+ * @return number of samples written into @p dst
+ */
+int resample_run(resample_t * const rs, const resample_bank_t * bank,
+                 s32 * dst, const s32 * src, int n);
+
+IO68_EXTERN
+/**
+ * Skip a block of samples.
+ *
+ *   Advances the resampler exactly like resample_run() would but the
+ *   input is considered silent and no output is produced.
+ *
+ * @param  rs    resampler state
+ * @param  bank  filter bank
+ * @param  n     number of input samples
+ *
+ * @return number of samples resample_run() would have produced
+ */
+int resample_skip(resample_t * const rs, const resample_bank_t * bank, int n);
+
+/**
+ * @}
+ */
+
+#endif
@@ -167,6 +167,33 @@ static void shifter_destroy(io68_t * const io)
   emu68_free(io);
 }
 
+static int shifter_save(io68_t * const io, void * const data, const int max)
+{
+  shifter_io68_t * const shifterio = (shifter_io68_t *)io;
+  if (data) {
+    u8 * const ptr = data;
+    if (max < 2)
+      return -1;
+    ptr[0] = shifterio->data_0a;
+    ptr[1] = shifterio->data_60;
+  }
+  return 2;
+}
+
+static int shifter_restore(io68_t * const io, const void * const data,
+                           const int len)
+{
+  shifter_io68_t * const shifterio = (shifter_io68_t *)io;
+  const u8 * const ptr = data;
+  if (!data || len != 2)
+    return -1;
+  shifterio->data_0a = ptr[0];
+  shifterio->data_60 = ptr[1];
+  return 0;
+}
+
+static io68_t * shifter_duplicate(io68_t * const, emu68_t * const);
+
 static io68_t const shifter_io =
 {
   0,
@@ -177,7 +204,9 @@ static io68_t const shifter_io =
   shifter_interrupt, shifter_next_interrupt,
   shifter_adjust_cycle,
   shifter_reset,
-  shifter_destroy
+  shifter_destroy,
+  shifter_save, shifter_restore,
+  shifter_duplicate
 };
 
 int shifterio_init(int * argc, char ** argv)
@@ -205,6 +234,18 @@ io68_t * shifterio_create(emu68_t * const emu68, int hz)
   return &io->io;
 }
 
+static io68_t * shifter_duplicate(io68_t * const io, emu68_t * const emu68)
+{
+  shifter_io68_t * const shifterio = (shifter_io68_t *)io;
+  shifter_io68_t * const dup = (shifter_io68_t *)shifterio_create(emu68, 0);
+
+  if (dup) {
+    dup->data_0a = shifterio->data_0a;
+    dup->data_60 = shifterio->data_60;
+  }
+  return dup ? &dup->io : 0;
+}
+
 int shifterio_reset(io68_t * const io, int hz)
 {
   if (io) {
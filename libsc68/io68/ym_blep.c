@@ -317,109 +317,208 @@ static int mix_to_buffer(ym_t * const ym, cycle68_t cycles, s32 *output)
   return len;
 }
 
-/* Mix for ymcycles cycles. */
-static int run(ym_t * const ym, s32 * output, const cycle68_t ymcycles)
+/* Write an YM register and update internal states accordingly. */
+static void update_reg(ym_t * const ym, const ym_event_t * const event)
 {
   ym_blep_t *blep = &ym->emu.blep;
-
-  u32 len = 0, voice;
+  u32 voice;
   s32 newevent;
 
-  /* Walk  the static list of allocated events */
-  cycle68_t currcycle = 0;
-  ym_event_t *event;
-  for (event = ym->event_buf; event < ym->event_ptr; event++) {
-    assert( event->ymcycle <= ymcycles );
+  ym->reg.index[event->reg] = event->val;
+
+  /* Update various internal variables in response to writes.
+   * unfortunately pointers don't work for this, so... */
+  switch (event->reg) {
+  case 0: /* per_x_lo, per_x_hi */
+  case 1:
+  case 2:
+  case 3:
+  case 4:
+  case 5:
+    voice = event->reg >> 1;
+    newevent = ym->reg.index[voice << 1]
+      | ((ym->reg.index[(voice << 1) + 1] & TONE_HI_MASK) << 8);
+    if (newevent == 0)
+      newevent = 1;
+    newevent <<= 3;
+
+    /* The chip performs count >= event. If the condition is
+     * true, event triggers immediately. However, I have inverted
+     * the count to occur towards zero. Changes in event must
+     * therefore affect the prevailing count. If new event time
+     * is greater than current, the count must increase as the
+     * current state will be delayed. */
+    blep->tonegen[voice].count += newevent - blep->tonegen[voice].event;
+    blep->tonegen[voice].event = newevent;
+    /* I do not deal with negative counts in the hot path. */
+    if (blep->tonegen[voice].count < 0)
+      blep->tonegen[voice].count = 0;
+    break;
+
+  case 6: /* per_noise */
+    newevent = ym->reg.name.per_noise & NOISE_MASK;
+    if (newevent == 0)
+      newevent = 1;
+    newevent <<= 4;
+
+    blep->noise_count += newevent - blep->noise_event;
+    blep->noise_event = newevent;
+    if (blep->noise_count < 0)
+      blep->noise_count = 0;
+    break;
+
+  case 7: /* mixer */
+    blep->tonegen[0].tonemix  = event->val &  1 ? 0xffff : 0;
+    blep->tonegen[1].tonemix  = event->val &  2 ? 0xffff : 0;
+    blep->tonegen[2].tonemix  = event->val &  4 ? 0xffff : 0;
+    blep->tonegen[0].noisemix = event->val &  8 ? 0xffff : 0;
+    blep->tonegen[1].noisemix = event->val & 16 ? 0xffff : 0;
+    blep->tonegen[2].noisemix = event->val & 32 ? 0xffff : 0;
+    break;
+
+  case 8: /* volume */
+  case 9:
+  case 10:
+    voice = event->reg - 8;
+    blep->tonegen[voice].envmask = (event->val & 0x10)
+      ? 0x1f << (voice*5) : 0;
+    blep->tonegen[voice].volmask = (event->val & 0x10)
+      ? 0 : (((event->val & 0xf) << 1) | 1) << (voice*5);
+    break;
+
+  case 11: /* per_env_lo, per_env_hi */
+  case 12:
+    newevent = ym->reg.name.per_env_lo | (ym->reg.name.per_env_hi << 8);
+    if (newevent == 0)
+      newevent = 1;
+    newevent <<= 3;
+
+    blep->env_count += newevent - blep->env_event;
+    blep->env_event = newevent;
+    if (blep->env_count < 0)
+      blep->env_count = 0;
+    break;
+
+  case 13: /* env_shape */
+    blep->env_state = 0;
+    break;
+  }
+}
 
-    /* Mix up to this cycle, update state */
-    len += mix_to_buffer(ym, event->ymcycle - currcycle, output + len);
-    ym->reg.index[event->reg] = event->val;
-
-    /* Update various internal variables in response to writes.
-     * unfortunately pointers don't work for this, so... */
-    switch (event->reg) {
-    case 0: /* per_x_lo, per_x_hi */
-    case 1:
-    case 2:
-    case 3:
-    case 4:
-    case 5:
-      voice = event->reg >> 1;
-      newevent = ym->reg.index[voice << 1]
-        | ((ym->reg.index[(voice << 1) + 1] & TONE_HI_MASK) << 8);
-      if (newevent == 0)
-        newevent = 1;
-      newevent <<= 3;
-
-      /* The chip performs count >= event. If the condition is
-       * true, event triggers immediately. However, I have inverted
-       * the count to occur towards zero. Changes in event must
-       * therefore affect the prevailing count. If new event time
-       * is greater than current, the count must increase as the
-       * current state will be delayed. */
-      blep->tonegen[voice].count += newevent - blep->tonegen[voice].event;
-      blep->tonegen[voice].event = newevent;
-      /* I do not deal with negative counts in the hot path. */
-      if (blep->tonegen[voice].count < 0)
-        blep->tonegen[voice].count = 0;
-      break;
+/* Advance a count-down counter by n clocks exactly as ym2149_clock()
+ * does and return how many times it has elapsed. */
+static inline u32 advance(s32 * const count, const u32 event, const u32 n)
+{
+  u32 cnt;
+  if (n < (u32) *count) {
+    *count -= n;
+    return 0;
+  }
+  cnt = 1 + (n - *count) / event;
+  *count = event - (n - *count) % event;
+  return cnt;
+}
 
-    case 6: /* per_noise */
-      newevent = ym->reg.name.per_noise & NOISE_MASK;
-      if (newevent == 0)
-        newevent = 1;
-      newevent <<= 4;
+/* Clock subsystems forward without generating any blep. Returns the
+ * number of samples mix_to_buffer() would have produced. */
+static int skip_clock(ym_t * const ym, const cycle68_t cycles)
+{
+  ym_blep_t *blep = &ym->emu.blep;
+  const u16 * const waveform =
+    ym_envelops[ym->reg.name.env_shape & CTL_ENV_MASK];
+  u32 i, cnt, len = 0;
+
+  if (!cycles)
+    return 0;
+
+  for (i = 0; i < 3; i++)
+    if (advance(&blep->tonegen[i].count, blep->tonegen[i].event, cycles) & 1)
+      blep->tonegen[i].flip_flop = ~blep->tonegen[i].flip_flop;
+
+  for (cnt = advance(&blep->noise_count, blep->noise_event, cycles);
+       cnt; --cnt) {
+    if (blep->noise_state & 1) {
+      blep->noise_state = (blep->noise_state >> 1) ^ 0x12000;
+      blep->noise_output = 0xffff;
+    } else {
+      blep->noise_state >>= 1;
+      blep->noise_output = 0x0000;
+    }
+  }
 
-      blep->noise_count += newevent - blep->noise_event;
-      blep->noise_event = newevent;
-      if (blep->noise_count < 0)
-        blep->noise_count = 0;
-      break;
+  cnt = advance(&blep->env_count, blep->env_event, cycles);
+  if (cnt) {
+    u32 state = blep->env_state + cnt - 1;
+    if (state >= 96)
+      state = 32 + (state - 32) % 64;
+    blep->env_output = waveform[state];
+    if (++state == 96)
+      state = 32;
+    blep->env_state = state;
+  }
 
-    case 7: /* mixer */
-      blep->tonegen[0].tonemix  = event->val &  1 ? 0xffff : 0;
-      blep->tonegen[1].tonemix  = event->val &  2 ? 0xffff : 0;
-      blep->tonegen[2].tonemix  = event->val &  4 ? 0xffff : 0;
-      blep->tonegen[0].noisemix = event->val &  8 ? 0xffff : 0;
-      blep->tonegen[1].noisemix = event->val & 16 ? 0xffff : 0;
-      blep->tonegen[2].noisemix = event->val & 32 ? 0xffff : 0;
-      break;
+  blep->time += cycles;
 
-    case 8: /* volume */
-    case 9:
-    case 10:
-      voice = event->reg - 8;
-      blep->tonegen[voice].envmask = (event->val & 0x10)
-        ? 0x1f << (voice*5) : 0;
-      blep->tonegen[voice].volmask = (event->val & 0x10)
-        ? 0 : (((event->val & 0xf) << 1) | 1) << (voice*5);
-      break;
+  /* Keep the sampling phase. */
+  for (cnt = cycles; cnt > blep->cycles_to_next_sample >> 8; ) {
+    cnt -= blep->cycles_to_next_sample >> 8;
+    blep->cycles_to_next_sample &= 0xff;
+    blep->cycles_to_next_sample += blep->cycles_per_sample;
+    ++len;
+  }
+  blep->cycles_to_next_sample -= cnt << 8;
+  return len;
+}
 
-    case 11: /* per_env_lo, per_env_hi */
-    case 12:
-      newevent = ym->reg.name.per_env_lo | (ym->reg.name.per_env_hi << 8);
-      if (newevent == 0)
-        newevent = 1;
-      newevent <<= 3;
-
-      blep->env_count += newevent - blep->env_event;
-      blep->env_event = newevent;
-      if (blep->env_count < 0)
-        blep->env_count = 0;
-      break;
+/* Skip ymcycles cycles. */
+static int skip(ym_t * const ym, const cycle68_t ymcycles)
+{
+  ym_blep_t *blep = &ym->emu.blep;
+  cycle68_t currcycle = 0;
+  ym_eviter_t it;
+  ym_event_t *event;
+  int i, len = 0;
 
-    case 13: /* env_shape */
-      blep->env_state = 0;
-      break;
-    }
+  for (event = ym_event_first(ym,&it); event; event = ym_event_next(&it)) {
+    assert( event->ymcycle <= ymcycles );
+    len += skip_clock(ym, event->ymcycle - currcycle);
+    update_reg(ym, event);
+    currcycle = event->ymcycle;
+  }
+  ym_event_flush(ym);
+  len += skip_clock(ym, ymcycles - currcycle);
 
+  /* Drop the blep train and restart from the current level. */
+  for (i = 0; i < MAX_BLEPS; ++i)
+    blep->blepstate[i].stamp = blep->time - BLEP_SIZE;
+  ym2149_new_output_level(ym);
+  blep->blepstate[blep->blep_idx].stamp = blep->time - BLEP_SIZE;
+
+  return len;
+}
+
+/* Mix for ymcycles cycles. */
+static int run(ym_t * const ym, s32 * output, const cycle68_t ymcycles)
+{
+  u32 len = 0;
+
+  /* Walk  the static list of allocated events */
+  cycle68_t currcycle = 0;
+  ym_eviter_t it;
+  ym_event_t *event;
+  for (event = ym_event_first(ym,&it); event; event = ym_event_next(&it)) {
+    assert( event->ymcycle <= ymcycles );
+
+    /* Mix up to this cycle, update state */
+    len += mix_to_buffer(ym, event->ymcycle - currcycle, output + len);
+    update_reg(ym, event);
     ym2149_new_output_level(ym);
 
     currcycle = event->ymcycle;
   }
 
   /* Reset event list. */
-  ym->event_ptr = ym->event_buf;
+  ym_event_flush(ym);
 
   /* Mix stuff outside writes */
   len += mix_to_buffer(ym, ymcycles - currcycle, output + len);
@@ -466,6 +565,7 @@ int ym_blep_setup(ym_t * const ym)
   ym->cb_run           = run;
   ym->cb_buffersize    = buffersize;
   ym->cb_sampling_rate = sampling_rate;
+  ym->cb_skip          = skip;
   return 0;
 }
 
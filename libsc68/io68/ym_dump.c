@@ -112,7 +112,8 @@ int run(ym_t * const ym, s32 * output, const cycle68_t ymcycles)
 
 
   char tmp [128], * buf;
-  ym_event_t * ptr = ym->event_buf;
+  ym_eviter_t it;
+  ym_event_t * ptr;
 
   /* voice mute bit#0=A / bit#1=B / bit#2=C */
   mix_mute
@@ -135,18 +136,16 @@ int run(ym_t * const ym, s32 * output, const cycle68_t ymcycles)
   /* mark registers as not accessed yet. */
   for ( i = 0; i < 16; ++i ) ymreg[i] = -1;
 
-  if (ptr == ym->event_ptr) {
+  if (!ym->event_cnt) {
     /* $$$ DIRTY TRICK: nothing happen but we style need to print at
      * least one line, so let just pretend a false access to register
      * 15. */
-    ptr->ymcycle = 0;
-    ptr->reg = 15;
-    ptr->val = 00;
-    ++ym->event_ptr;
+    ym_event_push(ym, 0, 15, 00);
   }
 
   /* Walk the events */
-  while (ptr < ym->event_ptr) {
+  ptr = ym_event_first(ym,&it);
+  while (ptr) {
     curcycle  = ptr->ymcycle;
     longcycle = dump->base_cycle + (u64) curcycle;
 
@@ -154,7 +153,7 @@ int run(ym_t * const ym, s32 * output, const cycle68_t ymcycles)
     do {
       assert( (unsigned int) ptr->reg < 16 );
       ymreg[ptr->reg & 15] = ptr->val & 255;
-    } while (++ptr < ym->event_ptr && ptr->ymcycle == curcycle);
+    } while (ptr = ym_event_next(&it), ptr && ptr->ymcycle == curcycle);
 
     buf = tmp;
 
@@ -194,7 +193,7 @@ int run(ym_t * const ym, s32 * output, const cycle68_t ymcycles)
   }
 
   /* Reset event list */
-  ym->event_ptr = ym->event_buf;
+  ym_event_flush(ym);
 
   /* null terminated string and align to 32-bit */
   dump->base_cycle += (uint64_t) ymcycles;
@@ -209,6 +208,24 @@ int run(ym_t * const ym, s32 * output, const cycle68_t ymcycles)
 }
 
 
+static
+int skip(ym_t * const ym, const cycle68_t ymcycles)
+{
+  ym_dump_t * const dump = &ym->emu.dump;
+  ym_eviter_t it;
+  ym_event_t * ptr;
+
+  /* Nothing is printed, only keep registers and counters in sync. */
+  for (ptr = ym_event_first(ym,&it); ptr; ptr = ym_event_next(&it))
+    ym->reg.index[ptr->reg & 15] = ptr->val;
+  ym_event_flush(ym);
+
+  dump->base_cycle += (uint64_t) ymcycles;
+  dump->pass++;
+
+  return buffersize(ym, ymcycles);
+}
+
 static
 void cleanup(ym_t * const ym)
 {
@@ -238,6 +255,7 @@ int ym_dump_setup(ym_t * const ym)
   ym->cb_run           = run;
   ym->cb_buffersize    = buffersize;
   ym->cb_sampling_rate = (void*)0;
+  ym->cb_skip          = skip;
   dump->base_cycle     = 0;
   dump->active         = 1;
   dump->pass           = 0;
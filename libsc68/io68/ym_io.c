@@ -217,6 +217,19 @@ static void ymio_destroy(io68_t * const io)
   }
 }
 
+static int ymio_save(io68_t * const io, void * const data, const int max)
+{
+  return ym_save(&((ym_io68_t *)io)->ym, data, max);
+}
+
+static int ymio_restore(io68_t * const io, const void * const data,
+                        const int len)
+{
+  return ym_restore(&((ym_io68_t *)io)->ym, data, len);
+}
+
+static io68_t * ymio_duplicate(io68_t * const, emu68_t * const);
+
 static io68_t ym_io =
 {
   0,
@@ -227,7 +240,9 @@ static io68_t ym_io =
   ymio_interrupt, ymio_nextinterrupt,
   ymio_adjust_cycle,
   ymio_reset,
-  ymio_destroy
+  ymio_destroy,
+  ymio_save, ymio_restore,
+  ymio_duplicate
 };
 
 int ymio_init(int * argc, char ** argv)
@@ -286,6 +301,37 @@ io68_t * ymio_create(emu68_t * const emu68, ym_parms_t * const parms)
   return &ymio->io;
 }
 
+/* Events are copied through a snapshot so that the duplicate gets its
+ * own event chunks. The engine allocations are rebuilt on demand. */
+static io68_t * ymio_duplicate(io68_t * const io, emu68_t * const emu68)
+{
+  ym_io68_t * const ymio = (ym_io68_t *)io;
+  ym_io68_t * dup;
+  ym_parms_t parms;
+  void * data;
+  int len;
+
+  parms.engine   = ymio->ym.engine;
+  parms.volmodel = ymio->ym.volmodel;
+  parms.clock    = ymio->ym.clock;
+  parms.hz       = ymio->ym.hz;
+  dup = (ym_io68_t *)ymio_create(emu68, &parms);
+  if (!dup)
+    return 0;
+
+  len  = ym_save(&ymio->ym, 0, 0);
+  data = emu68_alloc(len);
+  if (!data || ym_save(&ymio->ym, data, len) != len ||
+      ym_restore(&dup->ym, data, len)) {
+    ymio_destroy(&dup->io);
+    dup = 0;
+  } else {
+    dup->ym.voice_mute = ymio->ym.voice_mute;
+  }
+  emu68_free(data);
+  return dup ? &dup->io : 0;
+}
+
 int ymio_sampling_rate(io68_t * const io, int sampling_rate)
 {
   return io
@@ -320,6 +366,15 @@ int ymio_run(const io68_t * const io, s32 * output, const cycle68_t cycles)
   return 0;
 }
 
+int ymio_skip(const io68_t * const io, const cycle68_t cycles)
+{
+  if (io) {
+    ym_io68_t * const ymio = (ym_io68_t *)io;
+    return ym_skip(&ymio->ym,cycle_cputoym(ymio,cycles));
+  }
+  return 0;
+}
+
 /** Convert a cpu-cycle to ym-cycle. */
 cycle68_t ymio_cycle_cpu2ym(const io68_t * const io, const cycle68_t cycles)
 {
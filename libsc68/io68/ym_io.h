@@ -69,6 +69,14 @@ IO68_EXTERN
  */
 int ymio_run(const io68_t * const io, s32 * output, const cycle68_t cycles);
 
+IO68_EXTERN
+/**
+ *  Run ym emulator without generating sound.
+ *
+ *  @see ym_skip()
+ */
+int ymio_skip(const io68_t * const io, const cycle68_t cycles);
+
 IO68_EXTERN
 /**
  *  Get required sample buffer size.
@@ -96,6 +96,8 @@ struct ym2149_puls_s
    */
 
   int ifilter;                         /**< filter function to use. */
+  int iresample;                       /**< resampler (0:legacy).   */
+  resample_t rsp;                      /**< resampler state.        */
 
 };
 
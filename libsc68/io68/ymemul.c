@@ -33,6 +33,7 @@
 #include <sc68/file68_msg.h>
 #include <sc68/file68_opt.h>
 #include <string.h>
+#include <stddef.h>
 
 #ifndef BREAKPOINT68
 # define BREAKPOINT68 assert(!"breakpoint")
@@ -84,7 +85,7 @@ int ym_reset(ym_t * const ym, const cycle68_t ymcycle)
     }
 
     /* Reset event lists */
-    ym->event_ptr = ym->event_buf;
+    ym_event_flush(ym);
     ym->event_ovf = 0;
 
     ret = 0;
@@ -262,35 +263,110 @@ int ym_run(ym_t * const ym, s32 * output, const cycle68_t ymcycles)
   return ym->cb_run(ym,output,ymcycles);
 }
 
+int ym_skip(ym_t * const ym, const cycle68_t ymcycles)
+{
+  if (!ymcycles) {
+    return 0;
+  }
+
+  if (ymcycles&31) {
+    return -1;
+  }
+
+  if (ym->cb_skip) {
+    return ym->cb_skip(ym,ymcycles);
+  } else {
+    /* Engine can not skip: just keep registers up to date. */
+    ym_eviter_t it;
+    ym_event_t * event;
+    for (event = ym_event_first(ym,&it); event; event = ym_event_next(&it))
+      ym->reg.index[event->reg] = event->val;
+    ym_event_flush(ym);
+    return ym->cb_buffersize(ym,ymcycles);
+  }
+}
+
 
 /* ,-----------------------------------------------------------------.
  * |                         Write YM register                       |
  * `-----------------------------------------------------------------'
  */
 
-#define ELTOF(A) ( sizeof(A) / sizeof(*A) )
-
 void ym_writereg(ym_t * const ym,
                  const int val, const cycle68_t ymcycle)
 {
   const int reg = ym->ctrl;
-  const ym_event_t * const event_end = ym->event_buf+ELTOF(ym->event_buf);
 
   if ( (unsigned int)reg < 16 ) {
     assert( reg >= 0 && reg < 16 );
     ym->shadow.index[reg] = val;
-    if (ym->event_ptr >= event_end)
+    if (ym_event_push(ym, ymcycle, reg, val))
       ++ym->event_ovf;
-    else {
-      ym->event_ptr->ymcycle = ymcycle;
-      ym->event_ptr->reg = reg;
-      ym->event_ptr->val = val;
-      ++ym->event_ptr;
-    }
   }
 }
 
 
+/* ,-----------------------------------------------------------------.
+ * |                      Write access queue                         |
+ * `-----------------------------------------------------------------'
+ */
+
+int ym_event_push(ym_t * const ym, const cycle68_t ymcycle,
+                  const int reg, const int val)
+{
+  ym_evchunk_t * chk = ym->event_tail;
+  ym_event_t * event;
+
+  if (chk->cnt == YM_EVENT_CHUNK) {
+    /* Tail chunk is full: append a recycled or a new one. */
+    if (ym->event_cnt >= YM_EVENT_MAX)
+      return -1;
+    if (chk = ym->event_pool, chk)
+      ym->event_pool = chk->next;
+    else if (chk = emu68_alloc(sizeof(*chk)), !chk)
+      return -1;
+    chk->next = 0;
+    chk->cnt  = 0;
+    ym->event_tail->next = chk;
+    ym->event_tail = chk;
+  }
+  event = chk->evt + chk->cnt++;
+  event->ymcycle = ymcycle;
+  event->reg = reg;
+  event->val = val;
+  ++ym->event_cnt;
+  return 0;
+}
+
+void ym_event_flush(ym_t * const ym)
+{
+  ym_evchunk_t * const head = ym->event_head;
+
+  /* Move all but the built-in chunk to the pool. */
+  if (head->next) {
+    ym->event_tail->next = ym->event_pool;
+    ym->event_pool = head->next;
+    head->next = 0;
+  }
+  head->cnt = 0;
+  ym->event_tail = head;
+  ym->event_cnt = 0;
+}
+
+/* Release allocated chunks. */
+static void event_free(ym_t * const ym)
+{
+  ym_evchunk_t * chk, * next;
+
+  ym_event_flush(ym);
+  for (chk = ym->event_pool; chk; chk = next) {
+    next = chk->next;
+    emu68_free(chk);
+  }
+  ym->event_pool = 0;
+}
+
+
 /* ,-----------------------------------------------------------------.
  * |                  Adjust YM-2149 cycle counters                  |
  * `-----------------------------------------------------------------'
@@ -298,15 +374,16 @@ void ym_writereg(ym_t * const ym,
 void ym_adjust_cycle(ym_t * const ym, const cycle68_t ymcycles)
 {
   if (ym && ymcycles) {
+    ym_eviter_t it;
     ym_event_t * event;
 
     /* Should not be run before events have been flushed or
      * processed. It's not really an error, but with the current
      * implementation it should not be happening. */
-    assert(ym->event_ptr == ym->event_buf);
+    assert(!ym->event_cnt);
 
     /* Do the job anyway */
-    for (event = ym->event_buf; event < ym->event_ptr; ++event) {
+    for (event = ym_event_first(ym,&it); event; event = ym_event_next(&it)) {
       assert(event->ymcycle >= ymcycles);
       event->ymcycle -= ymcycles;
     }
@@ -314,6 +391,70 @@ void ym_adjust_cycle(ym_t * const ym, const cycle68_t ymcycles)
 }
 
 
+/* ,-----------------------------------------------------------------.
+ * |                    Save/Restore YM-2149 state                   |
+ * `-----------------------------------------------------------------'
+ */
+
+/* Snapshot layout is the ym_t struct without the event queue (and
+ * the engine allocations that follow it) followed by the pending
+ * events if any. */
+#define YM_SNAP_HEAD offsetof(ym_t,event_head)
+#define YM_SNAP_TAIL (sizeof(ym_t)-offsetof(ym_t,outbuf))
+
+int ym_save(const ym_t * const ym, void * const data, const int max)
+{
+  const int nevt = ym->event_cnt;
+  const int size =
+    (int)(YM_SNAP_HEAD + YM_SNAP_TAIL + nevt * sizeof(ym_event_t));
+
+  if (data) {
+    u8 * ptr = data;
+    const ym_evchunk_t * chk;
+    if (max < size)
+      return -1;
+    memcpy(ptr, ym, YM_SNAP_HEAD);
+    ptr += YM_SNAP_HEAD;
+    memcpy(ptr, &ym->outbuf, YM_SNAP_TAIL);
+    ptr += YM_SNAP_TAIL;
+    for (chk = ym->event_head; chk; chk = chk->next) {
+      memcpy(ptr, chk->evt, chk->cnt * sizeof(ym_event_t));
+      ptr += chk->cnt * sizeof(ym_event_t);
+    }
+  }
+  return size;
+}
+
+int ym_restore(ym_t * const ym, const void * const data, const int len)
+{
+  const u8 * ptr = data;
+  uint_t voice_mute;
+  ym_event_t event;
+  int i;
+  const int nevt =
+    (len - (int)(YM_SNAP_HEAD + YM_SNAP_TAIL)) / (int)sizeof(ym_event_t);
+
+  if (!data || nevt < 0 || nevt > YM_EVENT_MAX ||
+      len != (int)(YM_SNAP_HEAD + YM_SNAP_TAIL + nevt * sizeof(ym_event_t)))
+    return -1;
+
+  voice_mute = ym->voice_mute;        /* user setting, not a state */
+  memcpy(ym, ptr, YM_SNAP_HEAD);
+  ym->voice_mute = voice_mute;
+  ptr += YM_SNAP_HEAD;
+  memcpy(&ym->outbuf, ptr, YM_SNAP_TAIL);
+  ptr += YM_SNAP_TAIL;
+  ym_event_flush(ym);
+  for (i = 0; i < nevt; ++i, ptr += sizeof(event)) {
+    memcpy(&event, ptr, sizeof(event));
+    if (ym_event_push(ym, event.ymcycle, event.reg, event.val))
+      return -1;
+  }
+  ym->outbuf = ym->outptr = 0;
+  return 0;
+}
+
+
 /* ,-----------------------------------------------------------------.
  * |                  Yamaha get activated voices                    |
  * `-----------------------------------------------------------------'
@@ -549,12 +690,21 @@ int ym_setup(ym_t * const ym, ym_parms_t * const parms)
           p->engine,p->hz,p->clock,256);
 
   if (ym) {
+    /* Empty event queue with only the built-in chunk */
+    ym->event_head  = ym->event_tail = &ym->event_chunk;
+    ym->event_pool  = 0;
+    ym->event_chunk.next = 0;
+    ym->event_chunk.cnt  = 0;
+    ym->event_cnt   = 0;
+    ym->event_ovf   = 0;
+
     ym->ymout5      = ymout5;
     ym->clock       = p->clock;
     ym->voice_mute  = ym_smsk_table[7 & ym_default_chans];
     /* clearing sampling rate callback ensure requested rate to be in
        valid range. */
     ym->cb_sampling_rate = 0;
+    ym->cb_skip          = 0;
     ym_sampling_rate(ym, p->hz);
     ym->engine = p->engine;
 
@@ -603,6 +753,7 @@ void ym_cleanup(ym_t * const ym)
     }
     if (ym->cb_cleanup)
       ym->cb_cleanup(ym);
+    event_free(ym);
   }
 }
 
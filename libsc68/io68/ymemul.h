@@ -75,6 +75,39 @@ struct ym_event_s
  */
 typedef struct ym_event_s ym_event_t;
 
+enum {
+  YM_EVENT_CHUNK = 512,       /**< Number of events per chunk.   */
+  YM_EVENT_MAX   = 1<<20      /**< Maximum number of queued events. */
+};
+
+/**
+ * YM write access chunk type.
+ */
+typedef struct ym_evchunk_s ym_evchunk_t;
+
+/**
+ * YM write access chunk.
+ *
+ *   Events are queued in a list of fixed size chunks. The queue grows
+ *   by appending chunks so that events are never moved. Chunks are
+ *   recycled into a pool when the queue is flushed.
+ */
+struct ym_evchunk_s
+{
+  ym_evchunk_t * next;              /**< Next chunk (queue or pool). */
+  int            cnt;               /**< Number of events in chunk.  */
+  ym_event_t     evt[YM_EVENT_CHUNK]; /**< Events.                   */
+};
+
+/**
+ * YM write access queue iterator.
+ */
+typedef struct {
+  const ym_evchunk_t * chk;         /**< Current chunk.              */
+  ym_event_t * ptr;                 /**< Current event.              */
+  ym_event_t * end;                 /**< End of current chunk.       */
+} ym_eviter_t;
+
 /**
  * @}
  */
@@ -155,6 +188,7 @@ enum ym_clock_e {
  */
 typedef struct ym_s ym_t;
 
+#include "resample.h" /* resampler used by ym engines.         */
 #include "ym_puls.h" /* data structure for puls ym emulator. */
 #include "ym_blep.h" /* data structure for blep ym emulator.  */
 #include "ym_dump.h" /* data structure for dump ym emulator.  */
@@ -173,6 +207,7 @@ struct ym_s {
   int  (*cb_run)           (ym_t * const, s32 *, const cycle68_t);
   int  (*cb_buffersize)    (const ym_t *, const cycle68_t);
   int  (*cb_sampling_rate) (ym_t * const, const int);
+  int  (*cb_skip)          (ym_t * const, const cycle68_t);
   /**
    * @}
    */
@@ -194,12 +229,24 @@ struct ym_s {
   uint68_t clock;             /**< Master clock frequency in Hz.         */
 
   /**
-   * @name  Events (Write access) storage.
+   * @name  Events (Write access) queue (not part of snapshots).
    * @{
    */
-  ym_event_t  *event_ptr;       /**< Current number of entry in event. */
-  unsigned int event_ovf;       /**< count overflows.                  */
-  ym_event_t   event_buf[1600]; /**< Pre-allocated YM memory access.   */
+  ym_evchunk_t * event_head;  /**< First chunk (always event_chunk).   */
+  ym_evchunk_t * event_tail;  /**< Last chunk (the one being filled).  */
+  ym_evchunk_t * event_pool;  /**< Recycled chunks.                    */
+  unsigned int   event_cnt;   /**< Number of queued events.            */
+  unsigned int   event_ovf;   /**< count overflows.                    */
+  ym_evchunk_t   event_chunk; /**< Built-in first chunk.               */
+  /**
+   * @}
+   */
+
+  /**
+   * @name  Engine allocations (not part of snapshots)
+   * @{
+   */
+  resample_bank_t * resample; /**< Resampler filter bank.                */
   /**
    * @}
    */
@@ -356,6 +403,26 @@ IO68_EXTERN
  */
 int ym_run(ym_t * const ym, s32 * output, const cycle68_t ymcycles);
 
+IO68_EXTERN
+/**
+ * Execute Yamaha-2149 emulation without generating sound.
+ *
+ *   The ym_skip() function is the audio-less version of ym_run(). It
+ *   applies pending register writes and advances tone, noise and
+ *   envelope generators as ym_run() would, but skips the sample
+ *   generation, filter and resampling stages. Filter states are not
+ *   updated.
+ *
+ * @param  ym        YM-2149 emulator instance.
+ * @param  ymcycles  Number of cycle to skip.
+ *
+ * @return Number of PCM ym_run() would have produced.
+ * @retval -1  Failure
+ *
+ * @see ym_run()
+ */
+int ym_skip(ym_t * const ym, const cycle68_t ymcycles);
+
 
 IO68_EXTERN
 /**
@@ -391,6 +458,124 @@ IO68_EXTERN
  */
 void ym_adjust_cycle(ym_t * const ym, const cycle68_t ymcycles);
 
+IO68_EXTERN
+/**
+ * Save YM-2149 emulator state.
+ *
+ *   The ym_save() function copies the emulator state including
+ *   pending register write events into a memory buffer.
+ *
+ * @param  ym    YM-2149 emulator instance.
+ * @param  data  destination buffer (0 to query the required size).
+ * @param  max   destination buffer size.
+ *
+ * @return Number of bytes of the saved state.
+ * @retval -1  buffer is too small.
+ */
+int ym_save(const ym_t * const ym, void * const data, const int max);
+
+IO68_EXTERN
+/**
+ * Restore YM-2149 emulator state.
+ *
+ * @param  ym    YM-2149 emulator instance.
+ * @param  data  state previously saved by ym_save().
+ * @param  len   state size.
+ *
+ * @return error-code
+ * @retval  0  Success
+ * @retval -1  Failure (invalid state)
+ */
+int ym_restore(ym_t * const ym, const void * const data, const int len);
+
+/**
+ * @}
+ */
+
+
+/**
+ * @name  YM-2149 write access queue
+ * @{
+ */
+
+IO68_EXTERN
+/**
+ * Queue a write access event.
+ *
+ *   Events must be queued by increasing cycle. The queue grows as
+ *   needed up to YM_EVENT_MAX events.
+ *
+ * @param  ym       YM-2149 emulator instance.
+ * @param  ymcycle  YM cycle this access has occurred.
+ * @param  reg      Register.
+ * @param  val      Value.
+ *
+ * @return error-code
+ * @retval  0  Success
+ * @retval -1  Failure (queue full or allocation failure)
+ */
+int ym_event_push(ym_t * const ym, const cycle68_t ymcycle,
+                  const int reg, const int val);
+
+IO68_EXTERN
+/**
+ * Empty the write access queue.
+ *
+ *   Chunks are kept in a pool for the next passes.
+ *
+ * @param  ym  YM-2149 emulator instance.
+ */
+void ym_event_flush(ym_t * const ym);
+
+/** Skip empty chunks. */
+static inline ym_event_t * ym_event_seek(ym_eviter_t * const it)
+{
+  while (it->ptr == it->end) {
+    if (it->chk = it->chk->next, !it->chk)
+      return 0;
+    it->ptr = (ym_event_t *) it->chk->evt;
+    it->end = it->ptr + it->chk->cnt;
+  }
+  return it->ptr;
+}
+
+/**
+ * Get the first queued event.
+ *
+ *   Queued events are walked with:
+ *   @code
+ *   for (e = ym_event_first(ym, &it); e; e = ym_event_next(&it)) ...
+ *   @endcode
+ *
+ * @param  ym  YM-2149 emulator instance.
+ * @param  it  iterator.
+ *
+ * @return first event
+ * @retval 0 queue is empty
+ */
+static inline
+ym_event_t * ym_event_first(ym_t * const ym, ym_eviter_t * const it)
+{
+  it->chk = ym->event_head;
+  it->ptr = ym->event_head->evt;
+  it->end = it->ptr + ym->event_head->cnt;
+  return ym_event_seek(it);
+}
+
+/**
+ * Get the next queued event.
+ *
+ * @param  it  iterator.
+ *
+ * @return next event
+ * @retval 0 no more event
+ */
+static inline ym_event_t * ym_event_next(ym_eviter_t * const it)
+{
+  ++it->ptr;
+  return ym_event_seek(it);
+}
+
 /**
  * @}
  */
@@ -55,6 +55,44 @@
  * @}
  */
 
+/**
+ * Mixer kernels instruction set.
+ */
+enum mixer68_isa_e {
+  MIXER68_ISA_QUERY = -2,   /**< Get current instruction set.         */
+  MIXER68_ISA_AUTO  = -1,   /**< Best available instruction set.      */
+  MIXER68_ISA_C     =  0,   /**< Portable C (reference).              */
+  MIXER68_ISA_SSE2,         /**< x86 SSE2.                            */
+  MIXER68_ISA_NEON,         /**< ARM NEON.                            */
+  MIXER68_ISA_AVX2,         /**< x86 AVX2.                            */
+  MIXER68_ISA_LAST = MIXER68_ISA_AVX2 /**< Last instruction set.      */
+};
+
+MIXER68_API
+/**
+ * Select the mixer kernels.
+ *
+ *   All kernels produce the exact same PCM. The selection is global
+ *   and should be done once before any mixing happens (sc68_init()
+ *   selects MIXER68_ISA_AUTO).
+ *
+ * @param  isa  @ref mixer68_isa_e "instruction set"
+ *
+ * @return selected instruction set
+ * @retval -1  instruction set not available on this host
+ */
+int mixer68_select(int isa);
+
+MIXER68_API
+/**
+ * Get instruction set name.
+ *
+ * @param  isa  @ref mixer68_isa_e "instruction set"
+ * @return instruction set name
+ * @retval 0  invalid instruction set
+ */
+const char * mixer68_isa_name(const int isa);
+
 MIXER68_API
 /**
  * Copy 16-bit-stereo PCM with optionnal sign change.
@@ -100,6 +138,28 @@ MIXER68_API
 void mixer68_stereo_FL_LR(float * dst, u32 * src, int nb,
                           const u32 sign, const float norm);
 
+MIXER68_API
+/**
+ * Copy 16-bit-stereo PCM into normalized float-stereo with L/R
+ * blending.
+ *
+ *   Blending is done on float values so that the result does not go
+ *   through an intermediate 16-bit stage. With a null factor it is
+ *   equivalent to mixer68_stereo_FL_LR().
+ *
+ * @note     Sign change occurs before float transformation.
+ * @warning  PCM are assumed to be signed after sign transform.
+ *
+ * @param  dst     Destination PCM buffer (2*nb floats).
+ * @param  src     Source PCM buffer.
+ * @param  nb      Number of PCM
+ * @param  factor  Blending factor from [0..65536] (see mixer68_blend_LR()).
+ * @param  sign    Sign transformation.
+ * @param  norm    float absolute range (normalization).
+ */
+void mixer68_blend_FL_LR(float * dst, u32 * src, int nb, int factor,
+                         const u32 sign, const float norm);
+
 MIXER68_API
 /**
  * Copy left channel of 16-bit stereo PCM into L/R channels with
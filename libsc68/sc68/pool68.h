@@ -0,0 +1,99 @@
+/**
+ * @ingroup   lib_sc68
+ * @file      sc68/pool68.h
+ * @brief     worker thread pool.
+ * @author    Benjamin Gerard
+ * @date      2016/04/02
+ */
+
+/* Copyright (c) 1998-2016 Benjamin Gerard */
+
+#ifndef SC68_POOL68_H
+#define SC68_POOL68_H
+
+#ifndef POOL68_API
+# ifdef SC68_EXTERN
+#  define POOL68_API SC68_EXTERN
+# elif defined(__cplusplus)
+#  define POOL68_API extern "C"
+# else
+#  define POOL68_API
+# endif
+#endif
+
+/**
+ *  @defgroup  lib_sc68_pool  Worker thread pool
+ *  @ingroup   lib_sc68
+ *
+ *  A process-wide pool of worker threads running a batch of
+ *  independent jobs.
+ *
+ *  Jobs are split in as many contiguous ranges as there are threads.
+ *  Each thread runs the jobs of its own range first then steals jobs
+ *  from the other ranges. As long as a batch is the same the same
+ *  thread usually runs the same jobs, which keeps their data in the
+ *  same CPU caches. Workers are pinned to a CPU where supported.
+ *
+ *  The calling thread takes part in the batch. Without thread
+ *  support the jobs simply run in the calling thread.
+ *
+ *  @{
+ */
+
+/**
+ * Job function.
+ *
+ * @param  cookie  user data given to pool68_run()
+ * @param  job     job index [0..cnt-1]
+ */
+typedef void (*pool68_job_t)(void * cookie, int job);
+
+POOL68_API
+/**
+ * Set the number of threads.
+ *
+ *   The pool is (re)created the next time pool68_run() is called.
+ *
+ * @param  n  number of threads including the caller (0:one per CPU)
+ *
+ * @return number of threads that will be used
+ */
+int pool68_threads(int n);
+
+POOL68_API
+/**
+ * Set whether worker threads are pinned to CPUs.
+ *
+ *   Workers are pinned to the CPUs the calling thread is allowed to
+ *   run on. The caller itself is never pinned. The pool is
+ *   (re)created the next time pool68_run() is called.
+ *
+ * @param  pin  pin workers (0:no)
+ *
+ * @return 1 if workers will be pinned
+ */
+int pool68_pin(int pin);
+
+POOL68_API
+/**
+ * Run a batch of jobs and wait for all of them to complete.
+ *
+ *   Concurrent calls are serialized.
+ *
+ * @param  fct     job function
+ * @param  cookie  user data passed to every job
+ * @param  cnt     number of jobs
+ */
+void pool68_run(pool68_job_t fct, void * cookie, int cnt);
+
+POOL68_API
+/**
+ * Stop all worker threads.
+ */
+void pool68_shutdown(void);
+
+/**
+ *  @}
+ */
+
+#endif
@@ -267,7 +267,7 @@ enum sc68_play_e {
  */
 enum sc68_pcm_e {
   SC68_PCM_S16 = 1,               /**< Native 16bit signed.  */
-  SC68_PCM_F32 = 2                /**< native 32bit float.   */
+  SC68_PCM_F32 = 2                /**< Native 32bit float [-1..1]. */
 };
 
 /**
@@ -282,6 +282,54 @@ enum sc68_asid_e {
   SC68_ASID_NO_C  = 16,       /**< Disable ASIDifier for channel C. */
 };
 
+/**
+ * Performance counter stages.
+ */
+enum sc68_perf_e {
+  SC68_PERF_PLAY = 0,         /**< 68K play routine.                */
+  SC68_PERF_IRQ,              /**< 68K interrupt loop.              */
+  SC68_PERF_YM,               /**< YM generation and filters.       */
+  SC68_PERF_MIX,              /**< MicroWire, Paula and mixer.      */
+  SC68_PERF_COPY,             /**< Copy/convert to the PCM buffer.  */
+  SC68_PERF_STAGES            /**< Number of stages.                */
+};
+
+/**
+ * Performance counters.
+ *
+ *   Counters are opt-in and per instance:
+ *
+ *   - sc68_cntl(sc68, SC68_SET_PERF, int on) enables (and resets)
+ *     or disables the counters.
+ *   - sc68_cntl(sc68, SC68_GET_PERF, sc68_perf_t * perf) gets the
+ *     cumulative counters since they were enabled.
+ *   - sc68_cntl(sc68, SC68_SET_PERF_CB, sc68_perf_cb_t fct, void *
+ *     cookie) sets a function called at the end of each pass with
+ *     the counters of this pass only (0 to remove).
+ *
+ *   The copy stage of a pass sample is the time spent copying PCM
+ *   since the previous pass.
+ */
+typedef struct {
+  unsigned int passes;          /**< Number of passes.                */
+  unsigned int pcm;             /**< Number of PCM rendered.          */
+  unsigned long long cycles;    /**< 68K cycles emulated.             */
+  unsigned long long insts;     /**< 68K instructions executed.       */
+  unsigned long long irqs;      /**< 68K interruptions taken.         */
+  unsigned long long ymevents;  /**< YM register writes rendered.     */
+  unsigned long long ns[SC68_PERF_STAGES]; /**< Wall time per stage.  */
+} sc68_perf_t;
+
+/**
+ * Per-pass performance counters callback.
+ *
+ * @param  sc68    sc68 instance.
+ * @param  pass    counters of the pass that just finished.
+ * @param  cookie  user data given with SC68_SET_PERF_CB.
+ */
+typedef void (*sc68_perf_cb_t)(sc68_t * sc68, const sc68_perf_t * pass,
+                               void * cookie);
+
 /**
  * sc68_cntl() op parameter.
  */
@@ -305,7 +353,7 @@ enum sc68_cntl_e {
   SC68_GET_POS,      /**< Get track position (ms).  */
   SC68_GET_DSKPOS,   /**< Get disk position (ms).   */
   SC68_GET_PLAYPOS,  /**< Get play position (ms).   */
-  SC68_SET_POS,      /**< Set position.             */
+  SC68_SET_POS,      /**< Set track position (ms).  */
   SC68_GET_PCM,      /**< Get PCM format            */
   SC68_SET_PCM,      /**< Set PCM format            */
   SC68_CAN_ASID,     /**< Get aSID caps             */
@@ -321,6 +369,9 @@ enum sc68_cntl_e {
   SC68_SET_OPT_STR,  /**< Set options (string).     */
   SC68_SET_OPT_INT,  /**< Set options (integer).    */
   SC68_DIAL,         /**< Run a dialog.             */
+  SC68_GET_PERF,     /**< Get performance counters. */
+  SC68_SET_PERF,     /**< Enable/reset counters.    */
+  SC68_SET_PERF_CB,  /**< Set per-pass callback.    */
 
   /* Always last */
   SC68_CNTL_LAST     /**< Last command #.           */
@@ -434,8 +485,13 @@ SC68_API
  *   the next one is automatically loaded. The function returns status
  *   value that report events that have occured during this pass.
  *
+ *   The PCM format is selected with SC68_SET_PCM. SC68_PCM_S16 is
+ *   packed 16-bit stereo (4 bytes per PCM). SC68_PCM_F32 is
+ *   interleaved float stereo (8 bytes per PCM) converted directly
+ *   from the emulator buffer.
+ *
  * @param  sc68  sc68 instance.
- * @param  buf   PCM buffer (must be at least 4*n bytes).
+ * @param  buf   PCM buffer (at least 4*n bytes, 8*n for SC68_PCM_F32).
  * @param  n     Pointer to number of PCM sample to fill.
  *
  * @return Process status
@@ -443,6 +499,62 @@ SC68_API
  */
 int sc68_process(sc68_t * sc68, void * buf, int * n);
 
+/**
+ * One instance of a sc68_process_many() batch.
+ */
+typedef struct {
+  sc68_t * sc68;         /**< sc68 instance.                     */
+  void   * buf;          /**< PCM buffer (see sc68_process()).   */
+  int      n;            /**< in: PCM to fill, out: PCM filled.  */
+  int      ret;          /**< out: sc68_process() status.        */
+} sc68_batch_t;
+
+SC68_API
+/**
+ * Fill the PCM buffers of several instances.
+ *
+ *   The sc68_process_many() function runs sc68_process() for every
+ *   instance of the batch on the library worker threads and returns
+ *   once all of them are done. Giving the same number of PCM to all
+ *   instances renders them all up to the same deadline.
+ *
+ *   Instances are distributed over the threads the same way as long
+ *   as the batch is the same; idle threads steal pending instances
+ *   from busy ones. The number of threads is set by the
+ *   "sc68-threads" option (0: one per CPU). Workers are pinned to
+ *   the CPUs the process may run on only if the "sc68-threads-pin"
+ *   option is set.
+ *
+ *   An instance must not appear twice in a batch nor be used by
+ *   another thread during the call.
+ *
+ * @param  batch  instances, buffers and PCM counts.
+ * @param  cnt    number of instances in the batch.
+ *
+ * @return number of instances that failed (status is SC68_ERROR).
+ * @retval -1 invalid parameters.
+ */
+int sc68_process_many(sc68_batch_t * batch, int cnt);
+
+SC68_API
+/**
+ * Advance playback without generating sound.
+ *
+ *   The sc68_skip() function behaves like sc68_process() except that
+ *   it does not produce PCM. The 68K and the sound chip registers are
+ *   emulated as usual but the sound generators, filters, resamplers
+ *   and mixers are skipped as much as possible. It is much faster
+ *   than sc68_process() for fast-forwarding or measuring a track.
+ *
+ * @param  sc68  sc68 instance.
+ * @param  ms    Number of milliseconds to skip.
+ *
+ * @return Process status
+ *
+ * @see sc68_process()
+ */
+int sc68_skip(sc68_t * sc68, int ms);
+
 SC68_API
 /**
  * Set/Get current track.
@@ -575,6 +687,103 @@ int sc68_tag_enum(sc68_t * sc68, sc68_tag_t * tag,
  */
 
 
+/**
+ * @name Producer thread functions.
+ *
+ *   A stream renders an instance ahead in its own thread into a
+ *   single-producer/single-consumer PCM ring. The consumer (usually
+ *   an audio callback) pulls PCM with sc68_stream_read() which never
+ *   blocks nor takes a lock.
+ *
+ *   While a stream exists the instance belongs to the producer
+ *   thread. Control functions (sc68_play(), sc68_cntl() ...) must be
+ *   called between sc68_stream_lock() and sc68_stream_unlock().
+ *
+ *   Streams need thread support; sc68_stream_create() fails
+ *   otherwise.
+ *
+ * @{
+ */
+
+/** Stream type. */
+typedef struct sc68_stream_s sc68_stream_t;
+
+SC68_API
+/**
+ * Create a stream and start its producer thread.
+ *
+ *   The PCM format and the sampling rate are the ones of the instance
+ *   at creation time.
+ *
+ * @param  sc68  sc68 instance with a track to play.
+ * @param  pcm   ring size in PCM (rounded up to a power of 2).
+ *
+ * @return stream
+ * @retval 0 on error
+ */
+sc68_stream_t * sc68_stream_create(sc68_t * sc68, int pcm);
+
+SC68_API
+/**
+ * Stop the producer thread and destroy a stream.
+ *
+ *   The instance is released to the caller.
+ *
+ * @param  stream  stream to destroy.
+ */
+void sc68_stream_destroy(sc68_stream_t * stream);
+
+SC68_API
+/**
+ * Pull PCM from a stream (wait-free).
+ *
+ * @param  stream  stream.
+ * @param  buf     PCM buffer (see sc68_process()).
+ * @param  n       in: number of PCM to read, out: number of PCM read.
+ *
+ * @return status
+ * @retval 0           all PCM read.
+ * @retval SC68_IDLE   underrun; less PCM than requested.
+ * @retval SC68_END    the producer has reached the end and the ring
+ *                     is empty.
+ * @retval SC68_ERROR  the producer has failed and the ring is empty.
+ */
+int sc68_stream_read(sc68_stream_t * stream, void * buf, int * n);
+
+SC68_API
+/**
+ * Suspend the producer to control the instance.
+ *
+ *   Waits for the producer to finish the PCM it is rendering. Must
+ *   not be called from the consumer realtime thread.
+ *
+ * @param  stream  stream.
+ *
+ * @return the stream instance
+ */
+sc68_t * sc68_stream_lock(sc68_stream_t * stream);
+
+SC68_API
+/**
+ * Resume the producer.
+ *
+ *   Once the instance has been changed (new track, seek ...) the PCM
+ *   already in the ring are usually obsolete. The flush parameter
+ *   makes the consumer skip them on its next read.
+ *
+ *   The PCM format (SC68_SET_PCM) must not be changed while the
+ *   stream exists; if it has been the stream stops with SC68_ERROR.
+ *
+ * @param  stream  stream.
+ * @param  flush   drop PCM already rendered.
+ */
+void sc68_stream_unlock(sc68_stream_t * stream, int flush);
+
+/**
+ * @}
+ */
+
+
 /**
  * @name File functions.
  * @{
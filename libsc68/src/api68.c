@@ -34,6 +34,7 @@
 #include "sc68.h"
 #include "mixer68.h"
 #include "conf68.h"
+#include "pool68.h"
 #include "dial68/dial68.h"
 
 #ifndef HAVE_BASENAME
@@ -44,6 +45,8 @@
 #include "emu68/emu68.h"
 #include "emu68/excep68.h"
 #include "emu68/ioplug68.h"
+#include "emu68/snap68.h"
+#include "emu68/memimg68.h"
 #include "io68/io68.h"
 
 /* file68 includes */
@@ -66,6 +69,16 @@
 #include <libgen.h>
 #endif
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#if defined(HAVE_CLOCK_GETTIME)
+#include <time.h>
+#elif defined(HAVE_GETTIMEOFDAY)
+#include <sys/time.h>
+#endif
+
 #define MK4CC(A,B,C,D) (((int)(A)<<24)|((int)(B)<<16)|((int)(C)<<8)|((int)(D)))
 
 
@@ -102,6 +115,14 @@ enum {
   CFG_LOOP_OFF = 0,
   /* Option "force-loop" infinite */
   CFG_LOOP_INF = -1,
+  /* Time between two seek points (in ms) */
+  SEEK_PERIOD_MS = 5000,
+  /* Maximum number of seek points per track */
+  SEEK_MAX_POINTS = 1024,
+  /* Maximum number of shared post-init memory images */
+  MEMSHARE_MAX = 16,
+  /* Maximum number of post-init snapshots per instance */
+  INITPT_MAX = 4,
 };
 
 /* Hardware table */
@@ -151,6 +172,22 @@ static struct {
   int spr;
 } config;
 
+/** Seek point; emulators snapshot taken before running a pass. */
+typedef struct {
+  emu68_snap_t * snap;        /**< Emulators snapshot.                   */
+  unsigned int   loop_count;  /**< Loop counter.                         */
+  unsigned int   pass_2loop;  /**< Number of pass before next loop.      */
+} seekpt_t;
+
+/** Post-init point; emulators snapshot taken after the music init. */
+typedef struct {
+  emu68_snap_t * snap;        /**< Emulators snapshot (0:unused).        */
+  unsigned int   hash;        /**< Disk hash.                            */
+  int            track;       /**< Track number.                         */
+  int            hwflags;     /**< Track hardware flags.                 */
+  int            asid;        /**< aSID timers.                          */
+} initpt_t;
+
 /** sc68 instance. */
 struct _sc68_s {
   int            magic;       /**< magic identifier.                     */
@@ -211,6 +248,7 @@ struct _sc68_s {
   struct
   {
     unsigned int   spr;          /**< Sampling rate in hz.               */
+    int            pcmfmt;       /**< PCM format (SC68_PCM_S16/F32).     */
     u32          * buffer;       /**< Current PCM buffer.                */
     int            bufpos;       /**< Current PCM position.              */
     int            bufmax;       /**< buffer allocated size.             */
@@ -219,6 +257,7 @@ struct _sc68_s {
     int            stdlen;       /**< Default number of PCM per pass.    */
     unsigned int   cycleperpass; /**< Number of 68K cycles per pass.     */
     int            aga_blend;    /**< Amiga LR blend factor [0..65535].  */
+    int            blend;        /**< L/R blend pending in buffer.       */
 
     unsigned int   pass_count;   /**< Pass counter.                      */
     unsigned int   loop_count;   /**< Loop counter.                      */
@@ -229,6 +268,28 @@ struct _sc68_s {
 
   } mix;
 
+/** Seek points. */
+  struct {
+    seekpt_t     * pts;          /**< Seek points (one per period).      */
+    int            cnt;          /**< Number of seek points.             */
+    int            max;          /**< Allocated seek points.             */
+    unsigned int   period;       /**< Number of pass between points.     */
+  } seek;
+
+/** Post-init points (most recently used first). */
+  initpt_t         init[INITPT_MAX];
+
+/** Performance counters. */
+  struct {
+    int            on;           /**< Counters enabled.                  */
+    sc68_perf_t    total;        /**< Cumulative counters.               */
+    sc68_perf_t    pass;         /**< Counters of the current pass.      */
+    uint68_t       insts;        /**< emu68 instructions at pass start.  */
+    uint68_t       irqs;         /**< emu68 interrupts at pass start.    */
+    sc68_perf_cb_t fct;          /**< Per-pass callback (0:none).        */
+    void         * cookie;       /**< Per-pass callback user data.       */
+  } perf;
+
   sc68_minfo_t     info;         /**< Disk and track info struct.        */
 
 /* Error message */
@@ -249,6 +310,7 @@ int dial_cat = msg68_NEVER;
 static int           sc68_id;        /* counter for auto generated name */
 static volatile int  sc68_init_flag; /* Library init flag     */
 static int           sc68_spr_def = SPR_DEF;
+static int           sc68_pcm_def = SC68_PCM_S16;
 static int           dbg68k;
 static const char    not_available[] = SC68_NOFILENAME;
 static char          appname[16] = "sc68";
@@ -269,6 +331,10 @@ static int can_asid(const sc68_t * sc68, int track);
 static int get_pcm_fmt(sc68_t * sc68);
 static int set_pcm_fmt(sc68_t * sc68, int pcmfmt);
 static int get_pos(sc68_t * sc68, int origin);
+static int set_pos(sc68_t * sc68, int pos);
+static void memshare_clear(void);
+static void seek_clear(sc68_t * sc68);
+static void init_clear(sc68_t * sc68);
 static sc68_disk_t get_dt(sc68_t * sc68, int * ptr_track, sc68_disk_t disk);
 static int calc_disk_len(const disk68_t * disk, const int loop);
 static unsigned int calc_track_len(const disk68_t * d, int track, int loop);
@@ -992,6 +1058,18 @@ static void config_apply(sc68_t * sc68)
   }
 }
 
+static int onchange_threads(const option68_t *opt, value68_t * val)
+{
+  pool68_threads(val->num);
+  return 0;
+}
+
+static int onchange_pin(const option68_t *opt, value68_t * val)
+{
+  pool68_pin(val->num);
+  return 0;
+}
+
 /* HAXXX: should be eval when a message category is added/removed */
 static void eval_debug(void)
 {
@@ -1021,8 +1099,13 @@ int sc68_init(sc68_init_t * init)
   option68_t * opt;
   sc68_init_t dummy_init;
 
-  static option68_t debug_options[] = {
-    OPT68_BOOL("sc68-","dbg68k","sc68","run m68K in debug mode",0,0)
+  static option68_t local_options[] = {
+    OPT68_BOOL("sc68-","dbg68k","sc68","run m68K in debug mode",0,0),
+    OPT68_IRNG("sc68-","threads","sc68",
+               "worker threads for batch processing {0:one per CPU}",
+               0,64,0,onchange_threads),
+    OPT68_BOOL("sc68-","threads-pin","sc68",
+               "pin worker threads to the allowed CPUs",0,onchange_pin)
   };
 
   /* Just a stupid test to check if this host arythmetic unit use 2's
@@ -1079,7 +1162,7 @@ int sc68_init(sc68_init_t * init)
   initflags = init->flags;
 
   /* Add and parse local options. */
-  option68_append(debug_options,sizeof(debug_options)/sizeof(*debug_options));
+  option68_append(local_options,sizeof(local_options)/sizeof(*local_options));
   init->argc = option68_parse(init->argc, init->argv);
 
   /* Initialize emulators. */
@@ -1096,6 +1179,10 @@ int sc68_init(sc68_init_t * init)
   /* Set default sampling rate. */
   set_spr(0, SC68_SPR_DEFAULT);
 
+  /* Select mixer kernels for this CPU. */
+  sc68_debug(0,"libsc68: mixer kernels -- *%s*\n",
+             mixer68_isa_name(mixer68_select(MIXER68_ISA_AUTO)));
+
   opt    = option68_get("dbg68k", opt68_ISSET);
   dbg68k = opt ? opt->val.num : 0;
 
@@ -1120,6 +1207,8 @@ void sc68_shutdown(void)
 
   if (sc68_init_flag) {
     sc68_init_flag = 0;
+    memshare_clear();
+    pool68_shutdown();
     file68_shutdown();
     config68_shutdown();          /* always after file68_shutdown() */
   }
@@ -1168,6 +1257,7 @@ sc68_t * sc68_create(sc68_create_t * create)
   if (!sc68->mix.spr) {
     sc68->mix.spr = sc68_spr_def;
   }
+  sc68->mix.pcmfmt = sc68_pcm_def;
   if (!sc68->time.def_ms) {
     sc68->time.def_ms = TIME_DEF * 1000;
   }
@@ -1257,6 +1347,8 @@ static int set_spr(sc68_t * sc68, int hz)
       hz = mwio_sampling_rate(sc68->mwio, hz);
       hz = paulaio_sampling_rate(sc68->paulaio, hz);
       sc68->mix.spr = hz;
+      seek_clear(sc68);             /* snapshots have the old rate */
+      init_clear(sc68);
     } else {
       sc68_spr_def = hz;
     }
@@ -1266,12 +1358,25 @@ static int set_spr(sc68_t * sc68, int hz)
 
 static int get_pcm_fmt(sc68_t * sc68)
 {
-  return SC68_PCM_S16;
+  return sc68 ? sc68->mix.pcmfmt : sc68_pcm_def;
 }
 
 static int set_pcm_fmt(sc68_t * sc68, int pcmfmt)
 {
-  return -(pcmfmt != SC68_PCM_S16);
+  if (pcmfmt != SC68_PCM_S16 && pcmfmt != SC68_PCM_F32)
+    return -1;
+  if (sc68) {
+    /* Apply the blend still pending in the buffer. */
+    if (pcmfmt == SC68_PCM_S16 && sc68->mix.blend) {
+      mixer68_blend_LR(sc68->mix.buffer+sc68->mix.bufpos,
+                       sc68->mix.buffer+sc68->mix.bufpos,
+                       sc68->mix.buflen, sc68->mix.blend, 0, 0);
+      sc68->mix.blend = 0;
+    }
+    sc68->mix.pcmfmt = pcmfmt;
+  } else
+    sc68_pcm_def = pcmfmt;
+  return 0;
 }
 
 static int get_asid(const sc68_t * sc68)
@@ -1357,6 +1462,8 @@ static void stop_track(sc68_t * sc68, const int real_stop)
   sc68->mix.loop_count  = 0;
   sc68->mix.bufpos      = 0;
   sc68->mix.buflen      = 0;
+
+  seek_clear(sc68);
 }
 
 static int finish(sc68_t * sc68, addr68_t pc, int sr, uint68_t maxinst)
@@ -1421,16 +1528,8 @@ static int finish(sc68_t * sc68, addr68_t pc, int sr, uint68_t maxinst)
   return status;
 }
 
-static int reset_emulators(sc68_t * sc68, const hwflags68_t hw)
+static void plug_emulators(sc68_t * sc68, const hwflags68_t hw)
 {
-  u8 * memptr;
-  const int base = INTR_ADDR;
-  int i;
-
-  assert(sc68);
-  assert(sc68->emu68);
-  assert(hw);
-
   emu68_ioplug_unplug_all(sc68->emu68);
   emu68_mem_reset(sc68->emu68);
 
@@ -1456,6 +1555,19 @@ static int reset_emulators(sc68_t * sc68, const hwflags68_t hw)
     emu68_set_interrupt_io(sc68->emu68, sc68->mfpio);
   }
   emu68_reset(sc68->emu68);
+}
+
+static int reset_emulators(sc68_t * sc68, const hwflags68_t hw)
+{
+  u8 * memptr;
+  const int base = INTR_ADDR;
+  int i;
+
+  assert(sc68);
+  assert(sc68->emu68);
+  assert(hw);
+
+  plug_emulators(sc68, hw);
 
   /* disable that we should not need it */
   if (emu68_debugmode(sc68->emu68)) {
@@ -1530,11 +1642,27 @@ static int load_replay(sc68_t * sc68, const char * replay, int a0)
 {
   int err, size;
   vfs68_t * is;
+  const void * data;
   char rname[256];
   assert(sc68);
   assert(replay);
 
   TRACE68(sc68_cat, " -> external replay -- %s\n", replay);
+
+  /* Built-in replays are copied from the inflated replay cache. */
+  data = replay68_get(replay, &size);
+  if (data) {
+    err = emu68_memput(sc68->emu68, a0, (const u8 *) data, size);
+    replay68_put(data);
+    if (err) {
+      error_add(sc68, "libsc68: %s\n", emu68_error_get(sc68->emu68));
+      return SC68_ERROR;
+    }
+    TRACE68(sc68_cat," -> built-in replay -- [%06x-%06x]\n",
+            a0, a0+size-1);
+    return a0 + ((size + 1) & ~1);
+  }
+
   strcpy(rname,"sc68://replay/");
   strcat68(rname, replay, sizeof(rname)-1);
   rname[sizeof(rname)-1] = 0;
@@ -1636,16 +1764,255 @@ static int run_music_init(sc68_t * sc68, const music68_t * m, int a0, int a6)
   return SC68_OK;
 }
 
+/* ,-----------------------------------------------------------------.
+ * |                  Shared post-init memory images                 |
+ * `-----------------------------------------------------------------'
+ */
+
+/* Instances that played the init of the same track end up with the
+ * same memory. The first one leaves an image of it and attaches it,
+ * the next ones attach this image (copy-on-write) instead of keeping
+ * their own copy. Images are kept in a small most-recently-used list.
+ * The lock only covers the list: images are reference counted, so
+ * memory is compared and written without holding it.
+ */
+typedef struct memshare_s memshare_t;
+struct memshare_s {
+  memshare_t     * next;                /* next (less recent) image */
+  unsigned int     hash;                /* disk hash                */
+  int              track;               /* track number             */
+  int              hwflags;             /* track hardware flags     */
+  int              asid;                /* aSID timers              */
+  emu68_memimg_t * img;                 /* memory image             */
+};
+
+static memshare_t * memshare_head;
+
+#ifdef HAVE_PTHREAD_H
+static pthread_mutex_t memshare_mutex = PTHREAD_MUTEX_INITIALIZER;
+# define memshare_lock()   pthread_mutex_lock(&memshare_mutex)
+# define memshare_unlock() pthread_mutex_unlock(&memshare_mutex)
+#else
+# define memshare_lock()   (void)0
+# define memshare_unlock() (void)0
+#endif
+
+/* Find the image of a track and move it to front. Returns the list
+ * end and counts the images if there is none. The lock must be held.
+ */
+static memshare_t ** memshare_find(const sc68_t * sc68,
+                                   const music68_t * m, int track, int * cnt)
+{
+  memshare_t * ms, ** pms;
+
+  for (pms = &memshare_head; (ms = *pms) != 0; pms = &ms->next, ++*cnt)
+    if (ms->hash == sc68->disk->hash && ms->track == track &&
+        ms->hwflags == m->hwflags && ms->asid == sc68->asid_timers) {
+      *pms = ms->next;
+      ms->next = memshare_head;
+      memshare_head = ms;
+      return &memshare_head;
+    }
+  return pms;
+}
+
+static void memshare_attach(sc68_t * sc68, const music68_t * m, int track)
+{
+  memshare_t * ms, ** pms;
+  emu68_memimg_t * img;
+  int cnt = 0;
+
+  memshare_lock();
+  ms  = *memshare_find(sc68, m, track, &cnt);
+  img = ms ? memimg68_ref(ms->img) : 0;
+  memshare_unlock();
+
+  if (img) {
+    /* With the same key but another memory (hash collision ...) the
+     * instance keeps its own copy and the image stays. */
+    if (!emu68_memimg_cmp(sc68->emu68, img)) {
+      if (emu68_memimg_attach(sc68->emu68, img)) {
+        msg68_warning("libsc68: %s -- %s\n", "shared memory image",
+                      emu68_error_get(sc68->emu68));
+      } else {
+        TRACE68(sc68_cat, "libsc68: %s\n", "attached shared memory image");
+      }
+    }
+    emu68_memimg_free(img);
+    return;
+  }
+
+  img = emu68_memimg_create(sc68->emu68);
+  if (!img)
+    return;
+  if (emu68_memimg_attach(sc68->emu68, img)) {
+    msg68_warning("libsc68: %s -- %s\n", "shared memory image",
+                  emu68_error_get(sc68->emu68));
+  }
+
+  /* Another instance may have left an image meanwhile. */
+  memshare_lock();
+  cnt = 0;
+  pms = memshare_find(sc68, m, track, &cnt);
+  if (!*pms && (ms = malloc(sizeof(*ms)), ms)) {
+    ms->hash    = sc68->disk->hash;
+    ms->track   = track;
+    ms->hwflags = m->hwflags;
+    ms->asid    = sc68->asid_timers;
+    ms->img     = img;
+    ms->next    = memshare_head;
+    memshare_head = ms;
+    img = 0;
+    if (cnt >= MEMSHARE_MAX) {
+      /* Drop the least recently used */
+      memshare_t ** plast = &memshare_head;
+      while ((*plast)->next)
+        plast = &(*plast)->next;
+      emu68_memimg_free((*plast)->img);
+      free(*plast);
+      *plast = 0;
+    }
+  }
+  memshare_unlock();
+  emu68_memimg_free(img);
+}
+
+static void memshare_clear(void)
+{
+  memshare_t * ms;
+
+  memshare_lock();
+  while (ms = memshare_head, ms) {
+    memshare_head = ms->next;
+    emu68_memimg_free(ms->img);
+    free(ms);
+  }
+  memshare_unlock();
+}
+
+/* ,-----------------------------------------------------------------.
+ * |                        Post-init points                         |
+ * `-----------------------------------------------------------------'
+ */
+
+/* Restarting a track restores the emulators as they were right after
+ * the music init instead of running the whole init again. Points are
+ * kept per instance as the IO states depend on the instance settings.
+ */
+
+static void init_clear(sc68_t * sc68)
+{
+  int i;
+
+  for (i = 0; i < INITPT_MAX; ++i) {
+    emu68_snap_free(sc68->init[i].snap);
+    sc68->init[i].snap = 0;
+  }
+}
+
+static void init_record(sc68_t * sc68, const music68_t * m, int track)
+{
+  initpt_t pt;
+
+  if (emu68_debugmode(sc68->emu68))
+    return;                             /* chk memory is not saved */
+
+  pt.snap = emu68_snap_save(sc68->emu68, 0);
+  if (!pt.snap)
+    return;
+  pt.hash    = sc68->disk->hash;
+  pt.track   = track;
+  pt.hwflags = m->hwflags;
+  pt.asid    = sc68->asid_timers;
+  TRACE68(sc68_cat, "libsc68: post-init point -- *%d bytes*\n",
+          emu68_snap_size(pt.snap));
+
+  /* Drop the least recently used */
+  emu68_snap_free(sc68->init[INITPT_MAX-1].snap);
+  memmove(sc68->init+1, sc68->init, (INITPT_MAX-1) * sizeof(*sc68->init));
+  sc68->init[0] = pt;
+}
+
+static int init_restore(sc68_t * sc68, const music68_t * m, int track)
+{
+  initpt_t pt;
+  int i;
+
+  for (i = 0; i < INITPT_MAX && sc68->init[i].snap; ++i)
+    if (sc68->init[i].hash == sc68->disk->hash &&
+        sc68->init[i].track == track &&
+        sc68->init[i].hwflags == m->hwflags &&
+        sc68->init[i].asid == sc68->asid_timers)
+      break;
+  if (i == INITPT_MAX || !sc68->init[i].snap)
+    return SC68_ERROR;
+
+  /* Move to front */
+  pt = sc68->init[i];
+  memmove(sc68->init+1, sc68->init, i * sizeof(*sc68->init));
+  sc68->init[0] = pt;
+
+  plug_emulators(sc68, m->hwflags);
+  if (emu68_snap_restore(sc68->emu68, pt.snap)) {
+    msg68_warning("libsc68: %s -- %s\n", "post-init point",
+                  emu68_error_get(sc68->emu68));
+    return SC68_ERROR;
+  }
+  TRACE68(sc68_cat," -> %s\n", "restored post-init point");
+  return SC68_OK;
+}
+
+/* Run the whole init pipeline of a track. */
+static int init_music(sc68_t * sc68, const music68_t * m, int track)
+{
+  int a0, a6;
+
+  /* Reset 68K & IO */
+  if (reset_emulators(sc68, m->hwflags) != SC68_OK)
+    return SC68_ERROR;
+
+  a0 = sc68->playaddr;
+  if (sc68->asid_timers) {
+    if (a0 = load_replay(sc68, "asidifier", a0), a0 == SC68_ERROR)
+      return SC68_ERROR;
+  }
+  a6 = a0;
+
+  /* Load external replay into 68K memory. */
+  if (m->replay && (a0 = load_replay(sc68, m->replay, a0), a0 == SC68_ERROR))
+    return SC68_ERROR;
+
+  /* Copy music data into 68K memory */
+  if (emu68_memput(sc68->emu68, a0, (u8 *)m->data, m->datasz)) {
+    error_add(sc68,"libsc68: %s\n", emu68_error_get(sc68->emu68));
+    return SC68_ERROR;
+  }
+  TRACE68(sc68_cat," -> music data -- [%06x-%06x]\n", a0, a0+m->datasz-1);
+
+  /* Run music init code */
+  if ( run_music_init(sc68, m, a0, a6) == SC68_ERROR )
+    return SC68_ERROR;
+
+  /* Share the post-init memory with other instances */
+  memshare_attach(sc68, m, track);
+
+  /* Keep it for the next time */
+  init_record(sc68, m, track);
+
+  return SC68_OK;
+}
+
 static int change_track(sc68_t * sc68, int track)
 {
+  const int   seek_to = sc68->seek_to;
   const disk68_t  * d;
   const music68_t * m;
-  int         a0,a6;
   int         force_ms;
   int         loop;
 
   assert(has_track(sc68, track));
   stop_track(sc68, 0);
+  sc68->seek_to = seek_to;              /* requested for this track */
 
   loop = sc68->loop_to;
   assert(loop >= -1);
@@ -1663,12 +2030,8 @@ static int change_track(sc68_t * sc68, int track)
   }
 #endif
 
-  /* Reset 68K & IO */
-  if (reset_emulators(sc68, m->hwflags) != SC68_OK)
-    return SC68_ERROR;
-
   /* Set music replay address in 68K memory. */
-  sc68->playaddr = a0 = m->a0;
+  sc68->playaddr = m->a0;
   TRACE68(sc68_cat," -> play address -- $%06x\n", sc68->playaddr);
 
   sc68->asid_timers = aSIDifier(sc68, m);
@@ -1678,24 +2041,11 @@ static int change_track(sc68_t * sc68, int track)
             (int)(u8)(sc68->asid_timers >> 16),
             (int)(u8)(sc68->asid_timers >>  8),
             (int)(u8)(sc68->asid_timers >>  0));
-    if (a0 = load_replay(sc68, "asidifier", a0), a0 == SC68_ERROR)
-      return SC68_ERROR;
-  }
-  a6 = a0;
-
-  /* Load external replay into 68K memory. */
-  if (m->replay && (a0 = load_replay(sc68, m->replay, a0), a0 == SC68_ERROR))
-    return SC68_ERROR;
-
-  /* Copy music data into 68K memory */
-  if (emu68_memput(sc68->emu68, a0, (u8 *)m->data, m->datasz)) {
-    error_add(sc68,"libsc68: %s\n", emu68_error_get(sc68->emu68));
-    return SC68_ERROR;
   }
-  TRACE68(sc68_cat," -> music data -- [%06x-%06x]\n", a0, a0+m->datasz-1);
 
-  /* Run music init code */
-  if ( run_music_init(sc68, m, a0, a6) == SC68_ERROR )
+  /* Restore the post-init emulators or run the init */
+  if (init_restore(sc68, m, track) != SC68_OK &&
+      init_music(sc68, m, track) != SC68_OK)
     return SC68_ERROR;
 
   /* Ensure sampling rate */
@@ -1899,6 +2249,386 @@ static int apply_change_track(sc68_t * const sc68)
   return SC68_CHANGE;
 }
 
+/* ,-----------------------------------------------------------------.
+ * |                          Seek points                            |
+ * `-----------------------------------------------------------------'
+ */
+
+static void seek_clear(sc68_t * sc68)
+{
+  int i;
+
+  for (i = 0; i < sc68->seek.cnt; ++i)
+    emu68_snap_free(sc68->seek.pts[i].snap);
+  free(sc68->seek.pts);
+  sc68->seek.pts    = 0;
+  sc68->seek.cnt    = 0;
+  sc68->seek.max    = 0;
+  sc68->seek.period = 0;
+}
+
+/* Record a seek point if the current pass is the next one to be
+ * recorded. All points share their unmodified memory pages with the
+ * very first one.
+ */
+static void seek_record(sc68_t * sc68)
+{
+  seekpt_t * pt;
+
+  if (!sc68->seek.period) {
+    u64 period = SEEK_PERIOD_MS;
+    period *= sc68->emu68->clock;
+    period /= (u64) sc68->mix.cycleperpass * 1000u;
+    sc68->seek.period = period ? (unsigned int) period : 1u;
+  }
+
+  if (sc68->seek.cnt >= SEEK_MAX_POINTS ||
+      sc68->mix.pass_count != sc68->seek.cnt * sc68->seek.period)
+    return;
+
+  if (sc68->seek.cnt == sc68->seek.max) {
+    const int max = sc68->seek.max ? sc68->seek.max * 2 : 16;
+    seekpt_t * pts = realloc(sc68->seek.pts, max * sizeof(*pts));
+    if (!pts)
+      return;
+    sc68->seek.pts = pts;
+    sc68->seek.max = max;
+  }
+
+  pt = sc68->seek.pts + sc68->seek.cnt;
+  pt->snap = emu68_snap_save(sc68->emu68,
+                             sc68->seek.cnt ? sc68->seek.pts[0].snap : 0);
+  if (pt->snap) {
+    pt->loop_count = sc68->mix.loop_count;
+    pt->pass_2loop = sc68->mix.pass_2loop;
+    ++sc68->seek.cnt;
+    TRACE68(sc68_cat,
+            "libsc68: seek point #%d at pass #%u -- *%d bytes*\n",
+            sc68->seek.cnt-1, sc68->mix.pass_count,
+            emu68_snap_size(pt->snap));
+  }
+}
+
+/* ,-----------------------------------------------------------------.
+ * |                      Performance counters                       |
+ * `-----------------------------------------------------------------'
+ */
+
+/* Monotonic wall clock in nanoseconds. */
+static u64 perf_ns(void)
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (u64) ts.tv_sec * 1000000000u + ts.tv_nsec;
+#elif defined(HAVE_GETTIMEOFDAY)
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return (u64) tv.tv_sec * 1000000000u + tv.tv_usec * 1000u;
+#else
+  return 0;
+#endif
+}
+
+static int set_perf(sc68_t * sc68, int on)
+{
+  memset(&sc68->perf.total, 0, sizeof(sc68->perf.total));
+  memset(&sc68->perf.pass, 0, sizeof(sc68->perf.pass));
+  sc68->perf.on = !!on;
+  return 0;
+}
+
+/* Cumulative counters including the pending copy time. */
+static int get_perf(sc68_t * sc68, sc68_perf_t * perf)
+{
+  int i;
+
+  if (!perf)
+    return -1;
+  *perf = sc68->perf.total;
+  for (i = 0; i < SC68_PERF_STAGES; ++i)
+    perf->ns[i] += sc68->perf.pass.ns[i];
+  return 0;
+}
+
+/* Start the time of a stage; 0 when counters are disabled. */
+static inline u64 perf_start(const sc68_t * sc68)
+{
+  return sc68->perf.on ? perf_ns() : 0;
+}
+
+/* Add the time since *t to a stage and restart *t. */
+static inline void perf_lap(sc68_t * sc68, const int stage, u64 * t)
+{
+  if (sc68->perf.on) {
+    const u64 now = perf_ns();
+    sc68->perf.pass.ns[stage] += now - *t;
+    *t = now;
+  }
+}
+
+static void perf_pass_begin(sc68_t * sc68)
+{
+  if (sc68->perf.on) {
+    sc68->perf.insts = sc68->emu68->inst_cnt;
+    sc68->perf.irqs  = sc68->emu68->irq_cnt;
+  }
+}
+
+/* Complete the pass sample, accumulate and report it. */
+static void perf_pass_end(sc68_t * sc68)
+{
+  sc68_perf_t * const pass  = &sc68->perf.pass;
+  sc68_perf_t * const total = &sc68->perf.total;
+  int i;
+
+  if (!sc68->perf.on)
+    return;
+
+  pass->passes = 1;
+  pass->pcm    = sc68->mix.buflen;
+  pass->cycles = sc68->mix.cycleperpass;
+  pass->insts  = sc68->emu68->inst_cnt - sc68->perf.insts;
+  pass->irqs   = sc68->emu68->irq_cnt  - sc68->perf.irqs;
+
+  total->passes   += pass->passes;
+  total->pcm      += pass->pcm;
+  total->cycles   += pass->cycles;
+  total->insts    += pass->insts;
+  total->irqs     += pass->irqs;
+  total->ymevents += pass->ymevents;
+  for (i = 0; i < SC68_PERF_STAGES; ++i)
+    total->ns[i] += pass->ns[i];
+
+  if (sc68->perf.fct)
+    sc68->perf.fct(sc68, pass, sc68->perf.cookie);
+  memset(pass, 0, sizeof(*pass));
+}
+
+/* ,-----------------------------------------------------------------.
+ * |                          Play pass                              |
+ * `-----------------------------------------------------------------'
+ */
+
+/* Start a new pass: check for loop and end of track and apply
+ * pending track change.
+ */
+static int pass_begin(sc68_t * sc68)
+{
+  int ret = 0;
+
+  /* Checking for loop */
+  if (sc68->mix.pass_2loop && !--sc68->mix.pass_2loop) {
+    sc68->mix.pass_2loop = sc68->mix.pass_3loop;
+    sc68->mix.loop_count++;
+    ret |= SC68_LOOP;
+  }
+
+  /* Checking for end */
+  if (sc68->mix.pass_total &&
+      sc68->mix.pass_count >= sc68->mix.pass_total) {
+    int next_track = sc68->track+1;
+    sc68->track_to =
+      (sc68->disk->force_track || next_track > sc68->disk->nb_mus)
+      ? -1                        /* stop */
+      : next_track                /* next track */
+      ;
+    sc68->seek_to  = -1;
+  }
+
+  return ret | apply_change_track(sc68);
+}
+
+/* Run the 68K for one pass and fill the PCM buffer. A dry pass only
+ * advances the sound chips; the buffer content is undefined but its
+ * length is the same.
+ */
+static int pass_run(sc68_t * sc68, const int dry)
+{
+  int status;
+  u64 t;
+
+  seek_record(sc68);
+  perf_pass_begin(sc68);
+  t = perf_start(sc68);
+
+  /* setup aSID */
+  if (sc68->asid_timers)
+    emu68_poke(sc68->emu68, sc68->playaddr+17,
+               -!!(sc68->asid & SC68_ASID_ON));
+
+  /* Run 68K emulator */
+  status = finish(sc68, sc68->playaddr+8, 0x2300, PLAY_MAX_INST);
+  perf_lap(sc68, SC68_PERF_PLAY, &t);
+  if (status == EMU68_NRM) {
+    /* $$$ Fix some replays (tao's intensity 200 for one) that
+       assumes the music driver is running under interruption
+       and do not restore the SR by themself. Need to be sure
+       this does not disrupt other musics. */
+    sc68->emu68->reg.sr = 0x2300;
+    status = emu68_interrupt(sc68->emu68, sc68->mix.cycleperpass);
+    perf_lap(sc68, SC68_PERF_IRQ, &t);
+  }
+  if (status != EMU68_NRM) {
+    error_addx(sc68,
+               "libsc68: abnormal 68K status %d (%s) in play pass %u\n",
+               status, emu68_status_name(status),
+               sc68->mix.pass_count);
+    return SC68_ERROR;
+  }
+
+  /* Reset pcm pointer. */
+  sc68->mix.bufpos = 0;
+  sc68->mix.buflen = sc68->mix.bufreq;
+  sc68->mix.blend  = 0;
+
+  /* YM writes of this pass are queued until the YM runs. */
+  if (sc68->perf.on && (sc68->mus->hwflags & SC68_PSG))
+    sc68->perf.pass.ymevents = sc68->ym->event_cnt;
+
+  /* Advance sound chips without mixing */
+  if (dry) {
+    if (sc68->mus->hwflags & SC68_AGA)
+      paulaio_run(sc68->paulaio, 0, sc68->mix.buflen,
+                  sc68->mix.cycleperpass);
+    else {
+      if (sc68->mus->hwflags & SC68_PSG) {
+        int err = ymio_skip(sc68->ymio, sc68->mix.cycleperpass);
+        if (err < 0) {
+          sc68->mix.buflen = 0;
+          return SC68_ERROR;
+        }
+        sc68->mix.buflen = err;
+        perf_lap(sc68, SC68_PERF_YM, &t);
+      }
+      if (sc68->mus->hwflags & (SC68_DMA|SC68_LMC))
+        mwio_run(sc68->mwio, 0, sc68->mix.buflen, sc68->mix.cycleperpass);
+    }
+  }
+
+  /* Fill pcm buufer depending on architecture */
+  else if (sc68->mus->hwflags & SC68_AGA) {
+    /* Amiga - Paula */
+    paulaio_run(sc68->paulaio, (s32 *)sc68->mix.buffer, sc68->mix.buflen,
+                sc68->mix.cycleperpass);
+    if (sc68->mix.pcmfmt == SC68_PCM_F32)
+      /* Blended by the float conversion. */
+      sc68->mix.blend = sc68->mix.aga_blend;
+    else
+      mixer68_blend_LR(sc68->mix.buffer, sc68->mix.buffer, sc68->mix.buflen,
+                       sc68->mix.aga_blend, 0, 0);
+  } else {
+    if (sc68->mus->hwflags & SC68_PSG) {
+      int err =
+        ymio_run(sc68->ymio, (s32*)sc68->mix.buffer,
+                 sc68->mix.cycleperpass);
+      if (err < 0) {
+        sc68->mix.buflen = 0;
+        return SC68_ERROR;
+      }
+      sc68->mix.buflen = err;
+      perf_lap(sc68, SC68_PERF_YM, &t);
+    } else {
+      mixer68_fill(sc68->mix.buffer, sc68->mix.buflen=sc68->mix.bufreq, 0);
+    }
+
+    if (sc68->mus->hwflags & (SC68_DMA|SC68_LMC))
+      /* STE / MicroWire */
+      mwio_run(sc68->mwio, (s32 *)sc68->mix.buffer, sc68->mix.buflen,
+               sc68->mix.cycleperpass);
+    else
+      /* Else simply process with left channel duplication. */
+      mixer68_dup_L_to_R(sc68->mix.buffer, sc68->mix.buffer,
+                         sc68->mix.buflen, 0);
+  }
+
+  perf_lap(sc68, SC68_PERF_MIX, &t);
+  perf_pass_end(sc68);
+
+  /* Advance time */
+  calc_pos(sc68);
+  sc68->mix.pass_count++;
+
+  return SC68_OK;
+}
+
+/* Apply a pending seek request. Restore the nearest seek point before
+ * the requested position (unless playing forward from the current
+ * position is closer) then run the emulators up to the requested
+ * pass. The PCM of the pass containing the requested position are
+ * left in the buffer.
+ */
+static int seek_apply(sc68_t * sc68)
+{
+  const unsigned int ms = sc68->seek_to;
+  unsigned int target;
+  int ret = SC68_SEEK, begin = 1;
+  u64 pass;
+
+  pass  = ms;
+  pass *= sc68->emu68->clock;
+  pass /= (u64) sc68->mix.cycleperpass * 1000u;
+  target = (unsigned int) pass;
+  sc68->seek_to = -1;
+
+  if (sc68->mix.pass_total && target >= sc68->mix.pass_total)
+    target = sc68->mix.pass_total - 1;
+
+  if (sc68->seek.cnt > 0) {
+    unsigned int idx = sc68->seek.period ? target / sc68->seek.period : 0;
+    if (idx >= (unsigned int) sc68->seek.cnt)
+      idx = sc68->seek.cnt - 1;
+    if (target < sc68->mix.pass_count ||
+        idx * sc68->seek.period > sc68->mix.pass_count) {
+      const seekpt_t * const pt = sc68->seek.pts + idx;
+      if (emu68_snap_restore(sc68->emu68, pt->snap)) {
+        error_add(sc68,"libsc68: %s\n", emu68_error_get(sc68->emu68));
+        return SC68_ERROR;
+      }
+      sc68->mix.pass_count = idx * sc68->seek.period;
+      sc68->mix.loop_count = pt->loop_count;
+      sc68->mix.pass_2loop = pt->pass_2loop;
+      begin = 0;                        /* point is taken after begin */
+    }
+  }
+
+  if (target < sc68->mix.pass_count) {
+    /* No usable seek point; can't go backward. */
+    msg68_warning("libsc68: unable to seek backward -- *%u pass*\n",
+                  target);
+    return ret;
+  }
+
+  for (;;) {
+    const unsigned int count = sc68->mix.pass_count;
+
+    if (begin) {
+      ret |= pass_begin(sc68);
+      if (ret & (SC68_END|SC68_CHANGE)) /* exit on error|end|change */
+        break;
+    }
+    begin = 1;
+
+    if (pass_run(sc68, count != target) != SC68_OK)
+      return SC68_ERROR;
+    if (count == target) {
+      /* Skip PCM before the requested position in this pass. */
+      if (ms > sc68->time.elapsed_ms) {
+        u64 skip = ms - sc68->time.elapsed_ms;
+        skip = skip * sc68->mix.spr / 1000u;
+        if (skip >= (u64) sc68->mix.buflen)
+          skip = sc68->mix.buflen - 1;
+        sc68->mix.bufpos  = (int) skip;
+        sc68->mix.buflen -= (int) skip;
+      }
+      break;
+    }
+    sc68->mix.buflen = 0;               /* discard */
+  }
+
+  return ret;
+}
+
 int sc68_process(sc68_t * sc68, void * buf16st, int * _n)
 {
   int ret;
@@ -1916,112 +2646,126 @@ int sc68_process(sc68_t * sc68, void * buf16st, int * _n)
 
     while (n > 0) {
       int len;
+      u64 t;
+
+      /* Pending seek request */
+      if (sc68->seek_to >= 0 && sc68->mus && !sc68->track_to) {
+        ret |= seek_apply(sc68);
+        if (ret & (SC68_END|SC68_CHANGE)) /* exit on error|end|change */
+          break;
+        ret &= ~SC68_IDLE;              /* No more idle */
+      }
 
       /* No more pcm in internal buffer ... */
       if (!sc68->mix.buflen) {
-        int status;
-
-        /* Checking for loop */
-        if (sc68->mix.pass_2loop && !--sc68->mix.pass_2loop) {
-          sc68->mix.pass_2loop = sc68->mix.pass_3loop;
-          sc68->mix.loop_count++;
-          ret |= SC68_LOOP;
-        }
-
-        /* Checking for end */
-        if (sc68->mix.pass_total &&
-            sc68->mix.pass_count >= sc68->mix.pass_total) {
-          int next_track = sc68->track+1;
-          sc68->track_to =
-            (sc68->disk->force_track || next_track > sc68->disk->nb_mus)
-            ? -1                        /* stop */
-            : next_track                /* next track */
-            ;
-          sc68->seek_to  = -1;
-        }
-
-        ret |= apply_change_track(sc68);
+        ret |= pass_begin(sc68);
         if (ret & (SC68_END|SC68_CHANGE)) /* exit on error|end|change */
           break;
         ret &= ~SC68_IDLE;              /* No more idle */
 
-        /* setup aSID */
-        if (sc68->asid_timers)
-          sc68->emu68->mem[sc68->playaddr+17] = -!!(sc68->asid & SC68_ASID_ON);
-
-        /* Run 68K emulator */
-        status = finish(sc68, sc68->playaddr+8, 0x2300, PLAY_MAX_INST);
-        if (status == EMU68_NRM) {
-          /* $$$ Fix some replays (tao's intensity 200 for one) that
-             assumes the music driver is running under interruption
-             and do not restore the SR by themself. Need to be sure
-             this does not disrupt other musics. */
-          sc68->emu68->reg.sr = 0x2300;
-          status = emu68_interrupt(sc68->emu68, sc68->mix.cycleperpass);
-        }
-        if (status != EMU68_NRM) {
-          error_addx(sc68,
-                     "libsc68: abnormal 68K status %d (%s) in play pass %u\n",
-                     status, emu68_status_name(status),
-                     sc68->mix.pass_count);
+        if (pass_run(sc68, 0) != SC68_OK) {
           ret = SC68_ERROR;
           break;
         }
-
-        /* Reset pcm pointer. */
-        sc68->mix.bufpos = 0;
-        sc68->mix.buflen = sc68->mix.bufreq;
-
-        /* Fill pcm buufer depending on architecture */
-        if (sc68->mus->hwflags & SC68_AGA) {
-          /* Amiga - Paula */
-          paula_mix(sc68->paula,(s32*)sc68->mix.buffer,sc68->mix.buflen);
-          mixer68_blend_LR(sc68->mix.buffer, sc68->mix.buffer, sc68->mix.buflen,
-                           sc68->mix.aga_blend, 0, 0);
-        } else {
-          if (sc68->mus->hwflags & SC68_PSG) {
-            int err =
-              ymio_run(sc68->ymio, (s32*)sc68->mix.buffer,
-                       sc68->mix.cycleperpass);
-            if (err < 0) {
-              ret = SC68_ERROR;
-              sc68->mix.buflen = 0;
-              break;
-            }
-            sc68->mix.buflen = err;
-          } else {
-            mixer68_fill(sc68->mix.buffer, sc68->mix.buflen=sc68->mix.bufreq, 0);
-          }
-
-          if (sc68->mus->hwflags & (SC68_DMA|SC68_LMC))
-            /* STE / MicroWire */
-            mw_mix(sc68->mw, (s32 *)sc68->mix.buffer, sc68->mix.buflen);
-          else
-            /* Else simply process with left channel duplication. */
-            mixer68_dup_L_to_R(sc68->mix.buffer, sc68->mix.buffer,
-                               sc68->mix.buflen, 0);
-        }
-
-        /* Advance time */
-        calc_pos(sc68);
-        sc68->mix.pass_count++;
       }
 
       assert(sc68->mix.buflen > 0);
 
-      /* Copy to destination buffer. */
+      /* Copy or convert to destination buffer. */
+      t   = perf_start(sc68);
       len = sc68->mix.buflen <= n ? sc68->mix.buflen : n;
-      mixer68_copy((u32 *)buf16st,sc68->mix.buffer+sc68->mix.bufpos,len);
-      buf16st = (u32 *)buf16st + len;
+      if (sc68->mix.pcmfmt == SC68_PCM_F32) {
+        mixer68_blend_FL_LR((float *)buf16st,
+                            sc68->mix.buffer+sc68->mix.bufpos, len,
+                            sc68->mix.blend, 0, 1.0f);
+        buf16st = (float *)buf16st + 2*len;
+      } else {
+        mixer68_copy((u32 *)buf16st,sc68->mix.buffer+sc68->mix.bufpos,len);
+        buf16st = (u32 *)buf16st + len;
+      }
       sc68->mix.bufpos += len;
       sc68->mix.buflen -= len;
       n                -= len;
+      perf_lap(sc68, SC68_PERF_COPY, &t);
     }
     *_n -= n;
   }
   return ret;
 }
 
+static void process_job(void * cookie, int job)
+{
+  sc68_batch_t * const b = (sc68_batch_t *) cookie + job;
+  b->ret = sc68_process(b->sc68, b->buf, &b->n);
+}
+
+int sc68_process_many(sc68_batch_t * batch, int cnt)
+{
+  int i, err = 0;
+
+  if (!batch || cnt < 0)
+    return -1;
+  pool68_run(process_job, batch, cnt);
+  for (i = 0; i < cnt; ++i)
+    err += batch[i].ret == SC68_ERROR;
+  return err;
+}
+
+int sc68_skip(sc68_t * sc68, int ms)
+{
+  int ret, n, max;
+  u64 pcm;
+
+  if (!is_sc68(sc68) || ms < 0)
+    return SC68_ERROR;
+
+  pcm  = ms;
+  pcm *= sc68->mix.spr;
+  pcm /= 1000u;
+  n    = (int) pcm;
+  max  = sc68->mix.bufreq;
+  ret  = SC68_IDLE;
+
+  while (n > 0) {
+    int len;
+
+    /* Pending seek request */
+    if (sc68->seek_to >= 0 && sc68->mus && !sc68->track_to) {
+      ret |= seek_apply(sc68);
+      if (ret & (SC68_END|SC68_CHANGE)) /* exit on error|end|change */
+        break;
+      ret &= ~SC68_IDLE;                /* No more idle */
+    }
+
+    /* No more pcm in internal buffer ... */
+    if (!sc68->mix.buflen) {
+      ret |= pass_begin(sc68);
+      if (ret & (SC68_END|SC68_CHANGE)) /* exit on error|end|change */
+        break;
+      ret &= ~SC68_IDLE;                /* No more idle */
+
+      /* A pass never produces more than bufreq PCM and all passes of
+       * a track produce about the same number of PCM. Only the last
+       * pass might be partially skipped and needs actual PCM. */
+      if (pass_run(sc68, n >= max) != SC68_OK) {
+        ret = SC68_ERROR;
+        break;
+      }
+      if (!sc68->mix.buflen)
+        continue;
+      if (sc68->mix.buflen*2 < max)
+        max = sc68->mix.buflen*2;
+    }
+
+    /* Drop PCM */
+    len = sc68->mix.buflen <= n ? sc68->mix.buflen : n;
+    sc68->mix.bufpos += len;
+    sc68->mix.buflen -= len;
+    n                -= len;
+  }
+  return ret;
+}
+
 int sc68_is_our_uri(const char * uri, const char *exts, int * is_remote)
 {
   assert(!"TO DO");
@@ -2114,6 +2858,7 @@ void sc68_close(sc68_t * sc68)
       file68_free((disk68_t *)sc68->disk);
     sc68->tobe3     = 0;
     sc68->disk      = 0;
+    init_clear(sc68);
   }
 }
 
@@ -2237,6 +2982,16 @@ static int get_pos(sc68_t * sc68, int origin)
   return pos;
 }
 
+/* Request a seek in the current track, or in the track about to be
+ * played. The seek itself happens in the process thread. */
+static int set_pos(sc68_t * sc68, int pos)
+{
+  if (pos < 0 || (sc68->track_to ? sc68->track_to < 0 : sc68->track <= 0))
+    return -1;
+  sc68->seek_to = pos;
+  return 0;
+}
+
 static unsigned int calc_track_len(const disk68_t * d, int track, int loop)
 {
   const music68_t * m;
@@ -2688,6 +3443,10 @@ int sc68_cntl(sc68_t * sc68, int fct, ...)
       res = get_pos(sc68, SC68_POS_PLAY);
       break;
 
+    case SC68_SET_POS:
+      res = set_pos(sc68, va_arg(list, int));
+      break;
+
     case SC68_GET_COOKIE:
       *va_arg(list, void **) = sc68->cookie;
       res = 0;
@@ -2703,7 +3462,20 @@ int sc68_cntl(sc68_t * sc68, int fct, ...)
       res = 0;
       break;
 
-    case SC68_SET_POS:
+    case SC68_GET_PERF:
+      res = get_perf(sc68, va_arg(list, sc68_perf_t *));
+      break;
+
+    case SC68_SET_PERF:
+      res = set_perf(sc68, va_arg(list, int));
+      break;
+
+    case SC68_SET_PERF_CB:
+      sc68->perf.fct    = va_arg(list, sc68_perf_cb_t);
+      sc68->perf.cookie = va_arg(list, void *);
+      res = 0;
+      break;
+
     default:
       res = error_addx(sc68,
                        "libsc68: %s (%d)\n",
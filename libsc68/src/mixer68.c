@@ -29,6 +29,35 @@
 
 #include "mixer68.h"
 
+/* Instruction sets the kernels can be built for. AVX2 kernels are
+ * built with a target attribute and only run if the CPU has it. */
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define MIXER68_SSE2 1
+# if (defined(__x86_64__) || defined(__i386__)) && \
+  (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#  include <immintrin.h>
+#  define MIXER68_AVX2 1
+# endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define MIXER68_NEON 1
+#endif
+
+/* Kernels of an instruction set. */
+typedef struct {
+  void (*stereo_16_LR)(u32 *, u32 *, int, const u32);
+  void (*stereo_16_RL)(u32 *, u32 *, int, const u32);
+  void (*dup_L_to_R)(u32 *, u32 *, int, const u32);
+  void (*dup_R_to_L)(u32 *, u32 *, int, const u32);
+  void (*blend_LR)(u32 *, u32 *, int, const int, const u32, const u32);
+  void (*mult_LR)(u32 *, u32 *, int, const int, const int,
+                  const u32, const u32);
+  void (*fill)(u32 *, int, const u32);
+  void (*copy)(u32 *, u32 *, int);
+} mixer68_kern_t;
+
 /* ARM compliant version */
 /* #define SWAP_16BITWORD(V) ((V^=V<<16), (V^=V>>16), (V^=V<<16)) */
 
@@ -43,16 +72,10 @@
  *  sign=0x80000000 : Change right channel sign
  *  sign=0x80008000 : Change both channel
  */
-void mixer68_stereo_16_LR(u32 * dst, u32 * src, int nb, const u32 sign)
+static void stereo_16_LR_c(u32 * dst, u32 * src, int nb, const u32 sign)
 {
-  u32 *end;
-
-  /* Optimize trivial case : same buffer, no sign change */
-  if (!sign && dst == src) {
-    return;
-  }
+  u32 * const end = dst+nb;
 
-  end = dst+nb;
   if (nb&1) {
     *dst++ = (*src++) ^ sign;
   }
@@ -73,7 +96,7 @@ void mixer68_stereo_16_LR(u32 * dst, u32 * src, int nb, const u32 sign)
 
 /*  Mix 16-bit-stereo PCM into 16-bit-stereo PCM with channel swapping.
  */
-void mixer68_stereo_16_RL(u32 * dst, u32 * src, int nb, const u32 sign)
+static void stereo_16_RL_c(u32 * dst, u32 * src, int nb, const u32 sign)
 {
   u32 *end;
 
@@ -104,28 +127,95 @@ void mixer68_stereo_16_RL(u32 * dst, u32 * src, int nb, const u32 sign)
 
 }
 
+/*  Convert 16-bit-stereo PCM into 32-bit-stereo-float with optional
+ *  L/R blending: L' = L*a + R*b and R' = R*a + L*b
+ */
+static void float_LR(float * dst, const u32 * src, int nb,
+                     const u32 sign, const float a, const float b)
+{
+#if defined(MIXER68_SSE2)
+  const __m128i s  = _mm_set1_epi32((int)sign);
+  const __m128  va = _mm_set1_ps(a);
+  const __m128  vb = _mm_set1_ps(b);
+  for ( ; nb >= 4; nb -= 4, src += 4, dst += 8) {
+    const __m128i v =
+      _mm_xor_si128(_mm_loadu_si128((const __m128i *) src), s);
+    /* Sign extend L/R words to L0 R0 L1 R1 | L2 R2 L3 R3 */
+    __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v,v),16));
+    __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v,v),16));
+    if (b == 0.0f) {
+      lo = _mm_mul_ps(lo, va);
+      hi = _mm_mul_ps(hi, va);
+    } else {
+      lo = _mm_add_ps(_mm_mul_ps(lo, va),
+                      _mm_mul_ps(_mm_shuffle_ps(lo, lo, 0xB1), vb));
+      hi = _mm_add_ps(_mm_mul_ps(hi, va),
+                      _mm_mul_ps(_mm_shuffle_ps(hi, hi, 0xB1), vb));
+    }
+    _mm_storeu_ps(dst+0, lo);
+    _mm_storeu_ps(dst+4, hi);
+  }
+#elif defined(MIXER68_NEON)
+  const uint32x4_t s = vdupq_n_u32(sign);
+  for ( ; nb >= 4; nb -= 4, src += 4, dst += 8) {
+    const int16x8_t v =
+      vreinterpretq_s16_u32(veorq_u32(vld1q_u32(src), s));
+    float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+    float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+    if (b == 0.0f) {
+      lo = vmulq_n_f32(lo, a);
+      hi = vmulq_n_f32(hi, a);
+    } else {
+      lo = vaddq_f32(vmulq_n_f32(lo, a), vmulq_n_f32(vrev64q_f32(lo), b));
+      hi = vaddq_f32(vmulq_n_f32(hi, a), vmulq_n_f32(vrev64q_f32(hi), b));
+    }
+    vst1q_f32(dst+0, lo);
+    vst1q_f32(dst+4, hi);
+  }
+#endif
+  for ( ; nb > 0; --nb) {
+    const int v = (int)(s32)(*src++ ^ sign);
+    const float l = (float)(s16)v, r = (float)(v>>16);
+    if (b == 0.0f) {
+      *dst++ = l * a;
+      *dst++ = r * a;
+    } else {
+      *dst++ = l * a + r * b;
+      *dst++ = r * a + l * b;
+    }
+  }
+}
+
 /*  Mix 16-bit-stereo PCM into 32-bit-stereo-float (-norm..norm)
  */
 void mixer68_stereo_FL_LR (float * dst, u32 * src, int nb,
                            const u32 sign, const float norm)
+{
+  float_LR(dst, src, nb, sign, norm / 32768.0f, 0.0f);
+}
+
+/*  Mix 16-bit-stereo PCM into 32-bit-stereo-float (-norm..norm) with
+ *  L/R blending, factor [0..65536], 0:blend nothing, 65536:swap L/R
+ */
+void mixer68_blend_FL_LR(float * dst, u32 * src, int nb, int factor,
+                         const u32 sign, const float norm)
 {
   const float mult = norm / 32768.0f;
-  int v;
-  float * const  end = dst + (nb<<1);
-  if (dst < end) {
-    do {
-      v = (int)(s32)(*src++ ^ sign);
-      *dst++ = mult * (float)(s16)(v);
-      *dst++ = mult * (float)(v>>16);
-    } while (dst < end);
+
+  if (factor < 0) {
+    factor = 0;
+  } else if (factor > 65536) {
+    factor = 65536;
   }
+  float_LR(dst, src, nb, sign,
+           mult * (float)(65536-factor) / 65536.0f,
+           mult * (float)factor / 65536.0f);
 }
 
 /*  Duplicate left channel into right channel and change sign.
  *  PCM' = ( PCM-L | (PCM-L<<16) ) ^ sign
  */
-void mixer68_dup_L_to_R(u32 *dst, u32 *src, int nb,
-                        const u32 sign)
+static void dup_L_to_R_c(u32 *dst, u32 *src, int nb, const u32 sign)
 {
   u32 * const end = dst+nb;
   if (nb&1) {
@@ -152,7 +242,7 @@ void mixer68_dup_L_to_R(u32 *dst, u32 *src, int nb,
 /*  Duplicate right channel into left channel and change sign.
  *  PCM = ( PCM-R | (PCM-R>>16) ) ^ sign
  */
-void mixer68_dup_R_to_L(u32 *dst, u32 *src, int nb, const u32 sign)
+static void dup_R_to_L_c(u32 *dst, u32 *src, int nb, const u32 sign)
 {
   u32 * const end = dst+nb;
 
@@ -180,19 +270,12 @@ void mixer68_dup_R_to_L(u32 *dst, u32 *src, int nb, const u32 sign)
 /*  Blend Left and right voice :
  *  factor [0..65536], 0:blend nothing, 65536:swap L/R
  */
-void mixer68_blend_LR(u32 * dst, u32 * src, int nb,
-                      int factor,
-                      const u32 sign_r, const u32 sign_w)
+static void blend_LR_c(u32 * dst, u32 * src, int nb, const int factor,
+                       const u32 sign_r, const u32 sign_w)
 {
   u32 *end;
   int oof;
 
-  if (factor < 0) {
-    factor = 0;
-  } else if (factor > 65536) {
-    factor = 65536;
-  }
-
 #undef  MIX_ONE
 #define MIX_ONE                                                         \
   r = (int)(s32)(*src++ ^ sign_r);                                      \
@@ -230,24 +313,12 @@ void mixer68_blend_LR(u32 * dst, u32 * src, int nb,
 
 /*  Multiply left/right (signed) channel by ml/mr factor [-65536..65536]
  */
-void mixer68_mult_LR(u32 *dst, u32 *src, int nb,
-                     const int ml, const int mr,
-                     const u32 sign_r, const u32 sign_w)
+static void mult_LR_c(u32 *dst, u32 *src, int nb,
+                      const int ml, const int mr,
+                      const u32 sign_r, const u32 sign_w)
 {
   u32 * end;
 
-  /* Optimize some trivial case. */
-
-  if (ml == 65536 && mr == 65536) {
-    mixer68_stereo_16_LR(dst, src, nb, sign_r ^ sign_w);
-    return;
-  }
-
-  if (ml==0 && mr==0) {
-    mixer68_fill(dst, nb, sign_w);
-    return;
-  }
-
 #undef  MIX_ONE
 #define MIX_ONE                                                 \
   r = (int)(s32)(*src++ ^ sign_r);                              \
@@ -282,7 +353,7 @@ void mixer68_mult_LR(u32 *dst, u32 *src, int nb,
 
 /*  Fill buffer sign with value (RRRRLLLL)
  */
-void mixer68_fill(u32 * dst, int nb, const u32 sign)
+static void fill_c(u32 * dst, int nb, const u32 sign)
 {
   u32 * const end = dst+nb;;
 
@@ -303,27 +374,324 @@ void mixer68_fill(u32 * dst, int nb, const u32 sign)
   }
 }
 
+static void copy_c(u32 * dst, u32 * src, int nb)
+{
+  u32 * const end = dst+nb;
+  if (nb&1) {
+    *dst++ = *src++;
+  }
+  if (nb&2) {
+    *dst++ = *src++;
+    *dst++ = *src++;
+  }
+  if (dst<end) {
+    do {
+      *dst++ = *src++;
+      *dst++ = *src++;
+      *dst++ = *src++;
+      *dst++ = *src++;
+    } while (dst < end);
+  }
+}
+
+static const mixer68_kern_t kern_c = {
+  stereo_16_LR_c, stereo_16_RL_c,
+  dup_L_to_R_c, dup_R_to_L_c,
+  blend_LR_c, mult_LR_c,
+  fill_c, copy_c
+};
+
+/* ,-----------------------------------------------------------------.
+ * |                         SIMD kernels                            |
+ * `-----------------------------------------------------------------'
+ */
+
+#define V_LO16(V)   V_AND(V,V_SET32(0x0000FFFF))
+#define V_HI16(V)   V_AND(V,V_SET32(0xFFFF0000))
+#define V_SWAP16(V) V_OR(V_SLLI32(V,16),V_SRLI32(V,16))
+#define V_DUP16L(V) V_OR(V_LO16(V),V_SLLI32(V,16))
+#define V_DUP16H(V) V_OR(V_HI16(V),V_SRLI32(V,16))
+
+#ifdef MIXER68_SSE2
+
+# define KERN(N)       N##_sse2
+# define KERN_TARGET
+# define v_t           __m128i
+# define V_N           4
+# define V_LD(P)       _mm_loadu_si128((const __m128i *)(P))
+# define V_ST(P,V)     _mm_storeu_si128((__m128i *)(P),(V))
+# define V_SET32(X)    _mm_set1_epi32((int)(X))
+# define V_XOR         _mm_xor_si128
+# define V_AND         _mm_and_si128
+# define V_OR          _mm_or_si128
+# define V_ANDN        _mm_andnot_si128
+# define V_ADD16       _mm_add_epi16
+# define V_SUB16       _mm_sub_epi16
+# define V_MULLO16     _mm_mullo_epi16
+# define V_MULHU16     _mm_mulhi_epu16
+# define V_SRAI16      _mm_srai_epi16
+# define V_SRLI16      _mm_srli_epi16
+# define V_SLLI32      _mm_slli_epi32
+# define V_SRLI32      _mm_srli_epi32
+# include "mixer68_simd.c"
+# undef KERN
+# undef KERN_TARGET
+# undef v_t
+# undef V_N
+# undef V_LD
+# undef V_ST
+# undef V_SET32
+# undef V_XOR
+# undef V_AND
+# undef V_OR
+# undef V_ANDN
+# undef V_ADD16
+# undef V_SUB16
+# undef V_MULLO16
+# undef V_MULHU16
+# undef V_SRAI16
+# undef V_SRLI16
+# undef V_SLLI32
+# undef V_SRLI32
+
+#endif
+
+#ifdef MIXER68_AVX2
+
+# define KERN(N)       N##_avx2
+# define KERN_TARGET   __attribute__((target("avx2")))
+# define v_t           __m256i
+# define V_N           8
+# define V_LD(P)       _mm256_loadu_si256((const __m256i *)(P))
+# define V_ST(P,V)     _mm256_storeu_si256((__m256i *)(P),(V))
+# define V_SET32(X)    _mm256_set1_epi32((int)(X))
+# define V_XOR         _mm256_xor_si256
+# define V_AND         _mm256_and_si256
+# define V_OR          _mm256_or_si256
+# define V_ANDN        _mm256_andnot_si256
+# define V_ADD16       _mm256_add_epi16
+# define V_SUB16       _mm256_sub_epi16
+# define V_MULLO16     _mm256_mullo_epi16
+# define V_MULHU16     _mm256_mulhi_epu16
+# define V_SRAI16      _mm256_srai_epi16
+# define V_SRLI16      _mm256_srli_epi16
+# define V_SLLI32      _mm256_slli_epi32
+# define V_SRLI32      _mm256_srli_epi32
+# include "mixer68_simd.c"
+# undef KERN
+# undef KERN_TARGET
+# undef v_t
+# undef V_N
+# undef V_LD
+# undef V_ST
+# undef V_SET32
+# undef V_XOR
+# undef V_AND
+# undef V_OR
+# undef V_ANDN
+# undef V_ADD16
+# undef V_SUB16
+# undef V_MULLO16
+# undef V_MULHU16
+# undef V_SRAI16
+# undef V_SRLI16
+# undef V_SLLI32
+# undef V_SRLI32
+
+#endif
+
+#ifdef MIXER68_NEON
+
+static inline uint32x4_t neon_mulhu16(const uint32x4_t a, const uint32x4_t b)
+{
+  const uint16x8_t x = vreinterpretq_u16_u32(a);
+  const uint16x8_t y = vreinterpretq_u16_u32(b);
+  const uint32x4_t l = vmull_u16(vget_low_u16(x),  vget_low_u16(y));
+  const uint32x4_t h = vmull_u16(vget_high_u16(x), vget_high_u16(y));
+  return vreinterpretq_u32_u16(vcombine_u16(vshrn_n_u32(l,16),
+                                            vshrn_n_u32(h,16)));
+}
+
+# define N16(V)        vreinterpretq_u16_u32(V)
+# define N32(V)        vreinterpretq_u32_u16(V)
+# define KERN(N)       N##_neon
+# define KERN_TARGET
+# define v_t           uint32x4_t
+# define V_N           4
+# define V_LD(P)       vld1q_u32(P)
+# define V_ST(P,V)     vst1q_u32((P),(V))
+# define V_SET32(X)    vdupq_n_u32(X)
+# define V_XOR         veorq_u32
+# define V_AND         vandq_u32
+# define V_OR          vorrq_u32
+# define V_ANDN(A,B)   vbicq_u32((B),(A))
+# define V_ADD16(A,B)  N32(vaddq_u16(N16(A),N16(B)))
+# define V_SUB16(A,B)  N32(vsubq_u16(N16(A),N16(B)))
+# define V_MULLO16(A,B) N32(vmulq_u16(N16(A),N16(B)))
+# define V_MULHU16     neon_mulhu16
+# define V_SRAI16(V,N) \
+  N32(vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(N16(V)),N)))
+# define V_SRLI16(V,N) N32(vshrq_n_u16(N16(V),N))
+# define V_SLLI32      vshlq_n_u32
+# define V_SRLI32      vshrq_n_u32
+# include "mixer68_simd.c"
+# undef N16
+# undef N32
+# undef KERN
+# undef KERN_TARGET
+# undef v_t
+# undef V_N
+# undef V_LD
+# undef V_ST
+# undef V_SET32
+# undef V_XOR
+# undef V_AND
+# undef V_OR
+# undef V_ANDN
+# undef V_ADD16
+# undef V_SUB16
+# undef V_MULLO16
+# undef V_MULHU16
+# undef V_SRAI16
+# undef V_SRLI16
+# undef V_SLLI32
+# undef V_SRLI32
+
+#endif
+
+/* ,-----------------------------------------------------------------.
+ * |                       Kernels selection                         |
+ * `-----------------------------------------------------------------'
+ */
+
+static const mixer68_kern_t * kern = &kern_c;
+static int kern_isa = MIXER68_ISA_C;
+
+/* Get kernels of an instruction set if it is available. */
+static const mixer68_kern_t * isa_kern(const int isa)
+{
+  switch (isa) {
+  case MIXER68_ISA_C:
+    return &kern_c;
+#ifdef MIXER68_SSE2
+  case MIXER68_ISA_SSE2:
+    return &kern_sse2;
+#endif
+#ifdef MIXER68_AVX2
+  case MIXER68_ISA_AVX2:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? &kern_avx2 : 0;
+#endif
+#ifdef MIXER68_NEON
+  case MIXER68_ISA_NEON:
+    return &kern_neon;
+#endif
+  }
+  return 0;
+}
+
+int mixer68_select(int isa)
+{
+  const mixer68_kern_t * k;
+
+  switch (isa) {
+  case MIXER68_ISA_QUERY:
+    return kern_isa;
+  case MIXER68_ISA_AUTO:
+    /* Best available */
+    for (isa = MIXER68_ISA_LAST; !(k = isa_kern(isa)); --isa)
+      ;
+    break;
+  default:
+    if (k = isa_kern(isa), !k)
+      return -1;
+  }
+  kern     = k;
+  kern_isa = isa;
+  return isa;
+}
+
+const char * mixer68_isa_name(const int isa)
+{
+  switch (isa) {
+  case MIXER68_ISA_C:    return "c";
+  case MIXER68_ISA_SSE2: return "sse2";
+  case MIXER68_ISA_AVX2: return "avx2";
+  case MIXER68_ISA_NEON: return "neon";
+  }
+  return 0;
+}
+
+/* ,-----------------------------------------------------------------.
+ * |                        Mixer functions                          |
+ * `-----------------------------------------------------------------'
+ */
+
+void mixer68_stereo_16_LR(u32 * dst, u32 * src, int nb, const u32 sign)
+{
+  /* Optimize trivial case : same buffer, no sign change */
+  if (!sign && dst == src) {
+    return;
+  }
+  kern->stereo_16_LR(dst, src, nb, sign);
+}
+
+void mixer68_stereo_16_RL(u32 * dst, u32 * src, int nb, const u32 sign)
+{
+  kern->stereo_16_RL(dst, src, nb, sign);
+}
+
+void mixer68_dup_L_to_R(u32 * dst, u32 * src, int nb, const u32 sign)
+{
+  kern->dup_L_to_R(dst, src, nb, sign);
+}
+
+void mixer68_dup_R_to_L(u32 * dst, u32 * src, int nb, const u32 sign)
+{
+  kern->dup_R_to_L(dst, src, nb, sign);
+}
+
+void mixer68_blend_LR(u32 * dst, u32 * src, int nb,
+                      int factor,
+                      const u32 sign_r, const u32 sign_w)
+{
+  if (factor < 0) {
+    factor = 0;
+  } else if (factor > 65536) {
+    factor = 65536;
+  }
+  kern->blend_LR(dst, src, nb, factor, sign_r, sign_w);
+}
+
+void mixer68_mult_LR(u32 * dst, u32 * src, int nb,
+                     const int ml, const int mr,
+                     const u32 sign_r, const u32 sign_w)
+{
+  /* Optimize some trivial case. */
+
+  if (ml == 65536 && mr == 65536) {
+    mixer68_stereo_16_LR(dst, src, nb, sign_r ^ sign_w);
+    return;
+  }
+
+  if (ml==0 && mr==0) {
+    mixer68_fill(dst, nb, sign_w);
+    return;
+  }
+
+  kern->mult_LR(dst, src, nb, ml, mr, sign_r, sign_w);
+}
+
+void mixer68_fill(u32 * dst, int nb, const u32 sign)
+{
+  kern->fill(dst, nb, sign);
+}
+
 void mixer68_copy(u32 * dst, u32 * src, int nb)
 {
   /* Optimize trivial case : same buffer */
   if (dst == src || nb <= 0) {
     return;
-  } else {
-    u32 * const end = dst+nb;
-    if (nb&1) {
-      *dst++ = *src++;
-    }
-    if (nb&2) {
-      *dst++ = *src++;
-      *dst++ = *src++;
-    }
-    if (dst<end) {
-      do {
-        *dst++ = *src++;
-        *dst++ = *src++;
-        *dst++ = *src++;
-        *dst++ = *src++;
-      } while (dst < end);
-    }
   }
+  kern->copy(dst, src, nb);
 }
@@ -0,0 +1,164 @@
+/*
+ * @file    mixer68_simd.c
+ * @brief   audio mixer SIMD kernels (template)
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* This file is included by mixer68.c once per instruction set with
+ * the following defined:
+ *
+ *  KERN(N)          kernel name for this instruction set
+ *  KERN_TARGET      function attributes (or nothing)
+ *  v_t              vector type
+ *  V_N              number of PCM (u32) per vector
+ *  V_LD/V_ST        unaligned load/store
+ *  V_SET32(X)       all 32-bit lanes set to X
+ *  V_XOR/V_AND/V_OR bitwise operations
+ *  V_ANDN(A,B)      ~A & B
+ *  V_ADD16/V_SUB16  16-bit lanes add/sub (modulo)
+ *  V_MULLO16        16-bit lanes product low word
+ *  V_MULHU16        16-bit lanes unsigned product high word
+ *  V_SRAI16/V_SRLI16  16-bit lanes shift right
+ *  V_SLLI32/V_SRLI32  32-bit lanes shift
+ *
+ * All kernels produce the exact same PCM than the scalar ones that
+ * also process the remaining PCM.
+ */
+
+/* High word of the 32-bit product of signed 16-bit lanes X by M where
+ * M = U + 65536*K with U unsigned 16-bit and K in {-1,0,1}. This
+ * covers all factors in [-65536..65536]. */
+#define V_MULHS(X,U,K)                                          \
+  V_ADD16(V_SUB16(V_MULHU16(X,U), V_AND(V_SRAI16(X,15),U)),     \
+          V_MULLO16(X,K))
+
+/* Factor split (see V_MULHS). */
+#define V_FACU(M) ((u32)(M) & 0xFFFF)
+#define V_FACK(M) ((u32)((M) >> 16) & 0xFFFF)
+#define V_FAC2(L,R) ( (L) | ((R) << 16) )
+
+KERN_TARGET
+static void KERN(stereo_16_LR)(u32 * dst, u32 * src, int nb, const u32 sign)
+{
+  const v_t s = V_SET32(sign);
+  for ( ; nb >= V_N; nb -= V_N, src += V_N, dst += V_N)
+    V_ST(dst, V_XOR(V_LD(src), s));
+  stereo_16_LR_c(dst, src, nb, sign);
+}
+
+KERN_TARGET
+static void KERN(stereo_16_RL)(u32 * dst, u32 * src, int nb, const u32 sign)
+{
+  const v_t s = V_SET32(sign);
+  for ( ; nb >= V_N; nb -= V_N, src += V_N, dst += V_N)
+    V_ST(dst, V_XOR(V_SWAP16(V_LD(src)), s));
+  stereo_16_RL_c(dst, src, nb, sign);
+}
+
+KERN_TARGET
+static void KERN(dup_L_to_R)(u32 * dst, u32 * src, int nb, const u32 sign)
+{
+  const v_t s = V_SET32(sign);
+  for ( ; nb >= V_N; nb -= V_N, src += V_N, dst += V_N)
+    V_ST(dst, V_XOR(V_DUP16L(V_LD(src)), s));
+  dup_L_to_R_c(dst, src, nb, sign);
+}
+
+KERN_TARGET
+static void KERN(dup_R_to_L)(u32 * dst, u32 * src, int nb, const u32 sign)
+{
+  const v_t s = V_SET32(sign);
+  for ( ; nb >= V_N; nb -= V_N, src += V_N, dst += V_N)
+    V_ST(dst, V_XOR(V_DUP16H(V_LD(src)), s));
+  dup_R_to_L_c(dst, src, nb, sign);
+}
+
+/* Both channels: (C*oof + O*factor) >> 16 with C the channel and O the
+ * other one. Both 32-bit products are split in 16-bit words and the
+ * low words carry is propagated to the sum of the high words. */
+KERN_TARGET
+static void KERN(blend_LR)(u32 * dst, u32 * src, int nb, const int factor,
+                           const u32 sign_r, const u32 sign_w)
+{
+  const int oof = 65536 - factor;
+  const v_t ou = V_SET32(V_FAC2(V_FACU(oof),    V_FACU(oof)));
+  const v_t ok = V_SET32(V_FAC2(V_FACK(oof),    V_FACK(oof)));
+  const v_t fu = V_SET32(V_FAC2(V_FACU(factor), V_FACU(factor)));
+  const v_t fk = V_SET32(V_FAC2(V_FACK(factor), V_FACK(factor)));
+  const v_t sr = V_SET32(sign_r), sw = V_SET32(sign_w);
+
+  for ( ; nb >= V_N; nb -= V_N, src += V_N, dst += V_N) {
+    const v_t c  = V_XOR(V_LD(src), sr);
+    const v_t o  = V_SWAP16(c);
+    const v_t la = V_MULLO16(c, ou), ha = V_MULHS(c, ou, ok);
+    const v_t lb = V_MULLO16(o, fu), hb = V_MULHS(o, fu, fk);
+    const v_t ls = V_ADD16(la, lb);
+    const v_t cy = V_SRLI16(V_OR(V_AND(la, lb),
+                                 V_ANDN(ls, V_OR(la, lb))), 15);
+    V_ST(dst, V_XOR(V_ADD16(V_ADD16(ha, hb), cy), sw));
+  }
+  blend_LR_c(dst, src, nb, factor, sign_r, sign_w);
+}
+
+KERN_TARGET
+static void KERN(mult_LR)(u32 * dst, u32 * src, int nb,
+                          const int ml, const int mr,
+                          const u32 sign_r, const u32 sign_w)
+{
+  const v_t mu = V_SET32(V_FAC2(V_FACU(ml), V_FACU(mr)));
+  const v_t mk = V_SET32(V_FAC2(V_FACK(ml), V_FACK(mr)));
+  const v_t sr = V_SET32(sign_r), sw = V_SET32(sign_w);
+
+  for ( ; nb >= V_N; nb -= V_N, src += V_N, dst += V_N) {
+    const v_t x = V_XOR(V_LD(src), sr);
+    V_ST(dst, V_XOR(V_MULHS(x, mu, mk), sw));
+  }
+  mult_LR_c(dst, src, nb, ml, mr, sign_r, sign_w);
+}
+
+KERN_TARGET
+static void KERN(fill)(u32 * dst, int nb, const u32 sign)
+{
+  const v_t s = V_SET32(sign);
+  for ( ; nb >= V_N; nb -= V_N, dst += V_N)
+    V_ST(dst, s);
+  fill_c(dst, nb, sign);
+}
+
+KERN_TARGET
+static void KERN(copy)(u32 * dst, u32 * src, int nb)
+{
+  for ( ; nb >= V_N; nb -= V_N, src += V_N, dst += V_N)
+    V_ST(dst, V_LD(src));
+  copy_c(dst, src, nb);
+}
+
+static const mixer68_kern_t KERN(kern) = {
+  KERN(stereo_16_LR), KERN(stereo_16_RL),
+  KERN(dup_L_to_R), KERN(dup_R_to_L),
+  KERN(blend_LR), KERN(mult_LR),
+  KERN(fill), KERN(copy)
+};
+
+#undef V_MULHS
+#undef V_FACU
+#undef V_FACK
+#undef V_FAC2
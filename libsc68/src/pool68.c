@@ -0,0 +1,292 @@
+/*
+ * @file    pool68.c
+ * @brief   worker thread pool
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#if defined(HAVE_PTHREAD_SETAFFINITY_NP) && !defined(_GNU_SOURCE)
+# define _GNU_SOURCE 1                  /* pthread_setaffinity_np() */
+#endif
+
+#include "sc68_private.h"
+#include "pool68.h"
+
+#include <sc68/file68_msg.h>
+
+#include <stdlib.h>
+
+#if defined(HAVE_PTHREAD_H) && defined(__GNUC__)
+# define USE_THREADS 1
+# include <pthread.h>
+# ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+# endif
+# ifdef HAVE_PTHREAD_SETAFFINITY_NP
+#  include <sched.h>
+# endif
+#endif
+
+enum {
+  POOL_MAX = 64                         /* maximum number of threads */
+};
+
+static int req_threads;                 /* requested (0:one per CPU) */
+static int req_pin;                     /* pin workers to CPUs       */
+
+#ifdef USE_THREADS
+
+/* Jobs [head..end[ of a thread, on their own cache line. */
+typedef struct {
+  int head;                             /* next job (atomic) */
+  int end;                              /* end of range      */
+  char pad[64-2*sizeof(int)];
+} range_t;
+
+static struct {
+  int             nthd;                 /* threads (caller included) */
+  pthread_t       thd[POOL_MAX];        /* workers (0 is the caller) */
+  range_t         rng[POOL_MAX];        /* jobs of each thread       */
+  pthread_mutex_t run;                  /* serialize pool68_run()    */
+  pthread_mutex_t mtx;                  /* protect the following     */
+  pthread_cond_t  go;                   /* new batch or quit         */
+  pthread_cond_t  done;                 /* workers done              */
+  unsigned int    gen;                  /* batch generation          */
+  int             busy;                 /* workers still running     */
+  int             quit;                 /* workers must exit         */
+  pool68_job_t    fct;
+  void          * cookie;
+} pool = {
+  0, {0}, {{0}},
+  PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+  PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+  0, 0, 0, 0, 0
+};
+
+static int cpu_count(void)
+{
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int) n : 1;
+#else
+  return 1;
+#endif
+}
+
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+/* Pin worker w to one of the CPUs the caller is allowed to run on. */
+static int pin_worker(const int w)
+{
+  cpu_set_t set;
+  int cpu, i;
+
+  if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set))
+    return -1;
+  i = CPU_COUNT(&set);
+  if (i <= 0)
+    return -1;
+  for (i = w % i, cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    if (CPU_ISSET(cpu, &set) && !i--)
+      break;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pool.thd[w], sizeof(set), &set);
+}
+#endif
+
+/* Run own jobs then steal from the next threads. */
+static void run_jobs(const int self)
+{
+  int i, job;
+
+  for (i = 0; i < pool.nthd; ++i) {
+    range_t * const rng = pool.rng + (self + i) % pool.nthd;
+    while (job = __sync_fetch_and_add(&rng->head, 1), job < rng->end)
+      pool.fct(pool.cookie, job);
+  }
+}
+
+static void * worker(void * arg)
+{
+  const int self = (int) (long) arg;
+  unsigned int gen = 0;
+
+  pthread_mutex_lock(&pool.mtx);
+  for (;;) {
+    while (!pool.quit && gen == pool.gen)
+      pthread_cond_wait(&pool.go, &pool.mtx);
+    if (pool.quit)
+      break;
+    gen = pool.gen;
+    pthread_mutex_unlock(&pool.mtx);
+
+    run_jobs(self);
+
+    pthread_mutex_lock(&pool.mtx);
+    if (!--pool.busy)
+      pthread_cond_signal(&pool.done);
+  }
+  pthread_mutex_unlock(&pool.mtx);
+  return 0;
+}
+
+static void stop_workers(void)
+{
+  int i;
+
+  pthread_mutex_lock(&pool.mtx);
+  pool.quit = 1;
+  pthread_cond_broadcast(&pool.go);
+  pthread_mutex_unlock(&pool.mtx);
+  for (i = 1; i < pool.nthd; ++i)
+    pthread_join(pool.thd[i], 0);
+  pool.quit = 0;
+  pool.nthd = 0;
+}
+
+static void start_workers(void)
+{
+  int i, n = req_threads ? req_threads : cpu_count();
+
+  if (n > POOL_MAX)
+    n = POOL_MAX;
+  pool.thd[0] = pthread_self();
+  pool.gen    = 0;
+  for (pool.nthd = 1; pool.nthd < n; ++pool.nthd) {
+    const int w = pool.nthd;
+    if (pthread_create(pool.thd+w, 0, worker, (void *) (long) w)) {
+      msg68_warning("pool68: failed to create worker thread #%d\n", w);
+      break;
+    }
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+    /* The caller is left alone. */
+    if (req_pin && pin_worker(w))
+      msg68_warning("pool68: failed to pin worker thread #%d\n", w);
+#endif
+  }
+  msg68_debug("pool68: %d thread(s)\n", pool.nthd);
+  for (i = 0; i < pool.nthd; ++i)
+    pool.rng[i].head = pool.rng[i].end = 0;
+}
+
+int pool68_threads(int n)
+{
+  if (n < 0)
+    n = 0;
+  if (n > POOL_MAX)
+    n = POOL_MAX;
+  pthread_mutex_lock(&pool.run);
+  req_threads = n;
+  if (pool.nthd)
+    stop_workers();
+  pthread_mutex_unlock(&pool.run);
+  return n ? n : cpu_count();
+}
+
+int pool68_pin(int pin)
+{
+  pthread_mutex_lock(&pool.run);
+  req_pin = !!pin;
+  if (pool.nthd)
+    stop_workers();
+  pthread_mutex_unlock(&pool.run);
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  return req_pin;
+#else
+  return 0;
+#endif
+}
+
+void pool68_run(pool68_job_t fct, void * cookie, int cnt)
+{
+  int i;
+
+  if (cnt <= 0)
+    return;
+
+  pthread_mutex_lock(&pool.run);
+  if (!pool.nthd)
+    start_workers();
+
+  if (pool.nthd == 1 || cnt == 1) {
+    for (i = 0; i < cnt; ++i)
+      fct(cookie, i);
+  } else {
+    /* Same split for the same batch size */
+    for (i = 0; i < pool.nthd; ++i) {
+      pool.rng[i].head = (int) ((long long) cnt *  i    / pool.nthd);
+      pool.rng[i].end  = (int) ((long long) cnt * (i+1) / pool.nthd);
+    }
+    pthread_mutex_lock(&pool.mtx);
+    pool.fct    = fct;
+    pool.cookie = cookie;
+    pool.busy   = pool.nthd - 1;
+    ++pool.gen;
+    pthread_cond_broadcast(&pool.go);
+    pthread_mutex_unlock(&pool.mtx);
+
+    run_jobs(0);
+
+    pthread_mutex_lock(&pool.mtx);
+    while (pool.busy)
+      pthread_cond_wait(&pool.done, &pool.mtx);
+    pthread_mutex_unlock(&pool.mtx);
+  }
+  pthread_mutex_unlock(&pool.run);
+}
+
+void pool68_shutdown(void)
+{
+  pthread_mutex_lock(&pool.run);
+  if (pool.nthd)
+    stop_workers();
+  pthread_mutex_unlock(&pool.run);
+}
+
+#else /* USE_THREADS */
+
+int pool68_threads(int n)
+{
+  req_threads = n;
+  return 1;
+}
+
+int pool68_pin(int pin)
+{
+  req_pin = !!pin;
+  return 0;
+}
+
+void pool68_run(pool68_job_t fct, void * cookie, int cnt)
+{
+  int i;
+  for (i = 0; i < cnt; ++i)
+    fct(cookie, i);
+}
+
+void pool68_shutdown(void)
+{
+}
+
+#endif /* USE_THREADS */
@@ -0,0 +1,263 @@
+/*
+ * @file    stream68.c
+ * @brief   sc68 producer thread and PCM ring
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include "sc68_private.h"
+
+#include <sc68/file68_vfs.h> /* Need vfs68.h before sc68.h */
+#include "sc68.h"
+
+#include <sc68/file68_msg.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_PTHREAD_H) && defined(HAVE_UNISTD_H) && defined(__GNUC__)
+# define USE_THREADS 1
+# include <pthread.h>
+# include <unistd.h>
+#endif
+
+#ifdef USE_THREADS
+
+enum {
+  RING_MIN   = 1 << 10,                 /* minimum ring size (PCM) */
+  RING_MAX   = 1 << 20,                 /* maximum ring size (PCM) */
+  RING_CHUNK = 8                        /* chunks per ring         */
+};
+
+/* Ring positions are free running counters. The producer only writes
+ * wpos, the consumer only writes rpos. */
+#if defined(__ATOMIC_ACQUIRE)
+# define load_acquire(P)    __atomic_load_n((P), __ATOMIC_ACQUIRE)
+# define store_release(P,V) __atomic_store_n((P), (V), __ATOMIC_RELEASE)
+#else
+# define load_acquire(P)    (__sync_synchronize(), *(P))
+# define store_release(P,V) (__sync_synchronize(), *(P) = (V))
+#endif
+
+struct sc68_stream_s {
+  sc68_t        * sc68;                 /* instance                     */
+  pthread_t       thd;                  /* producer thread              */
+  pthread_mutex_t mtx;                  /* held while rendering         */
+  char          * ring;                 /* PCM ring                     */
+  int             pcmsz;                /* bytes per PCM                */
+  unsigned int    mask;                 /* ring size - 1                */
+  int             chunk;                /* PCM per sc68_process() call  */
+  int             nap;                  /* sleep when full (us)         */
+  unsigned int    wpos;                 /* write position (producer)    */
+  unsigned int    rpos;                 /* read position (consumer)     */
+  unsigned int    flush_pos;            /* consumer restart position    */
+  unsigned int    flush_req;            /* flush request counter        */
+  unsigned int    flush_ack;            /* flush counter (consumer)     */
+  int             status;               /* SC68_END/SC68_ERROR (0:run)  */
+  int             quit;                 /* producer must exit           */
+};
+
+/* Bytes per PCM of the instance current format. */
+static int pcm_size(sc68_t * sc68)
+{
+  return sc68_cntl(sc68, SC68_GET_PCM) == SC68_PCM_F32 ? 8 : 4;
+}
+
+static void * producer(void * arg)
+{
+  sc68_stream_t * const st = arg;
+  const unsigned int size = st->mask + 1;
+
+  while (!load_acquire(&st->quit)) {
+    unsigned int wpos, off;
+    int n, ret;
+
+    pthread_mutex_lock(&st->mtx);
+    wpos = st->wpos;
+    off  = wpos & st->mask;
+    n    = size - (wpos - load_acquire(&st->rpos));
+    if (st->status || n < st->chunk) {
+      pthread_mutex_unlock(&st->mtx);
+      usleep(st->nap);
+      continue;
+    }
+    /* Contiguous part only */
+    n = st->chunk;
+    if (off + n > size)
+      n = size - off;
+    ret = sc68_process(st->sc68, st->ring + off * st->pcmsz, &n);
+    store_release(&st->wpos, wpos + n);
+    if (ret == SC68_ERROR)
+      store_release(&st->status, SC68_ERROR);
+    else if (ret & SC68_END)
+      store_release(&st->status, SC68_END);
+    pthread_mutex_unlock(&st->mtx);
+  }
+  return 0;
+}
+
+sc68_stream_t * sc68_stream_create(sc68_t * sc68, int pcm)
+{
+  sc68_stream_t * st;
+  int size, spr;
+
+  if (!sc68 || pcm <= 0)
+    return 0;
+  for (size = RING_MIN; size < pcm && size < RING_MAX; size <<= 1)
+    ;
+  spr = sc68_cntl(sc68, SC68_GET_SPR);
+  if (spr <= 0)
+    spr = 44100;
+
+  st = calloc(1, sizeof(*st));
+  if (!st)
+    return 0;
+  st->sc68  = sc68;
+  st->pcmsz = pcm_size(sc68);
+  st->mask  = size - 1;
+  st->chunk = size / RING_CHUNK;
+  st->nap   = (int) ((long long) st->chunk * 500000 / spr);
+  st->ring  = malloc((size_t) size * st->pcmsz);
+  if (!st->ring || pthread_mutex_init(&st->mtx, 0)) {
+    free(st->ring);
+    free(st);
+    return 0;
+  }
+  if (pthread_create(&st->thd, 0, producer, st)) {
+    msg68_error("libsc68: %s\n", "failed to create producer thread");
+    pthread_mutex_destroy(&st->mtx);
+    free(st->ring);
+    free(st);
+    return 0;
+  }
+  return st;
+}
+
+void sc68_stream_destroy(sc68_stream_t * st)
+{
+  if (st) {
+    store_release(&st->quit, 1);
+    pthread_join(st->thd, 0);
+    pthread_mutex_destroy(&st->mtx);
+    free(st->ring);
+    free(st);
+  }
+}
+
+int sc68_stream_read(sc68_stream_t * st, void * buf, int * n)
+{
+  const unsigned int size = st ? st->mask + 1 : 0;
+  unsigned int rpos, wpos, avail, off, req;
+  int status, len, ret = 0;
+
+  if (!st || !buf || !n || *n < 0)
+    return SC68_ERROR;
+
+  /* Read a flush request before the write position so that the
+   * restart position is never ahead of it, and the status before
+   * the write position so that no PCM rendered before the end can
+   * be missed. */
+  rpos   = st->rpos;
+  req    = load_acquire(&st->flush_req);
+  if (req != st->flush_ack) {
+    st->flush_ack = req;
+    rpos = load_acquire(&st->flush_pos);
+  }
+  status = load_acquire(&st->status);
+  wpos   = load_acquire(&st->wpos);
+
+  if ((int) (wpos - rpos) < 0)
+    rpos = wpos;                        /* empty ring */
+  avail = wpos - rpos;
+  len   = avail < (unsigned int) *n ? (int) avail : *n;
+  off   = rpos & st->mask;
+  if (off + len > size) {
+    const int part = size - off;
+    memcpy(buf, st->ring + off * st->pcmsz, part * st->pcmsz);
+    memcpy((char *) buf + part * st->pcmsz, st->ring,
+           (len - part) * st->pcmsz);
+  } else {
+    memcpy(buf, st->ring + off * st->pcmsz, len * st->pcmsz);
+  }
+  store_release(&st->rpos, rpos + len);
+
+  if (len < *n)
+    ret = (status && len == (int) avail) ? status : SC68_IDLE;
+  *n = len;
+  return ret;
+}
+
+sc68_t * sc68_stream_lock(sc68_stream_t * st)
+{
+  if (!st)
+    return 0;
+  pthread_mutex_lock(&st->mtx);
+  return st->sc68;
+}
+
+void sc68_stream_unlock(sc68_stream_t * st, int flush)
+{
+  if (st) {
+    if (flush) {
+      /* The consumer skips to the current write position */
+      store_release(&st->flush_pos, st->wpos);
+      store_release(&st->flush_req, st->flush_req + 1);
+    }
+    /* The ring is sized for the PCM format at creation time */
+    if (pcm_size(st->sc68) != st->pcmsz) {
+      msg68_error("libsc68: %s\n", "stream PCM format changed");
+      store_release(&st->status, SC68_ERROR);
+    } else {
+      store_release(&st->status, 0);
+    }
+    pthread_mutex_unlock(&st->mtx);
+  }
+}
+
+#else /* USE_THREADS */
+
+sc68_stream_t * sc68_stream_create(sc68_t * sc68, int pcm)
+{
+  msg68_error("libsc68: %s\n", "producer thread not supported");
+  return 0;
+}
+
+void sc68_stream_destroy(sc68_stream_t * st)
+{
+}
+
+int sc68_stream_read(sc68_stream_t * st, void * buf, int * n)
+{
+  return SC68_ERROR;
+}
+
+sc68_t * sc68_stream_lock(sc68_stream_t * st)
+{
+  return 0;
+}
+
+void sc68_stream_unlock(sc68_stream_t * st, int flush)
+{
+}
+
+#endif /* USE_THREADS */
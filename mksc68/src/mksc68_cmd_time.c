@@ -35,6 +35,8 @@
 
 #include <sc68/file68.h>
 #include <sc68/file68_vfs.h>
+#include <sc68/file68_str.h>
+#include <sc68/file68_tdb.h>
 #include <sc68/sc68.h>
 #include <emu68/emu68.h>
 #include <emu68/excep68.h>
@@ -45,6 +47,7 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <errno.h>
+#include <unistd.h>
 #include <pthread.h>
 
 enum {
@@ -108,6 +111,10 @@ static const opt_t longopts[] = {
   { "pass-time",  1, 0, 'p' },          /* search pass time        */
   { "silent",     1, 0, 's' },          /* silent detection length */
   { "memory",     1, 0, 'm' },          /* 68k memory size  */
+  { "batch",      0, 0, 'b' },          /* arguments are files     */
+  { "jobs",       1, 0, 'j' },          /* number of workers       */
+  { "csv",        1, 0, 'o' },          /* batch results to CSV    */
+  { "no-db",      0, 0, 'n' },          /* do not update timedb    */
   { 0,0,0,0 }
 };
 
@@ -143,6 +150,7 @@ struct measureinfo_s {
   pthread_t     thread;     /* thread instance.  */
 
   int           track;      /* track to measure. */
+  disk68_t    * disk;       /* disk to measure.  */
   sc68_t      * sc68;       /* sc68 instance.    */
   emu68_t     * emu68;      /* emu68 instance.   */
   io68_t     ** ios68;      /* other chip.       */
@@ -396,11 +404,9 @@ static void mw_wl(io68_t * pio) {
 
 static measureinfo_t measureinfo;
 
-static const char * vectorname(int vector)
+static const char * vectorname(int vector, char * tmp)
 {
-  static char tmp[64];
-  emu68_exception_name(vector,tmp);
-  return tmp;
+  return emu68_exception_name(vector,tmp);
 }
 
 extern void sc68_emulators(sc68_t *, emu68_t **, io68_t ***);
@@ -600,7 +606,7 @@ static int unhook_ios(measureinfo_t * mi)
 static void timemeasure_hdl(emu68_t* const emu68, int vector, void * cookie)
 {
   measureinfo_t * mi = cookie;
-  assert(mi == &measureinfo);
+  assert(mi);
 
   /* Detect and ignore system timer-C */
   if (vector == TIMER_C) {
@@ -654,7 +660,7 @@ static void timemeasure_init(measureinfo_t * mi)
   emu68_set_cookie(mi->emu68, mi);
 
   /* open the disk */
-  disk = dsk_get_disk();
+  disk = mi->disk;
   if (sc68_open(mi->sc68, disk) < 0)
     return;
 
@@ -940,7 +946,7 @@ static void timemeasure_run(measureinfo_t * mi)
   for (i=0; i<sizeof(mi->vector)/sizeof(*mi->vector); ++i)
     if (mi->vector[i].cnt)
       msginf("vector #%03d \"%s\" triggered %d times fist:%u last:%u\n",
-             i, vectorname(i),
+             i, vectorname(i,str),
              mi->vector[i].cnt, mi->vector[i].fst, mi->vector[i].lst);
 
   if (!mi->hw.bit.ym && !mi->hw.bit.mw && !mi->hw.bit.pl) {
@@ -1013,7 +1019,7 @@ static void * time_thread(void * userdata)
   addr68_t range_min, range_max;
   hw_t hardware;
 
-  assert( mi == &measureinfo );
+  assert( mi && mi->disk );
 
   /* First pass detects the music time. */
   timemeasure_init(mi);
@@ -1051,6 +1057,20 @@ static void * time_thread(void * userdata)
 }
 
 
+/* Set hardware flags from the detected hardware. */
+static void timemeasure_hwflags(measureinfo_t * mi)
+{
+  mi->hwflags  = 0;
+  mi->hwflags |= SC68_XTD;
+  mi->hwflags |= mi->hw.bit.ym ? SC68_PSG : 0;
+  mi->hwflags |= mi->hw.bit.mw ? SC68_DMA|SC68_LMC : 0;
+  mi->hwflags |= mi->hw.bit.pl ? SC68_AGA : 0;
+  mi->hwflags |= mi->hw.bit.ta ? SC68_MFP_TA : 0;
+  mi->hwflags |= mi->hw.bit.tb ? SC68_MFP_TB : 0;
+  mi->hwflags |= mi->hw.bit.tc ? SC68_MFP_TC : 0;
+  mi->hwflags |= mi->hw.bit.td ? SC68_MFP_TD : 0;
+}
+
 static
 int time_measure(measureinfo_t * mi, int trk,
                  int stp_ms, int max_ms, int sil_ms, int log2mem)
@@ -1087,6 +1107,7 @@ int time_measure(measureinfo_t * mi, int trk,
   mi->max_ms = max_ms;
   mi->sil_ms = sil_ms;
   mi->track  = trk;
+  mi->disk   = d;
   mi->log2mem = log2mem;
 
   if ( pthread_create(&mi->thread, 0, time_thread, mi) ) {
@@ -1125,15 +1146,7 @@ int time_measure(measureinfo_t * mi, int trk,
     m->has.time = 1;
     m->has.loop = 1;
 
-    mi->hwflags  = 0;
-    mi->hwflags |= SC68_XTD;
-    mi->hwflags |= mi->hw.bit.ym ? SC68_PSG : 0;
-    mi->hwflags |= mi->hw.bit.mw ? SC68_DMA|SC68_LMC : 0;
-    mi->hwflags |= mi->hw.bit.pl ? SC68_AGA : 0;
-    mi->hwflags |= mi->hw.bit.ta ? SC68_MFP_TA : 0;
-    mi->hwflags |= mi->hw.bit.tb ? SC68_MFP_TB : 0;
-    mi->hwflags |= mi->hw.bit.tc ? SC68_MFP_TC : 0;
-    mi->hwflags |= mi->hw.bit.td ? SC68_MFP_TD : 0;
+    timemeasure_hwflags(mi);
 
     /* mi->minaddr; */
     /* mi->maxaddr; */
@@ -1161,6 +1174,201 @@ error:
   return ret;
 }
 
+/* Batch mode.
+ *
+ * Files are dispatched to a pool of workers. Each worker loads its
+ * own copy of the disk and measures all its tracks with its own sc68
+ * and emu68 instances, so that workers never share emulator state.
+ * Results are streamed to the time database and/or a CSV file as
+ * soon as a track is measured.
+ */
+typedef struct {
+  pthread_mutex_t lock;       /* protects everything below the line */
+  char         ** files;      /* files to measure                   */
+  int             nfiles;     /* number of files                    */
+  int             stp_ms;     /* search depth increment             */
+  int             max_ms;     /* maximum search time                */
+  int             sil_ms;     /* length of silence                  */
+  int             log2mem;    /* 68K memory size                    */
+  int             usedb;      /* update the time database           */
+  /* ---------------------------------------------------------------- */
+  FILE          * csv;        /* CSV output (0:none)                */
+  int             next;       /* next file to measure               */
+  int             tracks;     /* number of measured tracks          */
+  int             errors;     /* number of failures                 */
+} batch_t;
+
+/* Convert sc68 hardware flags to time database flags. */
+static int tdb_flags(const hwflags68_t hwflags)
+{
+  int flags = (hwflags >> SC68_MFP_BIT) & (TDB_TA|TDB_TB|TDB_TC|TDB_TD);
+  if (hwflags & SC68_PSG)
+    flags |= TDB_PSG;
+  if (hwflags & SC68_DMA)
+    flags |= TDB_STE;
+  return flags;
+}
+
+static int is_sndh(const disk68_t * d)
+{
+  const char * genre = file68_tag_get(d, 0, TAG68_GENRE);
+  return genre && !strcmp68(genre, "sndh");
+}
+
+static void batch_result(batch_t * b, const char * fname,
+                         const disk68_t * d, measureinfo_t * mi)
+{
+  char s1[32],s2[32],s3[32];
+
+  if (!mi->code)
+    timemeasure_hwflags(mi);
+
+  pthread_mutex_lock(&b->lock);
+  ++b->tracks;
+  b->errors += !!mi->code;
+
+  if (!mi->code && mi->frames && b->usedb && is_sndh(d))
+    if (timedb68_add(d->hash, mi->track-1, mi->frames,
+                     tdb_flags(mi->hwflags)) < 0)
+      msgwrn("%s #%02d: failed to add to timedb\n", fname, mi->track);
+
+  if (b->csv) {
+    fprintf(b->csv, "\"%s\",%08x,%d,%d,%u,%u,%u,%u,\"%s\"\n",
+            fname, (unsigned) d->hash, mi->track, mi->code,
+            mi->frames, mi->timems, mi->loopfr, mi->loopms,
+            mi->code ? "" : str_hardware(s1,sizeof(s1),mi->hwflags));
+    fflush(b->csv);
+  }
+  pthread_mutex_unlock(&b->lock);
+
+  if (!mi->code)
+    msginf("%s #%02d - %s + %s [%s]\n", fname, mi->track,
+           str_timefmt(s1,sizeof(s1),mi->timems),
+           mi->loopms ? str_timefmt(s2,sizeof(s2),mi->loopms) : "no loop",
+           str_hardware(s3,sizeof(s3),mi->hwflags));
+  else
+    msgerr("%s #%02d: failed to measure (%d)\n", fname, mi->track, mi->code);
+}
+
+static void * batch_thread(void * userdata)
+{
+  batch_t * const b = (batch_t *) userdata;
+  measureinfo_t * const mi = malloc(sizeof(*mi));
+
+  if (!mi)
+    return 0;
+
+  for (;;) {
+    const char * fname;
+    disk68_t * d;
+    int idx, trk;
+
+    pthread_mutex_lock(&b->lock);
+    idx = b->next++;
+    pthread_mutex_unlock(&b->lock);
+    if (idx >= b->nfiles)
+      break;
+
+    fname = b->files[idx];
+    d = file68_load_uri(fname);
+    if (!d) {
+      msgerr("%s: failed to load\n", fname);
+      pthread_mutex_lock(&b->lock);
+      ++b->errors;
+      pthread_mutex_unlock(&b->lock);
+      continue;
+    }
+
+    for (trk = 1; trk <= d->nb_mus; ++trk) {
+      memset(mi,0,sizeof(*mi));
+      mi->stp_ms  = b->stp_ms;
+      mi->max_ms  = b->max_ms;
+      mi->sil_ms  = b->sil_ms;
+      mi->track   = trk;
+      mi->disk    = d;
+      mi->log2mem = b->log2mem;
+      time_thread(mi);
+      batch_result(b, fname, d, mi);
+    }
+    file68_free(d);
+  }
+  free(mi);
+
+  return b;
+}
+
+static int online_cpus(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int) n : 1;
+#else
+  return 1;
+#endif
+}
+
+static
+int time_batch(int nfiles, char ** files, int jobs, const char * csvname,
+               int usedb, int stp_ms, int max_ms, int sil_ms, int log2mem)
+{
+  batch_t b;
+  pthread_t * threads;
+  int i, n, ret = EXIT_GENERIC;
+
+  if (log2mem <= 0) log2mem = 23;       /* 8 MiB   */
+  if (log2mem < 17) log2mem = 17;       /* 128 KiB */
+  if (jobs <= 0) jobs = online_cpus();
+  if (jobs > nfiles) jobs = nfiles;
+
+  memset(&b,0,sizeof(b));
+  b.files   = files;
+  b.nfiles  = nfiles;
+  b.stp_ms  = stp_ms;
+  b.max_ms  = max_ms;
+  b.sil_ms  = sil_ms;
+  b.log2mem = log2mem;
+  b.usedb   = usedb;
+
+  if (csvname) {
+    b.csv = strcmp(csvname,"-") ? fopen(csvname,"w") : stdout;
+    if (!b.csv) {
+      msgerr("%s: %s\n", csvname, strerror(errno));
+      return ret;
+    }
+    fprintf(b.csv,
+            "file,hash,track,code,frames,time_ms,loop_fr,loop_ms,hw\n");
+  }
+
+  threads = malloc(jobs * sizeof(*threads));
+  if (!threads)
+    goto error;
+  pthread_mutex_init(&b.lock,0);
+
+  msgdbg("time_batch() files:%d jobs:%d stp:%dms, max:%dms sil:%dms mem:%dKiB\n",
+         nfiles, jobs, stp_ms, max_ms, sil_ms, 1<<(log2mem-10));
+
+  for (n = 0; n < jobs; ++n)
+    if (pthread_create(threads+n, 0, batch_thread, &b)) {
+      msgerr("failed to create time thread #%d\n", n);
+      break;
+    }
+  for (i = 0; i < n; ++i)
+    pthread_join(threads[i], 0);
+
+  pthread_mutex_destroy(&b.lock);
+  free(threads);
+
+  msginf("%d track(s) measured in %d file(s), %d error(s)\n",
+         b.tracks, nfiles, b.errors);
+  if (n > 0 && b.next >= nfiles && !b.errors)
+    ret = EXIT_OK;
+
+error:
+  if (b.csv && b.csv != stdout)
+    fclose(b.csv);
+  return ret;
+}
+
 static
 int run_time(cmd_t * cmd, int argc, char ** argv)
 {
@@ -1169,6 +1377,8 @@ int run_time(cmd_t * cmd, int argc, char ** argv)
   int i, tracks;
   const char * tracklist = 0;
   int max_ms = MAX_TIME, sil_ms = SILENCE_TIME, stp_ms = PASS_TIME, log2mem = 0;
+  int batch = 0, jobs = 0, usedb = 1;
+  const char * csvname = 0;
 
   opt_create_short(shortopts, longopts);
 
@@ -1198,6 +1408,17 @@ int run_time(cmd_t * cmd, int argc, char ** argv)
       if (isdigit((int)*optarg))
         log2mem = strtol(optarg,0,0);
       break;
+    case 'b':                           /* --batch     */
+      batch = 1; break;
+    case 'j':                           /* --jobs      */
+      if (isdigit((int)*optarg))
+        jobs = strtol(optarg,0,0);
+      batch = 1; break;
+    case 'o':                           /* --csv       */
+      csvname = optarg;
+      batch = 1; break;
+    case 'n':                           /* --no-db     */
+      usedb = 0; break;
     case '?':                       /* Unknown or missing parameter */
       goto error;
     default:
@@ -1211,6 +1432,15 @@ int run_time(cmd_t * cmd, int argc, char ** argv)
   /* if (i < argc) */
   /*   msgwrn("%d extra parameters ignored\n", argc-i); */
 
+  if (batch) {
+    if (i == argc) {
+      msgerr("missing file argument for batch mode\n");
+      goto error;
+    }
+    return time_batch(argc-i, argv+i, jobs, csvname,
+                      usedb, stp_ms, max_ms, sil_ms, log2mem);
+  }
+
   if (!dsk_has_disk()) {
     msgerr("no disk loaded\n");
     goto error;
@@ -1251,7 +1481,7 @@ cmd_t cmd_time = {
   /* run */ run_time,
   /* com */ "time",
   /* alt */ 0,
-  /* use */ "[opts] [TRACKS ...]",
+  /* use */ "[opts] [TRACKS ...] | -b [opts] FILE ...",
   /* des */ "Autodetect track duration",
   /* hlp */
   "The `time' command run sc68 music emulator in a special way that allows\n"
@@ -1260,10 +1490,18 @@ cmd_t cmd_time = {
   "TRACKS\n"
   "  List of tracks (eg: 1,2-5,7), or all.\n"
   "\n"
+  "In batch mode all tracks of the given files are measured by a pool of\n"
+  "workers. The loaded disk is left untouched. Results of sndh files are\n"
+  "stored in the time database.\n"
+  "\n"
   "OPTIONS\n"
   /* *****************   ********************************************** */
   "  -s --silent=MS      Duration for silent detection (0:disable).\n"
   "  -M --max-time=MS    Maximum time.\n"
   "  -p --pass-time=MS   Search pass duration.\n"
-  "  -m --memory=N       68k memory size of 2^N bytes (default:23 -> 8MiB."
+  "  -m --memory=N       68k memory size of 2^N bytes (default:23 -> 8MiB.\n"
+  "  -b --batch          Batch mode, measure all tracks of FILE ...\n"
+  "  -j --jobs=N         Number of batch workers (default:online CPUs).\n"
+  "  -o --csv=FILE       Write batch results to a CSV file (`-' stdout).\n"
+  "  -n --no-db          Do not update the time database."
 };
@@ -0,0 +1,169 @@
+/*
+ * @file    batchbench68.c
+ * @brief   sc68 batch processing benchmark
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Renders the same duration with N instances, first one instance
+ * after the other with sc68_process() then all together with
+ * sc68_process_many(). Checks both produce the same PCM and prints
+ * the aggregate realtime factor (seconds of audio rendered per
+ * second of wall time).
+ *
+ * usage: batchbench68 URI [instances [seconds [threads [PCM-per-call]]]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <sc68/sc68.h>
+
+enum { SPR = 44100 };
+
+static double now(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec * 1E-6;
+}
+
+/* FNV-1a of the rendered PCM */
+static unsigned int hash(unsigned int h, const void * buf, int n)
+{
+  const unsigned char * p = buf;
+  while (n--)
+    h = (h ^ *p++) * 16777619u;
+  return h;
+}
+
+static sc68_t * create(const char * uri, int track)
+{
+  sc68_create_t c;
+  sc68_t * sc68;
+
+  memset(&c, 0, sizeof(c));
+  c.sampling_rate = SPR;
+  sc68 = sc68_create(&c);
+  if (!sc68 || sc68_load_uri(sc68, uri) || sc68_play(sc68, track, 1) < 0) {
+    fprintf(stderr, "batchbench68: failed to play -- %s:%d\n", uri, track);
+    sc68_destroy(sc68);
+    return 0;
+  }
+  return sc68;
+}
+
+int main(int argc, char ** argv)
+{
+  const char * uri = argc > 1 ? argv[1] : 0;
+  const int cnt = argc > 2 ? atoi(argv[2]) : 64;
+  const int sec = argc > 3 ? atoi(argv[3]) : 10;
+  const int thd = argc > 4 ? atoi(argv[4]) : 0;
+  const int len = argc > 5 ? atoi(argv[5]) : 1024;
+  sc68_batch_t * batch;
+  unsigned int * h1, * h2;
+  unsigned int * buf;
+  double t1, t2, audio;
+  int i, k, tracks, total, err = 0;
+
+  if (!uri || cnt <= 0 || sec <= 0 || thd < 0 || len <= 0) {
+    fprintf(stderr,
+            "usage: batchbench68 URI"
+            " [instances [seconds [threads [PCM-per-call]]]]\n");
+    return 1;
+  }
+
+  if (sc68_init(0))
+    return 2;
+  sc68_cntl(0, SC68_SET_OPT_INT, "threads", thd);
+
+  batch = calloc(cnt, sizeof(*batch));
+  buf   = malloc((size_t) cnt * len * sizeof(*buf));
+  h1    = calloc(cnt, sizeof(*h1));
+  h2    = calloc(cnt, sizeof(*h2));
+  if (!batch || !buf || !h1 || !h2) {
+    fprintf(stderr, "batchbench68: alloc error\n");
+    return 2;
+  }
+  total = (int) ((long long) SPR * sec / len);
+  audio = (double) total * len * cnt / SPR;
+
+  /* Spread the tracks of the disk over the instances */
+  batch[0].sc68 = create(uri, 1);
+  if (!batch[0].sc68)
+    return 3;
+  tracks = sc68_cntl(batch[0].sc68, SC68_GET_TRACKS);
+  if (tracks < 1)
+    tracks = 1;
+
+  /* One after the other */
+  for (i = 0; i < cnt; ++i) {
+    if (!batch[i].sc68 && !(batch[i].sc68 = create(uri, 1 + i % tracks)))
+      return 3;
+    h1[i] = h2[i] = 2166136261u;
+  }
+  t1 = now();
+  for (k = 0; k < total; ++k)
+    for (i = 0; i < cnt; ++i) {
+      int n = len;
+      if (sc68_process(batch[i].sc68, buf + i * len, &n) == SC68_ERROR)
+        ++err;
+      h1[i] = hash(h1[i], buf + i * len, n * sizeof(*buf));
+    }
+  t1 = now() - t1;
+
+  /* All together */
+  for (i = 0; i < cnt; ++i) {
+    sc68_destroy(batch[i].sc68);
+    if (!(batch[i].sc68 = create(uri, 1 + i % tracks)))
+      return 3;
+    batch[i].buf = buf + i * len;
+  }
+  t2 = now();
+  for (k = 0; k < total; ++k) {
+    for (i = 0; i < cnt; ++i)
+      batch[i].n = len;
+    err += sc68_process_many(batch, cnt);
+    for (i = 0; i < cnt; ++i)
+      h2[i] = hash(h2[i], batch[i].buf, batch[i].n * sizeof(*buf));
+  }
+  t2 = now() - t2;
+
+  for (i = 0; i < cnt; ++i)
+    err += h1[i] != h2[i];
+
+  printf("%d instances x %d s, %d PCM per call\n", cnt, sec, len);
+  printf("%-20s %8.2f s %8.1fx realtime\n",
+         "sc68_process", t1, audio / t1);
+  printf("%-20s %8.2f s %8.1fx realtime %6.2fx speedup  %s\n",
+         "sc68_process_many", t2, audio / t2, t1 / t2,
+         err ? "MISMATCH" : "ok");
+
+  for (i = 0; i < cnt; ++i)
+    sc68_destroy(batch[i].sc68);
+  sc68_shutdown();
+  free(batch);
+  free(buf);
+  free(h1);
+  free(h2);
+  return !!err;
+}
@@ -0,0 +1,209 @@
+/*
+ * @file    bench68.c
+ * @brief   sc68 playback throughput benchmark
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Renders every track of a corpus for a fixed duration with each YM
+ * engine and filter and prints one CSV line per run:
+ *
+ *   uri,track,hw,engine,filter,seconds,wall,realtime,pcm_per_sec,
+ *   inst_per_sec,irq_per_sec,ym_per_sec,peak_rss_kb
+ *
+ * hw is a '+' separated list of ym, ste and amiga. Pick tracks
+ * covering YM only, STE DMA, Paula and timer heavy digi drums. The
+ * filter only applies to the pulse engine. Peak RSS is the process
+ * one so far.
+ *
+ * usage: bench68 [-s seconds] [-r hz] [-e engines] [-f filters]
+ *                URI[@track] ...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <sc68/sc68.h>
+
+enum { PCM_PER_CALL = 1024 };
+
+static const char def_engines[] = "pulse,blep";
+static const char def_filters[] = "2-poles,mixed,1-pole,boxcar,none";
+
+static double now(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec * 1E-6;
+}
+
+static long peak_rss_kb(void)
+{
+  struct rusage ru;
+  return getrusage(RUSAGE_SELF, &ru) ? -1 : ru.ru_maxrss;
+}
+
+/* Next item of a comma separated list (modified in place). */
+static char * next_item(char ** list)
+{
+  char * item = *list, * comma;
+
+  if (!item || !*item)
+    return 0;
+  comma = strchr(item, ',');
+  if (comma)
+    *comma++ = 0;
+  *list = comma;
+  return item;
+}
+
+/* Render a track for sec seconds and print the result line. */
+static int bench(const char * uri, int track, int spr, int sec,
+                 const char * engine, const char * filter)
+{
+  static unsigned int buf[PCM_PER_CALL];
+  sc68_create_t c;
+  sc68_minfo_t info;
+  sc68_perf_t perf;
+  sc68_t * sc68;
+  double wall;
+  char hw[32];
+  int left, code = 0;
+
+  sc68_cntl(0, SC68_SET_OPT_STR, "ym-engine", engine);
+  if (filter)
+    sc68_cntl(0, SC68_SET_OPT_STR, "ym-filter", filter);
+
+  memset(&c, 0, sizeof(c));
+  c.sampling_rate = spr;
+  sc68 = sc68_create(&c);
+  if (!sc68 || sc68_load_uri(sc68, uri) ||
+      sc68_play(sc68, track, SC68_INF_LOOP) < 0) {
+    fprintf(stderr, "bench68: failed to play -- %s@%d\n", uri, track);
+    sc68_destroy(sc68);
+    return -1;
+  }
+  sc68_cntl(sc68, SC68_SET_PERF, 1);
+
+  wall = now();
+  for (left = spr * sec; left > 0; left -= PCM_PER_CALL) {
+    int n = PCM_PER_CALL;
+    code = sc68_process(sc68, buf, &n);
+    if (code == SC68_ERROR)
+      break;
+  }
+  wall = now() - wall;
+
+  sc68_cntl(sc68, SC68_GET_PERF, &perf);
+  strcpy(hw, "?");
+  if (!sc68_music_info(sc68, &info, SC68_CUR_TRACK, 0))
+    sprintf(hw, "%s%s%s%s%s",
+            info.trk.ym ? "ym" : "",
+            info.trk.ym && (info.trk.ste|info.trk.amiga) ? "+" : "",
+            info.trk.ste ? "ste" : "",
+            info.trk.ste && info.trk.amiga ? "+" : "",
+            info.trk.amiga ? "amiga" : "");
+  if (wall <= 0)
+    wall = 1E-6;
+
+  printf("%s,%d,%s,%s,%s,%d,%.3f,%.2f,%.0f,%.0f,%.0f,%.0f,%ld\n",
+         uri, sc68_cntl(sc68, SC68_GET_TRACK), hw,
+         engine, filter ? filter : "-", sec, wall,
+         (double) perf.pcm / spr / wall,
+         perf.pcm / wall,
+         perf.insts / wall,
+         perf.irqs / wall,
+         perf.ymevents / wall,
+         peak_rss_kb());
+  fflush(stdout);
+
+  sc68_destroy(sc68);
+  return code == SC68_ERROR ? -1 : 0;
+}
+
+static int usage(void)
+{
+  fprintf(stderr,
+          "usage: bench68 [-s seconds] [-r hz] [-e engines] [-f filters]"
+          " URI[@track] ...\n"
+          "  defaults: -s 30 -r 44100 -e %s -f %s\n",
+          def_engines, def_filters);
+  return 1;
+}
+
+int main(int argc, char ** argv)
+{
+  const char * engines = def_engines, * filters = def_filters;
+  int sec = 30, spr = 44100, i, err = 0;
+
+  for (i = 1; i < argc && argv[i][0] == '-'; i += 2) {
+    if (i + 1 >= argc)
+      return usage();
+    switch (argv[i][1]) {
+    case 's': sec     = atoi(argv[i+1]); break;
+    case 'r': spr     = atoi(argv[i+1]); break;
+    case 'e': engines = argv[i+1];       break;
+    case 'f': filters = argv[i+1];       break;
+    default:  return usage();
+    }
+  }
+  if (i >= argc || sec <= 0 || spr <= 0)
+    return usage();
+
+  if (sc68_init(0))
+    return 2;
+
+  printf("uri,track,hw,engine,filter,seconds,wall,realtime,pcm_per_sec,"
+         "inst_per_sec,irq_per_sec,ym_per_sec,peak_rss_kb\n");
+  fflush(stdout);
+
+  for (; i < argc; ++i) {
+    char uri[1024], elist[256], * e, * eptr, * at;
+    int track = SC68_DEF_TRACK;
+
+    strncpy(uri, argv[i], sizeof(uri) - 1);
+    uri[sizeof(uri) - 1] = 0;
+    at = strrchr(uri, '@');
+    if (at) {
+      *at = 0;
+      track = atoi(at + 1);
+    }
+
+    strncpy(elist, engines, sizeof(elist) - 1);
+    elist[sizeof(elist) - 1] = 0;
+    for (eptr = elist; (e = next_item(&eptr)) != 0; ) {
+      if (!strcmp(e, "pulse")) {
+        char flist[256], * f, * fptr;
+        strncpy(flist, filters, sizeof(flist) - 1);
+        flist[sizeof(flist) - 1] = 0;
+        for (fptr = flist; (f = next_item(&fptr)) != 0; )
+          err |= bench(uri, track, spr, sec, e, f);
+      } else {
+        err |= bench(uri, track, spr, sec, e, 0);
+      }
+    }
+  }
+
+  sc68_shutdown();
+  return !!err;
+}
@@ -83,19 +83,21 @@ static void outf(const char * format, ...)
 static int Usage(void)
 {
   printf(
-    "Usage: gen68 [-hvqDV] (T|[0-F])*|all [prefix]\n"
+    "Usage: gen68 [-hvqDV] (T|O|[0-F])*|all [prefix]\n"
     "\n"
     " 'C' code generator for sc68 project.\n"
     "\n"
     " T     Generate function table\n"
+    " O     Generate op-word table (EMU68_OPTABLE)\n"
     " 0-F   Generate code for given lines\n"
-    " all   Generate all (equiv. 0123456789ABCDEFT)\n"
+    " all   Generate all (equiv. 0123456789ABCDEFTO)\n"
     "\n"
     " If no prefix was given output is stdout.\n"
     "\n"
     " If prefix is given output is done in file(s)\n"
     " - <prefix>line<X>.c for lines 0 to F\n"
     " - <prefix>table.c for function table\n"
+    " - <prefix>optable.c for op-word table\n"
     "\n"
     "Copyright (c) 1998-2016 Benjamin Gerard\n"
     );
@@ -1847,6 +1849,37 @@ static void gene_funky4(void)
   outf(TAB"funky4_func[mode](emu68,reg0);\n");
 }
 
+/* Line 4 handlers with reg9 (and mode) resolved for the op-word
+ * table. They replace the line4_X_func[reg9] dispatch and for the
+ * funky instructions (RTS, NOP ...) the funky4 ones too.
+ */
+static void gene_line4_optable(void)
+{
+  int r, s, m;
+
+  outf("#ifdef EMU68_OPTABLE\n\n");
+  for ( s = 0; s < 4; ++s ) {
+    for ( r = 0; r < 8; ++r ) {
+      for ( m = 0; m < 8; ++m ) {
+        outf("DECL_LINE68(op4_r%d_s%d_m%d)\n{\n", r, s, m);
+        if ( r != 7 || s != 1 )
+          outf(TAB"line4_r%d_s%d(emu68,%d,reg0);\n", r, s, m);
+        else if ( m != 6 )
+          outf(TAB"funky4_m%d(emu68,reg0);\n", m);
+        else
+          outf(TAB"funky4_m6_func[reg0](emu68);\n");
+        outf("}\n\n");
+      }
+    }
+  }
+  for ( r = 0; r < 8; ++r ) {
+    outf("DECL_LINE68(op4_funky_m6_%d)\n{\n", r);
+    outf(TAB"funky4_m6_%d(emu68);\n", r);
+    outf("}\n\n");
+  }
+  outf("#endif\n\n");
+}
+
 static void gene_line4(int n)
 {
   if ( ! n ) {
@@ -1938,6 +1971,8 @@ static void gene_line4(int n)
       }
       outf("\n};\n\n");
     }
+
+    gene_line4_optable();
   }
 
   outf("DECL_LINE68(line4%02X)\n{\n", n);
@@ -1963,6 +1998,84 @@ static void gene_line4(int n)
   outf("}\n\n");
 }
 
+/* 64K op-word table. Filled once from line_func[] and the line 4
+ * handlers with reg9 resolved (see gene_line4_optable()).
+ */
+static void gene_optable(void)
+{
+  int r, s, m;
+
+  outf("#include \"struct68.h\"\n"
+       "\n"
+       "#ifdef EMU68_OPTABLE\n"
+       "\n"
+       "EMU68_EXTERN linefunc68_t *line_func[1024];\n"
+       "\n"
+       "#ifndef EMU68_MONOLITIC\n"
+       "EMU68_EXTERN linefunc68_t");
+  for ( s = 0; s < 4; ++s )
+    for ( r = 0; r < 8; ++r )
+      for ( m = 0; m < 8; ++m ) {
+        if ( ! (m & 3) ) outf("\n"TAB);
+        outf("op4_r%d_s%d_m%d,", r, s, m);
+      }
+  for ( r = 0; r < 8; ++r ) {
+    if ( ! (r & 3) ) outf("\n"TAB);
+    outf("op4_funky_m6_%d%c", r, r == 7 ? ';' : ',');
+  }
+  outf("\n"
+       "#endif\n"
+       "\n");
+
+  outf("/* Line 4 handlers by size, reg9 and mode. */\n"
+       "static linefunc68_t * const line4_ops[4][8][8] = {");
+  for ( s = 0; s < 4; ++s ) {
+    outf("\n"TAB"{");
+    for ( r = 0; r < 8; ++r ) {
+      outf("\n"TAB TAB"{");
+      for ( m = 0; m < 8; ++m ) {
+        if ( m == 4 ) outf("\n"TAB TAB" ");
+        outf("op4_r%d_s%d_m%d,", r, s, m);
+      }
+      outf("},");
+    }
+    outf("\n"TAB"},");
+  }
+  outf("\n};\n\n");
+
+  outf("/* Line 4 funky mode 6 handlers (RESET ... RTR) by reg0. */\n"
+       "static linefunc68_t * const funky4_m6_ops[8] = {");
+  for ( r = 0; r < 8; ++r ) {
+    if ( ! (r & 3) ) outf("\n"TAB);
+    outf("op4_funky_m6_%d,", r);
+  }
+  outf("\n};\n\n");
+
+  outf("linefunc68_t * emu68_optable[0x10000];\n"
+       "\n"
+       "void emu68_optable_init(void)\n"
+       "{\n"
+       TAB"int opw;\n"
+       "\n"
+       TAB"for ( opw = 0; opw < 0x10000; ++opw ) {\n"
+       TAB TAB"const int line = opw >> 12, reg9 = ( opw >> 9 ) & 7;\n"
+       TAB TAB"const int n = ( opw >> 3 ) & 077, reg0 = opw & 7;\n"
+       TAB TAB"linefunc68_t * fn = line_func[ ( line << 6 ) | n ];\n"
+       "\n"
+       TAB TAB"if ( line == 4 && ! ( n & 040 ) ) {\n"
+       TAB TAB TAB"const int s = n >> 3, m = n & 7;\n"
+       TAB TAB TAB"fn = ( reg9 == 7 && s == 1 && m == 6 )\n"
+       TAB TAB TAB TAB"? funky4_m6_ops[reg0]\n"
+       TAB TAB TAB TAB": line4_ops[s][reg9][m]\n"
+       TAB TAB TAB TAB";\n"
+       TAB TAB"}\n"
+       TAB TAB"emu68_optable[opw] = fn;\n"
+       TAB"}\n"
+       "}\n"
+       "\n"
+       "#endif\n");
+}
+
 /*  Create a filename from prefix + name,
  *  @warning return a static string
  */
@@ -2047,7 +2160,7 @@ int main(int na, char **a)
   /* What to generate */
   if ( i < na ) {
     if ( !strcmp(a[i], "all") ) {
-      linetogen = 0x1FFFF;
+      linetogen = 0x3FFFF;
     } else {
       char * s;
       for ( s = a[i]; *s; s++ ) {
@@ -2055,8 +2168,10 @@ int main(int na, char **a)
         else if ((*s>='a' && *s<='f')) linetogen |= 1<<(*s-'a'+10);
         else if ((*s>='A' && *s<='F')) linetogen |= 1<<(*s-'A'+10);
         else if ((*s=='T' || *s=='t')) linetogen |= 1<<16;
+        else if ((*s=='O' || *s=='o')) linetogen |= 1<<17;
         else return
-               error("gen68: parameter `%s'; xdigit or 't' expected\n", a[i]);
+               error("gen68: parameter `%s'; xdigit, 't' or 'o' expected\n",
+                     a[i]);
       }
     }
     ++i;
@@ -2077,7 +2192,7 @@ int main(int na, char **a)
     msg("output to stdout\n");
   }
 
-  for ( l = 0; l < 17; ++l ) {
+  for ( l = 0; l < 18; ++l ) {
     static int first = 1;
     static char fline[] = "lineX.c";
     char * fname   = 0;
@@ -2087,6 +2202,9 @@ int main(int na, char **a)
     if ( l == 16 ) {
       msg("Generating instruction table ...\n");
       fname = "table.c";
+    } else if ( l == 17 ) {
+      msg("Generating op-word table ...\n");
+      fname = "optable.c";
     } else {
       msg("Generating line %X ...\n", l);
       fname = fline;
@@ -2102,8 +2220,10 @@ int main(int na, char **a)
       for ( i = 0; i < 16; ++i )
         if ( linetogen & ( 1 << i ) )
           outf(" * Line %X: %s\n", i, line_name[i]);
-      if ( linetogen & ( 1 << i ) )
+      if ( linetogen & ( 1 << 16 ) )
         outf(" * Table\n");
+      if ( linetogen & ( 1 << 17 ) )
+        outf(" * Op-word table\n");
       outf(" */\n\n");
       first = 0;
     }
@@ -2129,8 +2249,8 @@ int main(int na, char **a)
       case 0xD: gene_line9_D(i,0);     break;
       case 0xE: gene_lineE(i);         break;
       case 0xF: gene_lineA_F(i,0);     break;
-      default:
-        if (!i) gene_table("line",64*16);
+      case 16:  if (!i) gene_table("line",64*16); break;
+      default:  if (!i) gene_optable();
       }
       fflush(output);
     }
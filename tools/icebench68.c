@@ -0,0 +1,148 @@
+/*
+ * @file    icebench68.c
+ * @brief   ICE packer match finders check and benchmark
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Packs every file with each unice68 match finder, checks the packed
+ * data are identical and depack to the original and prints one CSV
+ * line per file:
+ *
+ *   file,size,packed,orig_sec,hash_sec,speedup,check
+ *
+ * ICE packed files (e.g. sndh) are depacked first.
+ *
+ * usage: icebench68 FILE ...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <unice68.h>
+
+static double now(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec * 1E-6;
+}
+
+/* Load a file; depack it if it is ICE packed. */
+static unsigned char * load(const char * path, int * psize)
+{
+  FILE * f;
+  unsigned char * buf = 0, * raw;
+  long len;
+  int dsize, csize = 0;
+
+  f = fopen(path, "rb");
+  if (!f)
+    return 0;
+  if (fseek(f, 0, SEEK_END) || (len = ftell(f)) <= 0 || fseek(f, 0, SEEK_SET))
+    goto out;
+  buf = malloc(len);
+  if (!buf || fread(buf, 1, len, f) != (size_t) len) {
+    free(buf);
+    buf = 0;
+    goto out;
+  }
+  *psize = len;
+
+  if (len >= 12 && (dsize = unice68_depacked_size(buf, &csize)) > 0) {
+    raw = malloc(dsize);
+    if (raw && !unice68_depacker(raw, buf)) {
+      free(buf);
+      buf = raw;
+      *psize = dsize;
+    } else {
+      free(raw);
+    }
+  }
+out:
+  fclose(f);
+  return buf;
+}
+
+/* Pack with a finder; returns packed size and the elapsed time. */
+static int pack(int finder, void * dst, int max, const void * src, int len,
+                double * sec)
+{
+  int plen;
+
+  unice68_packer_finder(finder);
+  *sec = now();
+  plen = unice68_packer(dst, max, src, len);
+  *sec = now() - *sec;
+  return plen;
+}
+
+static int bench(const char * path)
+{
+  unsigned char * src, * orig = 0, * hash = 0, * chk = 0;
+  int len, max, olen, hlen, ok = 0;
+  double osec, hsec;
+
+  src = load(path, &len);
+  if (!src) {
+    fprintf(stderr, "icebench68: failed to load -- %s\n", path);
+    return -1;
+  }
+
+  /* The packer does not check for overflow. */
+  max  = len + len / 2 + 1024;
+  orig = malloc(max);
+  hash = malloc(max);
+  chk  = malloc(len + 64);
+  if (orig && hash && chk) {
+    olen = pack(UNICE68_FINDER_ORIG, orig, max, src, len, &osec);
+    hlen = pack(UNICE68_FINDER_HASH, hash, max, src, len, &hsec);
+    ok = olen > 0 && olen == hlen && !memcmp(orig, hash, olen)
+      && !unice68_depacker(chk, hash) && !memcmp(chk, src, len);
+    if (hsec <= 0)
+      hsec = 1E-6;
+    printf("%s,%d,%d,%.3f,%.3f,%.1f,%s\n",
+           path, len, hlen, osec, hsec, osec / hsec, ok ? "ok" : "FAILED");
+    fflush(stdout);
+  }
+
+  free(chk);
+  free(hash);
+  free(orig);
+  free(src);
+  return ok ? 0 : -1;
+}
+
+int main(int argc, char ** argv)
+{
+  int i, err = 0;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: icebench68 FILE ...\n");
+    return 1;
+  }
+
+  printf("file,size,packed,orig_sec,hash_sec,speedup,check\n");
+  for (i = 1; i < argc; ++i)
+    err |= bench(argv[i]);
+  return !!err;
+}
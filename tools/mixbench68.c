@@ -0,0 +1,165 @@
+/*
+ * @file    mixbench68.c
+ * @brief   sc68 mixer kernels check and benchmark
+ * @author  http://sourceforge.net/users/benjihan
+ *
+ * Copyright (c) 1998-2016 Benjamin Gerard
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Runs every mixer68 kernel of every instruction set available on
+ * this host, checks the output is bit exact with the portable C
+ * reference and prints the throughput.
+ *
+ * usage: mixbench68 [PCM-per-buffer [repeat]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mixer68.h"
+
+enum {
+  K_STEREO_LR, K_STEREO_RL, K_DUP_L, K_DUP_R,
+  K_BLEND, K_MULT, K_FILL, K_COPY, K_MAX
+};
+
+static const char * knames[K_MAX] = {
+  "stereo_16_LR", "stereo_16_RL", "dup_L_to_R", "dup_R_to_L",
+  "blend_LR", "mult_LR", "fill", "copy"
+};
+
+static u32 rnd_state = 0x5C68;
+
+static u32 rnd(void)
+{
+  rnd_state = rnd_state * 1664525u + 1013904223u;
+  return (rnd_state >> 16) | (rnd_state << 16);
+}
+
+/* Parameters for the pass-th call of a kernel. */
+static const int   factors[] = { 0, 1, 255, 16384, 32768, 40000,
+                                 65535, 65536 };
+static const int   mults[]   = { -65536, -65535, -32768, -1, 0, 1, 12345,
+                                 32768, 65535, 65536 };
+static const u32   signs[]   = { 0, 0x8000, 0x80000000, 0x80008000 };
+
+#define ELTOF(A) ((int)(sizeof(A)/sizeof(*(A))))
+
+static void run(int k, int pass, u32 * dst, u32 * src, int n)
+{
+  const u32 s1 = signs[pass % ELTOF(signs)];
+  const u32 s2 = signs[(pass / ELTOF(signs)) % ELTOF(signs)];
+
+  switch (k) {
+  case K_STEREO_LR: mixer68_stereo_16_LR(dst, src, n, s1); break;
+  case K_STEREO_RL: mixer68_stereo_16_RL(dst, src, n, s1); break;
+  case K_DUP_L:     mixer68_dup_L_to_R(dst, src, n, s1);   break;
+  case K_DUP_R:     mixer68_dup_R_to_L(dst, src, n, s1);   break;
+  case K_BLEND:
+    mixer68_blend_LR(dst, src, n, factors[pass % ELTOF(factors)], s1, s2);
+    break;
+  case K_MULT:
+    mixer68_mult_LR(dst, src, n,
+                    mults[pass % ELTOF(mults)],
+                    mults[(pass / ELTOF(mults) + 3) % ELTOF(mults)],
+                    s1, s2);
+    break;
+  case K_FILL:      mixer68_fill(dst, n, s1 ^ pass);         break;
+  case K_COPY:      mixer68_copy(dst, src, n);               break;
+  }
+}
+
+static double now(void)
+{
+  return (double) clock() / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char ** argv)
+{
+  const int len = argc > 1 ? atoi(argv[1]) : 4096;
+  const int rep = argc > 2 ? atoi(argv[2]) : 2000;
+  const int npass = 64;
+  u32 * src, * ref, * out;
+  double tref[K_MAX];
+  int isa, k, i, err = 0;
+
+  if (len <= 0 || rep <= 0) {
+    fprintf(stderr, "usage: mixbench68 [PCM-per-buffer [repeat]]\n");
+    return 1;
+  }
+
+  src = malloc(len * sizeof(u32) + 8);
+  ref = malloc(len * sizeof(u32) * npass * K_MAX);
+  out = malloc(len * sizeof(u32) + 8);
+  if (!src || !ref || !out) {
+    fprintf(stderr, "mixbench68: alloc error\n");
+    return 2;
+  }
+  for (i = 0; i < len; ++i)
+    src[i] = rnd();
+
+  printf("%-12s %-5s %8s %8s  %s\n",
+         "kernel", "isa", "Mpcm/s", "speedup", "check");
+
+  for (isa = MIXER68_ISA_C; isa <= MIXER68_ISA_LAST; ++isa) {
+    if (mixer68_select(isa) != isa)
+      continue;
+    for (k = 0; k < K_MAX; ++k) {
+      int bad = 0, pass;
+      double t;
+
+      /* Check: all parameters, unaligned buffers and odd sizes. */
+      for (pass = 0; pass < npass; ++pass) {
+        const int n = len - (pass & 3);
+        u32 * const s = src + (pass & 1);
+        u32 * const r = ref + (k * npass + pass) * len;
+        u32 * const o = out + ((pass >> 1) & 1);
+
+        run(k, pass, o, s, n);
+        if (isa == MIXER68_ISA_C)
+          memcpy(r, o, n * sizeof(u32));
+        else
+          bad |= !!memcmp(r, o, n * sizeof(u32));
+      }
+      err |= bad;
+
+      /* Throughput */
+      t = now();
+      for (i = 0; i < rep; ++i)
+        run(k, i, out, src, len);
+      t = now() - t;
+      if (t <= 0)
+        t = 1E-6;
+      if (isa == MIXER68_ISA_C)
+        tref[k] = t;
+
+      printf("%-12s %-5s %8.1f %7.2fx  %s\n",
+             knames[k], mixer68_isa_name(isa),
+             (double) len * rep / t * 1E-6, tref[k] / t,
+             isa == MIXER68_ISA_C ? "reference" : bad ? "MISMATCH" : "ok");
+    }
+  }
+
+  free(src);
+  free(ref);
+  free(out);
+  return err;
+}
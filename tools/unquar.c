@@ -48,7 +48,7 @@ int main(int argc, char ** argv)
   int ret = 2, i;
   FILE * inp = 0;
   char * buf = 0, * ext, * sla, * iname = 0;
-  fpos_t len;
+  long len;
   unsigned offv, songs;
   int verb=0, usage=0;
 
@@ -145,6 +145,31 @@ UNICE68_API
  */
 int unice68_packer(void * dst, int max, const void * src, int len);
 
+/**
+ *  ICE packer match finders.
+ *
+ *    All finders produce the exact same packed data.
+ */
+enum unice68_finder_e {
+  UNICE68_FINDER_QUERY = -1, /**< Query current finder.                  */
+  UNICE68_FINDER_ORIG  =  0, /**< Original brute force search.           */
+  UNICE68_FINDER_HASH  =  1  /**< Hash chains (default).                 */
+};
+
+UNICE68_API
+/**
+ *  Set/Get the ICE packer match finder.
+ *
+ *    The selection is global. The hash chain finder needs about 4
+ *    bytes per input byte; unice68_packer() falls back to the
+ *    original search if it can not be allocated.
+ *
+ * @param  finder  @ref unice68_finder_e "match finder"
+ *
+ * @return selected match finder
+ */
+int unice68_packer_finder(int finder);
+
 /**
  * @}
  */
@@ -35,6 +35,7 @@
 #ifdef HAVE_ASSERT_H
 # include <assert.h>
 #endif
+#include <stdlib.h>
 
 typedef uint8_t * areg_t;
 typedef     int   dreg_t;
@@ -45,8 +46,11 @@ typedef struct {
   areg_t srcbuf,srcend,dstbuf,dstend;
   int srclen, dstlen, dstmax;
   int error, optimize, maxlength, maxgleich, maxoffset;
+  int * next;          /* next position with the same 2 bytes (-1:none) */
 } all_regs_t;
 
+static int finder = UNICE68_FINDER_HASH;
+
 #define ICE_MAGIC 0x49636521 /* 'Ice!' */
 
 #define EQ(A,B) ((A) == (B))
@@ -81,6 +85,7 @@ static void longword_store(all_regs_t *R);
 static void put_bits(all_regs_t * R);
 static void make_stringlength(all_regs_t * R);
 static void make_normal_bytes(all_regs_t * R);
+static void search_string(all_regs_t * R);
 
 /* Store d7.l
  */
@@ -194,6 +199,73 @@ static void make_stringlength(all_regs_t *R)
   put_bits(R);
 }
 
+/* Hash chain version of the string search of ice_crunch().
+ *
+ *   It finds the same string as the original search: the longest one
+ *   starting in [a0+2..a3-1] (first found on tie) with no more than
+ *   $409 bytes, not overlapping a0 and not reaching a3. Strings
+ *   longer than 2 bytes must have an offset not greater than $111f.
+ *   Only the positions starting with the same 2 bytes than a0 are
+ *   visited.
+ *
+ *   On return d4 is the string length (1:none); maxlength and
+ *   maxoffset are set if a string was found.
+ */
+static void search_string(all_regs_t * R)
+{
+  const uint8_t * const s = R->srcbuf;
+  const int p = R->a0 - R->srcbuf;
+  int e = p + R->optimize, best = 1, q, r;
+
+  if (e > R->srcend - R->srcbuf)
+    e = R->srcend - R->srcbuf;
+
+  /* Run of identical bytes at a0: a string starting inside it
+   * matches up to its end exactly.
+   */
+  for (r = 1; p + r < e && s[p+r] == s[p]; ++r)
+    ;
+
+  for (q = R->next[p]; q >= 0 && q < e; q = R->next[q]) {
+    int lim, len;
+
+    if (q < p + 2)
+      continue;
+    if (e - q - 1 <= best)
+      break;                            /* can only get shorter */
+    if (best >= 2 && q - p - 0x409 + 1 > 0x111f)
+      break;                            /* offset too large     */
+
+    /* The string can neither overlap a0 nor reach a3 */
+    lim = q - p;
+    if (lim > e - q - 1)
+      lim = e - q - 1;
+    if (lim > 0x409)
+      lim = 0x409;
+    if (lim <= best)
+      continue;
+
+    if (q < p + r) {
+      len = p + r - q;
+      if (len > lim)
+        len = lim;
+    } else {
+      if (s[q+best] != s[p+best])
+        continue;
+      for (len = 2; len < lim && s[q+len] == s[p+len]; ++len)
+        ;
+    }
+    if (len <= best || (len > 2 && q - p - len + 1 > 0x111f))
+      continue;
+
+    R->maxlength = best = len;
+    R->maxoffset = q - p - len + 1;
+    if (best == 0x409)
+      break;
+  }
+  R->d4 = best;
+}
+
 static int ice_crunch(all_regs_t *R)
 {
   R->a0 = R->srcbuf;
@@ -251,6 +323,11 @@ gleich_ende:
  * 2. Search string with the greatest possible length and a small offset
  */
 
+  if (R->next) {
+    search_string(R);
+    BRA(string_suche_fertig);
+  }
+
   /* move.l     a0,a3 */
   /* adda.l     optimize(pc),a3 */
   R->a3 = R->a0 + R->optimize;
@@ -547,6 +624,41 @@ kleiner:
   put_bits(R);
 }
 
+/* Build the hash chains; the 2 first bytes of a string are the hash
+ * key so that there is no collision.
+ */
+static int * make_chains(const uint8_t * s, int n)
+{
+  int * next, * head;
+  int i;
+
+  if (n < 2)
+    return 0;
+  next = malloc( (n + 0x10000) * sizeof(int) );
+  if (!next)
+    return 0;
+  head = next + n;
+  for (i = 0; i < 0x10000; ++i)
+    head[i] = -1;
+  next[n-1] = -1;
+  for (i = n-2; i >= 0; --i) {
+    const int key = ( s[i] << 8 ) | s[i+1];
+    next[i] = head[key];
+    head[key] = i;
+  }
+  return next;
+}
+
+int unice68_packer_finder(int sel)
+{
+  switch (sel) {
+  case UNICE68_FINDER_ORIG:
+  case UNICE68_FINDER_HASH:
+    finder = sel;
+  }
+  return finder;
+}
+
 int unice68_packer(void * dst, int dstsz, const void * src, int srcsz)
 {
   all_regs_t allregs, *R = &allregs;
@@ -574,6 +686,9 @@ int unice68_packer(void * dst, int dstsz, const void * src, int srcsz)
   R->maxlength = 0;
   R->maxgleich = 0;
   R->maxoffset = 0;
+  R->next      = finder == UNICE68_FINDER_HASH
+    ? make_chains(R->srcbuf, R->srclen)
+    : 0;
 
   /***********************************************************************
    * Store header
@@ -606,6 +721,7 @@ int unice68_packer(void * dst, int dstsz, const void * src, int srcsz)
 
   /* Main loop */
   ice_crunch(R);
+  free(R->next);
 
   if (R->error)
     R->d0 = -1;